@@ -55,6 +55,22 @@ struct AvlTree_Node {
     AvlTree_Node *right;
 };
 
+/**
+ * Counters of the work done by an AVL tree to insert and remove nodes,
+ * to explain why a tree performs the way it does on a given workload.
+ * Kept only if AVLTREE_STATS is defined, otherwise they cost nothing.
+ * Define it when compiling both AvlTree.c and the code instantiating
+ * the templates, as it changes the layout of AvlTree.
+ */
+typedef struct AvlTree_Stats {
+    uint64_t insertions;
+    uint64_t removals;
+    uint64_t descentSteps; // nodes visited looking for the insertion point
+    uint64_t rotations; // double rotations count as two
+    uint64_t insertRebalanceSteps; // nodes visited restoring balance after insertion
+    uint64_t removeRebalanceSteps; // nodes visited restoring balance after removal
+} AvlTree_Stats;
+
 /**
  * AVL tree caching the leftmost and rightmost nodes.
  *
@@ -71,8 +87,22 @@ typedef struct AvlTree {
     AvlTree_Node sentinel; // used both to point to the root (via .left) and as leaf sentinel (.parent is updated but not meaningful)
     AvlTree_Node *leftmost;
     AvlTree_Node *rightmost;
+    #ifdef AVLTREE_STATS
+    AvlTree_Stats stats;
+    #endif
 } AvlTree;
 
+/**
+ * Internal macro adding to a counter of the tree owning the specified
+ * sentinel, which is the first member of the tree. Expands to nothing
+ * unless AVLTREE_STATS is defined.
+ */
+#ifdef AVLTREE_STATS
+#define AvlTree_countStat(sentinel, counter, amount) (((AvlTree *) (sentinel))->stats.counter += (amount))
+#else
+#define AvlTree_countStat(sentinel, counter, amount) ((void) 0)
+#endif
+
 /** Returns true if the AVL tree contains no elements. */
 static inline bool AvlTree_isEmpty(const AvlTree *tree) {
     return tree->sentinel.left == &tree->sentinel;
@@ -86,6 +116,321 @@ static inline int AvlTree_getBalance(const AvlTree_Node *node) {
     return node->parent & 3;
 }
 
+/** Internal function to set the parent of a node without changing its balance factor. */
+static inline void AvlTree_setParent(AvlTree_Node *node, AvlTree_Node *parent) {
+    assert(((uintptr_t) parent & 3) == 0);
+    node->parent = (node->parent & 3) | (uintptr_t) parent;
+}
+
+/** Internal function to set the balance factor of a node without changing its parent. */
+static inline void AvlTree_setBalance(AvlTree_Node *node, int balance) {
+    node->parent = (node->parent & ~3) | balance;
+}
+
+/**
+ * Internal function prefetching both children of a node, one of which is
+ * going to be visited next while descending the tree, to overlap cache
+ * misses with the comparison. Enabled only if AVLTREE_PREFETCH is defined,
+ * as it helps only on trees not fitting the caches. Define it when compiling
+ * both AvlTree.c and the code instantiating the templates.
+ */
+static inline void AvlTree_prefetchChildren(const AvlTree_Node *node) {
+    #ifdef AVLTREE_PREFETCH
+    __builtin_prefetch(node->left);
+    __builtin_prefetch(node->right);
+    #endif
+}
+
+/** Internal function returning the leftmost node of a non-empty subtree. */
+static inline AvlTree_Node *AvlTree_findMin(const AvlTree_Node *sentinel, AvlTree_Node *root) {
+    while (root->left != sentinel) {
+        AvlTree_prefetchChildren(root);
+        root = root->left;
+    }
+    return root;
+}
+
+/** Internal function returning the rightmost node of a non-empty subtree. */
+static inline AvlTree_Node *AvlTree_findMax(const AvlTree_Node *sentinel, AvlTree_Node *root) {
+    while (root->right != sentinel) {
+        AvlTree_prefetchChildren(root);
+        root = root->right;
+    }
+    return root;
+}
+
+/**
+ * Returns the node following the specified one in key order,
+ * or the sentinel if node is the rightmost one.
+ * Visiting all nodes this way takes constant amortized time per node.
+ */
+static inline AvlTree_Node *AvlTree_next(const AvlTree *tree, const AvlTree_Node *node) {
+    if (node->right != &tree->sentinel) return AvlTree_findMin(&tree->sentinel, node->right);
+    AvlTree_Node *parent = AvlTree_getParent(node);
+    while (parent != &tree->sentinel && node == parent->right) {
+        node = parent;
+        parent = AvlTree_getParent(node);
+    }
+    return parent;
+}
+
+/**
+ * Returns the node preceding the specified one in key order,
+ * or the sentinel if node is the leftmost one.
+ * Visiting all nodes this way takes constant amortized time per node.
+ */
+static inline AvlTree_Node *AvlTree_prev(const AvlTree *tree, const AvlTree_Node *node) {
+    if (node->left != &tree->sentinel) return AvlTree_findMax(&tree->sentinel, node->left);
+    AvlTree_Node *parent = AvlTree_getParent(node);
+    while (parent != &tree->sentinel && node == parent->left) {
+        node = parent;
+        parent = AvlTree_getParent(node);
+    }
+    return parent;
+}
+
+/**
+ * Internal poor man's template expanding the rebalancing code of AVL trees.
+ * The update function, taking (const AvlTree_Node *sentinel, AvlTree_Node *node),
+ * is called on nodes moved by rotations, children first, to recompute
+ * per-subtree data of augmented trees. The plain tree passes a no-op,
+ * that the compiler optimizes away.
+ * Expands the following static functions:
+ * - prefix##_rebalanceAfterGrowth(sentinel, holder, node) restores balance
+ *   after the subtree rooted at node grew by one level, up to holder->left,
+ *   returning true if the height of the whole (sub)tree increased;
+ * - prefix##_unlink(tree, node) removes a node and restores balance,
+ *   returning the lowest node whose subtree lost a node (or the sentinel);
+ * - prefix##_updatePath(sentinel, node) calls update from node up to the root.
+ * @param prefix prefix for names of the generated functions.
+ * @param update name of the function updating per-subtree data of a node.
+ */
+#define AvlTree_instantiateBalancing(prefix, update)\
+static void prefix##_rotateLeft(const AvlTree_Node *sentinel, AvlTree_Node *parent) {\
+    AvlTree_countStat(sentinel, rotations, 1);\
+    AvlTree_Node *child = parent->right;\
+    int parentBalance = AvlTree_balanced;\
+    int childBalance = AvlTree_balanced;\
+    if (AvlTree_getBalance(child) != AvlTree_rightHeavy) {\
+        parentBalance = AvlTree_rightHeavy;\
+        childBalance = AvlTree_leftHeavy;\
+    }\
+    child->parent = (uintptr_t) AvlTree_getParent(parent) | childBalance;\
+    parent->right = child->left;\
+    child->left = parent;\
+    parent->parent = (uintptr_t) child | parentBalance;\
+    AvlTree_setParent(parent->right, parent);\
+    if (AvlTree_getParent(child)->right == parent) AvlTree_getParent(child)->right = child;\
+    else AvlTree_getParent(child)->left = child;\
+    update(sentinel, parent);\
+    update(sentinel, child);\
+}\
+\
+static void prefix##_rotateRight(const AvlTree_Node *sentinel, AvlTree_Node *parent) {\
+    AvlTree_countStat(sentinel, rotations, 1);\
+    AvlTree_Node *child = parent->left;\
+    int parentBalance = AvlTree_balanced;\
+    int childBalance = AvlTree_balanced;\
+    if (AvlTree_getBalance(child) != AvlTree_leftHeavy) {\
+        parentBalance = AvlTree_leftHeavy;\
+        childBalance = AvlTree_rightHeavy;\
+    }\
+    child->parent = (uintptr_t) AvlTree_getParent(parent) | childBalance;\
+    parent->left = child->right;\
+    child->right = parent;\
+    parent->parent = (uintptr_t) child | parentBalance;\
+    AvlTree_setParent(parent->left, parent);\
+    if (AvlTree_getParent(child)->left == parent) AvlTree_getParent(child)->left = child;\
+    else AvlTree_getParent(child)->right = child;\
+    update(sentinel, parent);\
+    update(sentinel, child);\
+}\
+\
+static void prefix##_rotateLeftRight(const AvlTree_Node *sentinel, AvlTree_Node *parent) {\
+    AvlTree_countStat(sentinel, rotations, 2);\
+    AvlTree_Node *child = parent->left;\
+    AvlTree_Node *grandChild = child->right;\
+    int parentBalance = AvlTree_balanced;\
+    int childBalance = AvlTree_balanced;\
+    if (AvlTree_getBalance(grandChild) == AvlTree_rightHeavy) childBalance = AvlTree_leftHeavy;\
+    else if (AvlTree_getBalance(grandChild) == AvlTree_leftHeavy) parentBalance = AvlTree_rightHeavy;\
+    parent->left = grandChild->right;\
+    child->right = grandChild->left;\
+    grandChild->right = parent;\
+    grandChild->left = child;\
+    grandChild->parent = (uintptr_t) AvlTree_getParent(parent) | AvlTree_balanced;\
+    parent->parent = (uintptr_t) grandChild | parentBalance;\
+    child->parent = (uintptr_t) grandChild | childBalance;\
+    AvlTree_setParent(parent->left, parent);\
+    AvlTree_setParent(child->right, child);\
+    if (parent == AvlTree_getParent(grandChild)->left) AvlTree_getParent(grandChild)->left = grandChild;\
+    else AvlTree_getParent(grandChild)->right = grandChild;\
+    update(sentinel, parent);\
+    update(sentinel, child);\
+    update(sentinel, grandChild);\
+}\
+\
+static void prefix##_rotateRightLeft(const AvlTree_Node *sentinel, AvlTree_Node *parent) {\
+    AvlTree_countStat(sentinel, rotations, 2);\
+    AvlTree_Node *child = parent->right;\
+    AvlTree_Node *grandChild = child->left;\
+    int parentBalance = AvlTree_balanced;\
+    int childBalance = AvlTree_balanced;\
+    if (AvlTree_getBalance(grandChild) == AvlTree_leftHeavy) childBalance = AvlTree_rightHeavy;\
+    else if (AvlTree_getBalance(grandChild) == AvlTree_rightHeavy) parentBalance = AvlTree_leftHeavy;\
+    parent->right = grandChild->left;\
+    child->left = grandChild->right;\
+    grandChild->left = parent;\
+    grandChild->right = child;\
+    grandChild->parent = (uintptr_t) AvlTree_getParent(parent) | AvlTree_balanced;\
+    parent->parent = (uintptr_t) grandChild | parentBalance;\
+    child->parent = (uintptr_t) grandChild | childBalance;\
+    AvlTree_setParent(parent->right, parent);\
+    AvlTree_setParent(child->left, child);\
+    if (parent == AvlTree_getParent(grandChild)->right) AvlTree_getParent(grandChild)->right = grandChild;\
+    else AvlTree_getParent(grandChild)->left = grandChild;\
+    update(sentinel, parent);\
+    update(sentinel, child);\
+    update(sentinel, grandChild);\
+}\
+\
+static bool prefix##_rebalanceAfterGrowth(const AvlTree_Node *sentinel, const AvlTree_Node *holder, AvlTree_Node *node) {\
+    while (node != holder->left) {\
+        AvlTree_countStat(sentinel, insertRebalanceSteps, 1);\
+        AvlTree_Node *parent = AvlTree_getParent(node);\
+        int balance = AvlTree_getBalance(parent);\
+        if (balance == AvlTree_balanced) {\
+            AvlTree_setBalance(parent, (node == parent->left) ? AvlTree_leftHeavy : AvlTree_rightHeavy);\
+            node = parent;\
+        } else if (balance == AvlTree_rightHeavy) {\
+            if (node == parent->left) {\
+                AvlTree_setBalance(parent, AvlTree_balanced);\
+            } else if (AvlTree_getBalance(node) == AvlTree_leftHeavy) {\
+                prefix##_rotateRightLeft(sentinel, parent);\
+            } else {\
+                prefix##_rotateLeft(sentinel, parent);\
+            }\
+            return false;\
+        } else {\
+            assert(balance == AvlTree_leftHeavy);\
+            if (node == parent->right) {\
+                AvlTree_setBalance(parent, AvlTree_balanced);\
+            } else if (AvlTree_getBalance(node) == AvlTree_rightHeavy) {\
+                prefix##_rotateLeftRight(sentinel, parent);\
+            } else {\
+                prefix##_rotateRight(sentinel, parent);\
+            }\
+            return false;\
+        }\
+    }\
+    return true;\
+}\
+\
+static void prefix##_rebalanceAfterDeletion(AvlTree *tree, AvlTree_Node *current, AvlTree_Node *parent) {\
+    while (current != tree->sentinel.left) {\
+        AvlTree_countStat(&tree->sentinel, removeRebalanceSteps, 1);\
+        int balance = AvlTree_getBalance(parent);\
+        if (balance == AvlTree_balanced) {\
+            AvlTree_setBalance(parent, (current == parent->right) ? AvlTree_leftHeavy : AvlTree_rightHeavy);\
+            break;\
+        } else if (balance == AvlTree_leftHeavy) {\
+            if (current == parent->left) {\
+                AvlTree_setBalance(parent, AvlTree_balanced);\
+                current = parent;\
+            } else {\
+                AvlTree_Node *sibling = parent->left;\
+                assert(sibling != &tree->sentinel);\
+                if (AvlTree_getBalance(sibling) == AvlTree_rightHeavy) {\
+                    assert(sibling->right != &tree->sentinel);\
+                    prefix##_rotateLeftRight(&tree->sentinel, parent);\
+                } else {\
+                    prefix##_rotateRight(&tree->sentinel, parent);\
+                }\
+                current = AvlTree_getParent(parent);\
+                if (AvlTree_getBalance(current) == AvlTree_rightHeavy) break;\
+            }\
+        } else {\
+            assert(balance == AvlTree_rightHeavy);\
+            if (current == parent->right) {\
+                AvlTree_setBalance(parent, AvlTree_balanced);\
+                current = parent;\
+            } else {\
+                AvlTree_Node *sibling = parent->right;\
+                assert(sibling != &tree->sentinel);\
+                if (AvlTree_getBalance(sibling) == AvlTree_leftHeavy) {\
+                    assert(sibling->left != &tree->sentinel);\
+                    prefix##_rotateRightLeft(&tree->sentinel, parent);\
+                } else {\
+                    prefix##_rotateLeft(&tree->sentinel, parent);\
+                }\
+                current = AvlTree_getParent(parent);\
+                if (AvlTree_getBalance(current) == AvlTree_leftHeavy) break;\
+            }\
+        }\
+        parent = AvlTree_getParent(current);\
+    }\
+}\
+\
+static AvlTree_Node *prefix##_unlink(AvlTree *tree, AvlTree_Node *node) {\
+    AvlTree_countStat(&tree->sentinel, removals, 1);\
+    if (node->left == &tree->sentinel || node->right == &tree->sentinel) {\
+        AvlTree_Node *parent = AvlTree_getParent(node);\
+        AvlTree_Node *replacement = (node->left != &tree->sentinel) ? node->left : node->right;\
+        AvlTree_setParent(replacement, parent);\
+        if (parent->left == node) parent->left = replacement;\
+        else parent->right = replacement;\
+        if (tree->leftmost == node) {\
+            if (node->right == &tree->sentinel) {\
+                assert(node->left == &tree->sentinel);\
+                tree->leftmost = parent;\
+            } else {\
+                tree->leftmost = AvlTree_findMin(&tree->sentinel, replacement);\
+            }\
+        }\
+        if (tree->rightmost == node) {\
+            if (node->left == &tree->sentinel) {\
+                assert(node->right == &tree->sentinel);\
+                tree->rightmost = parent;\
+            } else {\
+                tree->rightmost = AvlTree_findMax(&tree->sentinel, replacement);\
+            }\
+        }\
+        prefix##_rebalanceAfterDeletion(tree, replacement, parent);\
+        return parent;\
+    } else {\
+        assert(node != tree->leftmost);\
+        assert(node != tree->rightmost);\
+        AvlTree_Node *successor = AvlTree_findMin(&tree->sentinel, node->right);\
+        AvlTree_Node *replacement = successor->right;\
+        AvlTree_Node *replacementParent;\
+        AvlTree_setParent(node->left, successor);\
+        successor->left = node->left;\
+        if (successor != node->right) {\
+            replacementParent = AvlTree_getParent(successor);\
+            AvlTree_Node* successorParent = AvlTree_getParent(successor);\
+            AvlTree_setParent(replacement, successorParent);\
+            successorParent->left = replacement;\
+            successor->right = node->right;\
+            AvlTree_setParent(node->right, successor);\
+        } else {\
+            replacementParent = successor;\
+        }\
+        AvlTree_Node* parent = AvlTree_getParent(node);\
+        successor->parent = node->parent; /* both same parent and balance factor */\
+        if (parent->left == node) parent->left = successor;\
+        else parent->right = successor;\
+        prefix##_rebalanceAfterDeletion(tree, replacement, replacementParent);\
+        return replacementParent;\
+    }\
+}\
+\
+static inline void prefix##_updatePath(const AvlTree_Node *sentinel, AvlTree_Node *node) {\
+    while (node != sentinel) {\
+        update(sentinel, node);\
+        node = AvlTree_getParent(node);\
+    }\
+}
+
 /** Initializes an empty AVL tree. */
 void AvlTree_initialize(AvlTree *tree);
 
@@ -95,6 +440,144 @@ void AvlTree_remove(AvlTree *tree, AvlTree_Node *node);
 /** Internal function called after insertion of a node into an AVL tree. */
 void AvlTree_rebalanceAfterInsertion(AvlTree *tree, AvlTree_Node *node);
 
+/**
+ * Links the specified nodes into a perfectly balanced AVL tree in linear time.
+ * The tree must be empty, and nodes must be already sorted in ascending order.
+ * To build from unsorted nodes, see the AvlTree_instantiateBuild macro.
+ */
+void AvlTree_buildFromSorted(AvlTree *tree, AvlTree_Node **nodes, size_t count);
+
+/**
+ * Joins two AVL trees using the specified node, not already in a tree, as glue.
+ * All nodes in tree must be less than pivot, and pivot must be less than
+ * or equal to all nodes in other. The result is left in tree, and other is
+ * left empty. Rebalancing is logarithmic, but since leaf links refer to the
+ * sentinel of their own tree, nodes coming from other are relinked in linear time.
+ */
+void AvlTree_join(AvlTree *tree, AvlTree_Node *pivot, AvlTree *other);
+
+/**
+ * Splits an AVL tree moving the specified node and all the nodes following it
+ * to other, which must be empty. Rebalancing is logarithmic, but nodes moved
+ * to other are relinked in linear time as with AvlTree_join.
+ * To split by key, see the AvlTree_instantiateSplit macro.
+ */
+void AvlTree_split(AvlTree *tree, AvlTree_Node *node, AvlTree *other);
+
+/**
+ * Removes from an AVL tree the nodes from first, included, to end, excluded,
+ * where end may be the sentinel to remove up to the rightmost node.
+ * Rebalances once using split and join, in logarithmic time, then returns
+ * the removed nodes as a list in key order, linked by their right link and
+ * terminated by NULL, or NULL if the range is empty. Building the list takes
+ * time proportional to the count of removed nodes.
+ * To remove by key, see the AvlTree_instantiateRemoveRange macro.
+ */
+AvlTree_Node *AvlTree_removeRange(AvlTree *tree, AvlTree_Node *first, AvlTree_Node *end);
+
+/******************************************************************************
+ * Frozen trees
+ ******************************************************************************/
+
+/** Maximum height of a frozen AVL tree. */
+#define AvlTreeFrozen_maxHeight (sizeof(size_t) * 8)
+
+/**
+ * Layout of a read-only copy of an AVL tree, for trees built once and
+ * queried many times. Caller-defined items, usually holding a copy of the
+ * key and a pointer to the element, are stored in an array as an implicit
+ * complete binary tree in van Emde Boas order: the tree is split at half
+ * its height into a top tree followed by its bottom trees, each laid out
+ * recursively in a contiguous block. A lookup thus touches O(log_B n) cache
+ * lines for any line size B, instead of about one per level.
+ *
+ * The layout only depends on the count of nodes, and the item array must
+ * have slotCount items, that is less than twice the count of nodes, some of
+ * which are left unused. The frozen copy does not follow later changes to
+ * the live tree, that remains fully usable and may be frozen again.
+ * See the AvlTree_instantiateFreeze macro.
+ */
+typedef struct AvlTreeFrozen {
+    size_t count;     // count of items, that is the greatest breadth-first index in use
+    size_t slotCount; // size of the item array
+    struct {
+        size_t topSize;    // size of the top tree from the split creating this level
+        size_t bottomSize; // size of the bottom trees rooted at this level
+        unsigned topDepth; // depth of the root of that top tree
+    } levels[AvlTreeFrozen_maxHeight];
+} AvlTreeFrozen;
+
+/** Initializes the layout for a frozen copy of an AVL tree, counting its nodes in linear time. */
+void AvlTreeFrozen_initialize(AvlTreeFrozen *frozen, const AvlTree *tree);
+
+/** Internal function returning the array position of the item with the specified breadth-first index (1 for the root). */
+size_t AvlTreeFrozen_getSlot(const AvlTreeFrozen *frozen, size_t index);
+
+/** Internal function returning the breadth-first index of the first item in key order, or 0 if empty. */
+static inline size_t AvlTreeFrozen_first(const AvlTreeFrozen *frozen) {
+    if (frozen->count == 0) return 0;
+    size_t index = 1;
+    while (2 * index <= frozen->count) index *= 2;
+    return index;
+}
+
+/** Internal function returning the breadth-first index following the specified one in key order, or 0 at the end. */
+static inline size_t AvlTreeFrozen_next(const AvlTreeFrozen *frozen, size_t index) {
+    if (2 * index + 1 <= frozen->count) {
+        index = 2 * index + 1;
+        while (2 * index <= frozen->count) index *= 2;
+        return index;
+    }
+    while (index & 1) index >>= 1;
+    return index >> 1;
+}
+
+/******************************************************************************
+ * Order statistics
+ ******************************************************************************/
+
+/**
+ * Node of an AVL tree augmented with the count of nodes in its subtree.
+ * Embed into elements instead of AvlTree_Node to answer rank and select
+ * queries in logarithmic time. Such trees must be modified only using the
+ * AvlTreeCounted functions and macros, that keep counts up to date.
+ * Join, split, range removal and bulk construction are not supported.
+ */
+typedef struct AvlTreeCounted_Node {
+    AvlTree_Node node;
+    size_t count;
+} AvlTreeCounted_Node;
+
+static inline AvlTreeCounted_Node *AvlTreeCounted_getNode(const AvlTree_Node *n) {
+    return (AvlTreeCounted_Node *) ((uint8_t *) n - offsetof(AvlTreeCounted_Node, node));
+}
+
+/** Returns the count of nodes in the subtree rooted at the specified node, zero for the sentinel. */
+static inline size_t AvlTreeCounted_getCount(const AvlTree *tree, const AvlTree_Node *node) {
+    return (node != &tree->sentinel) ? AvlTreeCounted_getNode(node)->count : 0;
+}
+
+/** Returns the count of nodes in an AVL tree with counted nodes. */
+static inline size_t AvlTreeCounted_getSize(const AvlTree *tree) {
+    return AvlTreeCounted_getCount(tree, tree->sentinel.left);
+}
+
+/** Removes the specified node from an AVL tree with counted nodes. */
+void AvlTreeCounted_remove(AvlTree *tree, AvlTree_Node *node);
+
+/** Internal function called after insertion of a node into an AVL tree with counted nodes. */
+void AvlTreeCounted_rebalanceAfterInsertion(AvlTree *tree, AvlTree_Node *node);
+
+/**
+ * Returns the node with the specified zero-based position in key order,
+ * or the sentinel if index is not less than the count of nodes.
+ */
+AvlTree_Node *AvlTreeCounted_select(AvlTree *tree, size_t index);
+
+/** Returns the zero-based position in key order of the specified node. */
+size_t AvlTreeCounted_getRank(const AvlTree *tree, const AvlTree_Node *node);
+
+
 /******************************************************************************
  * Example instantiation with a node with uintptr_t key.
  * Complete by calling AvlTree_instantiateInsert(AvlTreeUintptr_insert,
@@ -125,6 +608,13 @@ static inline bool AvlTreeUintptr_Node_isLess(AvlTree_Node *node, AvlTree_Node *
  * @param isLess name of the function comparing nodes.
  */
 #define AvlTree_instantiateInsert(functionName, isLess)\
+    AvlTree_instantiateInsertWith(functionName, isLess, AvlTree_rebalanceAfterInsertion)
+
+/**
+ * Internal poor man's template for insertion functions, parameterized
+ * on the function restoring balance after the node has been linked.
+ */
+#define AvlTree_instantiateInsertWith(functionName, isLess, rebalanceAfterInsertion)\
 static void functionName##_insertBeforeLeftmost(AvlTree *tree, AvlTree_Node *node) {\
     node->parent = (uintptr_t) tree->leftmost | AvlTree_balanced;\
     tree->leftmost->left = node;\
@@ -140,6 +630,8 @@ static void functionName##_insertAfterRightmost(AvlTree *tree, AvlTree_Node *nod
 static void functionName##_insertInOrder(AvlTree *tree, AvlTree_Node *node) {\
     AvlTree_Node *i = tree->sentinel.left;\
     while (i != &tree->sentinel) {\
+        AvlTree_countStat(&tree->sentinel, descentSteps, 1);\
+        AvlTree_prefetchChildren(i);\
         if (isLess(node, i)) {\
             if (i->left == &tree->sentinel) {\
                 i->left = node;\
@@ -158,6 +650,7 @@ static void functionName##_insertInOrder(AvlTree *tree, AvlTree_Node *node) {\
 }\
 \
 void functionName(AvlTree *tree, AvlTree_Node *node) {\
+    AvlTree_countStat(&tree->sentinel, insertions, 1);\
     node->left = &tree->sentinel;\
     node->right = &tree->sentinel;\
     if (!AvlTree_isEmpty(tree)) {\
@@ -168,7 +661,7 @@ void functionName(AvlTree *tree, AvlTree_Node *node) {\
         } else {\
             functionName##_insertInOrder(tree, node);\
         }\
-        AvlTree_rebalanceAfterInsertion(tree, node);\
+        rebalanceAfterInsertion(tree, node);\
     } else {\
         node->parent = (uintptr_t) &tree->sentinel | AvlTree_balanced;\
         tree->sentinel.left = node;\
@@ -177,4 +670,348 @@ void functionName(AvlTree *tree, AvlTree_Node *node) {\
     }\
 }
 
+/**
+ * Instantiates a function looking up a node by key in a concrete AVL tree.
+ * The generated function takes (AvlTree *tree, AvlTree_Node *key), where key
+ * is a node, not necessarily in the tree, with the key to look for, and
+ * returns the first node equal to key, or the sentinel if not found.
+ * Uses a single comparison per level, like lower bound, and another one at
+ * the end to check for equality.
+ * @param functionName name of the function to generate (e.g. AvlTreeUintptr_find)
+ * @param isLess name of the function comparing nodes.
+ */
+#define AvlTree_instantiateFind(functionName, isLess)\
+AvlTree_Node *functionName(AvlTree *tree, AvlTree_Node *key) {\
+    AvlTree_Node *found = &tree->sentinel;\
+    AvlTree_Node *i = tree->sentinel.left;\
+    while (i != &tree->sentinel) {\
+        if (isLess(i, key)) {\
+            i = i->right;\
+        } else {\
+            found = i;\
+            i = i->left;\
+        }\
+    }\
+    if (found != &tree->sentinel && isLess(key, found)) return &tree->sentinel;\
+    return found;\
+}
+
+/**
+ * Instantiates a function returning the first node not less than a key
+ * in a concrete AVL tree, or the sentinel if all nodes are less than key.
+ * The generated function takes (AvlTree *tree, AvlTree_Node *key).
+ * @param functionName name of the function to generate (e.g. AvlTreeUintptr_lowerBound)
+ * @param isLess name of the function comparing nodes.
+ */
+#define AvlTree_instantiateLowerBound(functionName, isLess)\
+    AvlTree_instantiateLowerBoundWith(, functionName, isLess)
+
+/**
+ * Internal poor man's template for lower bound functions, parameterized
+ * on their storage class, so that other templates can expand private ones.
+ */
+#define AvlTree_instantiateLowerBoundWith(storage, functionName, isLess)\
+storage AvlTree_Node *functionName(AvlTree *tree, AvlTree_Node *key) {\
+    AvlTree_Node *found = &tree->sentinel;\
+    AvlTree_Node *i = tree->sentinel.left;\
+    while (i != &tree->sentinel) {\
+        if (isLess(i, key)) {\
+            i = i->right;\
+        } else {\
+            found = i;\
+            i = i->left;\
+        }\
+    }\
+    return found;\
+}
+
+/**
+ * Instantiates a function returning the first node greater than a key
+ * in a concrete AVL tree, or the sentinel if no node is greater than key.
+ * The generated function takes (AvlTree *tree, AvlTree_Node *key).
+ * @param functionName name of the function to generate (e.g. AvlTreeUintptr_upperBound)
+ * @param isLess name of the function comparing nodes.
+ */
+#define AvlTree_instantiateUpperBound(functionName, isLess)\
+AvlTree_Node *functionName(AvlTree *tree, AvlTree_Node *key) {\
+    AvlTree_Node *found = &tree->sentinel;\
+    AvlTree_Node *i = tree->sentinel.left;\
+    while (i != &tree->sentinel) {\
+        if (isLess(key, i)) {\
+            found = i;\
+            i = i->left;\
+        } else {\
+            i = i->right;\
+        }\
+    }\
+    return found;\
+}
+
+/**
+ * Instantiates a function visiting in key order, without modifying the tree,
+ * all nodes not less than lo and less than hi in a concrete AVL tree.
+ * The generated function takes (AvlTree *tree, AvlTree_Node *lo,
+ * AvlTree_Node *hi, void *context), where lo and hi are nodes, not necessarily
+ * in the tree, with the bounds of the range, and calls the visit function,
+ * taking (AvlTree_Node *node, void *context), on each node in range.
+ * @param functionName name of the function to generate (e.g. AvlTreeUintptr_visitRange)
+ * @param isLess name of the function comparing nodes.
+ * @param visit name of the function to call on each node.
+ */
+#define AvlTree_instantiateVisitRange(functionName, isLess, visit)\
+void functionName(AvlTree *tree, AvlTree_Node *lo, AvlTree_Node *hi, void *context) {\
+    AvlTree_Node *node = &tree->sentinel;\
+    AvlTree_Node *i = tree->sentinel.left;\
+    while (i != &tree->sentinel) {\
+        if (isLess(i, lo)) {\
+            i = i->right;\
+        } else {\
+            node = i;\
+            i = i->left;\
+        }\
+    }\
+    while (node != &tree->sentinel && isLess(node, hi)) {\
+        visit(node, context);\
+        node = AvlTree_next(tree, node);\
+    }\
+}
+
+/**
+ * Instantiates a function looking up a node by key in a concrete AVL tree
+ * protected by a SeqLock (see SeqLock.h, to be included before expanding),
+ * for many reader threads concurrent with one writer. Readers descend the
+ * tree optimistically without writing to shared memory, retrying if the
+ * writer intervened, so they never block the writer nor each other.
+ * The writer keeps using the usual insertion and removal functions,
+ * enclosed between SeqLock_writeBegin and SeqLock_writeEnd.
+ * The generated function takes (const SeqLock *lock, AvlTree *tree,
+ * AvlTree_Node *key, void *context) and returns true if a node equal to key
+ * was found, calling read, taking (AvlTree_Node *node, void *context), to
+ * copy data out of the found node. read may be called again on retries,
+ * the last call only being consistent, and must not trust what it reads.
+ * @param functionName name of the function to generate (e.g. AvlTreeUintptr_optimisticFind)
+ * @param isLess name of the function comparing nodes.
+ * @param read name of the function copying data out of the found node.
+ */
+#define AvlTree_instantiateOptimisticFind(functionName, isLess, read)\
+bool functionName(const SeqLock *lock, AvlTree *tree, AvlTree_Node *key, void *context) {\
+    while (true) {\
+        unsigned sequence = SeqLock_readBegin(lock);\
+        AvlTree_Node *found = &tree->sentinel;\
+        AvlTree_Node *i = __atomic_load_n(&tree->sentinel.left, __ATOMIC_RELAXED);\
+        for (size_t depth = 0; i != &tree->sentinel && i != NULL && depth < SeqLock_maxDescent; depth++) {\
+            if (isLess(i, key)) {\
+                i = __atomic_load_n(&i->right, __ATOMIC_RELAXED);\
+            } else {\
+                found = i;\
+                i = __atomic_load_n(&i->left, __ATOMIC_RELAXED);\
+            }\
+        }\
+        if (i != &tree->sentinel) continue; /* torn by the writer */\
+        bool isFound = found != &tree->sentinel && !isLess(key, found);\
+        if (isFound) read(found, context);\
+        if (!SeqLock_readRetry(lock, sequence)) return isFound;\
+    }\
+}
+
+/**
+ * Instantiates insertion and removal functions for an AVL tree whose nodes
+ * carry data aggregated over their subtree, such as the minimum, maximum
+ * or sum of a field of the elements, to answer aggregate queries in
+ * logarithmic time.
+ * The update function, taking (const AvlTree_Node *sentinel, AvlTree_Node *node),
+ * must recompute the aggregate of node from the node itself and its left and
+ * right children, any of which may be the sentinel. It is called on nodes
+ * moved by rotations and on the path to the root after insertion and removal.
+ * Such trees must be modified only using the generated functions:
+ * - void prefix##_insert(AvlTree *tree, AvlTree_Node *node);
+ * - void prefix##_remove(AvlTree *tree, AvlTree_Node *node).
+ * @param prefix prefix for names of the generated functions (e.g. AvlTreeUintptr).
+ * @param isLess name of the function comparing nodes.
+ * @param update name of the function updating the aggregate of a node.
+ */
+#define AvlTree_instantiateAugmented(prefix, isLess, update)\
+AvlTree_instantiateBalancing(prefix, update)\
+\
+static void prefix##_rebalanceAfterInsertion(AvlTree *tree, AvlTree_Node *node) {\
+    prefix##_updatePath(&tree->sentinel, AvlTree_getParent(node));\
+    prefix##_rebalanceAfterGrowth(&tree->sentinel, &tree->sentinel, node);\
+}\
+\
+AvlTree_instantiateInsertWith(prefix##_link, isLess, prefix##_rebalanceAfterInsertion)\
+\
+void prefix##_insert(AvlTree *tree, AvlTree_Node *node) {\
+    node->left = &tree->sentinel;\
+    node->right = &tree->sentinel;\
+    update(&tree->sentinel, node);\
+    prefix##_link(tree, node);\
+}\
+\
+void prefix##_remove(AvlTree *tree, AvlTree_Node *node) {\
+    prefix##_updatePath(&tree->sentinel, prefix##_unlink(tree, node));\
+}
+
+/**
+ * Instantiates an insertion function for a concrete AVL tree with counted nodes.
+ * @param functionName name of the function to generate (e.g. AvlTreeUintptr_insertCounted)
+ * @param isLess name of the function comparing nodes.
+ */
+#define AvlTreeCounted_instantiateInsert(functionName, isLess)\
+AvlTree_instantiateInsertWith(functionName##_link, isLess, AvlTreeCounted_rebalanceAfterInsertion)\
+\
+void functionName(AvlTree *tree, AvlTree_Node *node) {\
+    AvlTreeCounted_getNode(node)->count = 1;\
+    functionName##_link(tree, node);\
+}
+
+/**
+ * Instantiates a function returning the count of nodes less than a key
+ * in an AVL tree with counted nodes. The generated function takes
+ * (AvlTree *tree, AvlTree_Node *key), where the key node is only used for
+ * comparison and need not be in the tree.
+ * @param functionName name of the function to generate (e.g. AvlTreeUintptr_rank)
+ * @param isLess name of the function comparing nodes.
+ */
+#define AvlTreeCounted_instantiateRank(functionName, isLess)\
+size_t functionName(AvlTree *tree, AvlTree_Node *key) {\
+    size_t rank = 0;\
+    AvlTree_Node *i = tree->sentinel.left;\
+    while (i != &tree->sentinel) {\
+        if (isLess(i, key)) {\
+            rank += AvlTreeCounted_getCount(tree, i->left) + 1;\
+            i = i->right;\
+        } else {\
+            i = i->left;\
+        }\
+    }\
+    return rank;\
+}
+
+/**
+ * Instantiates a function to build an AVL tree from an array of unsorted nodes.
+ * The generated function has the same parameters as AvlTree_buildFromSorted,
+ * and sorts the array in place using heapsort before linking nodes, thus
+ * the relative order of nodes with equal keys is not preserved.
+ * @param functionName name of the function to generate (e.g. AvlTreeUintptr_build)
+ * @param isLess name of the function comparing nodes.
+ */
+#define AvlTree_instantiateBuild(functionName, isLess)\
+static void functionName##_siftDown(AvlTree_Node **nodes, size_t index, size_t count) {\
+    AvlTree_Node *node = nodes[index];\
+    while (true) {\
+        size_t child = 2 * index + 1;\
+        if (child >= count) break;\
+        if ((child + 1 < count) && isLess(nodes[child], nodes[child + 1])) child++;\
+        if (!isLess(node, nodes[child])) break;\
+        nodes[index] = nodes[child];\
+        index = child;\
+    }\
+    nodes[index] = node;\
+}\
+\
+void functionName(AvlTree *tree, AvlTree_Node **nodes, size_t count) {\
+    for (size_t i = count / 2; i-- > 0; ) {\
+        functionName##_siftDown(nodes, i, count);\
+    }\
+    for (size_t i = count; i-- > 1; ) {\
+        AvlTree_Node *max = nodes[0];\
+        nodes[0] = nodes[i];\
+        nodes[i] = max;\
+        functionName##_siftDown(nodes, 0, i);\
+    }\
+    AvlTree_buildFromSorted(tree, nodes, count);\
+}
+
+/**
+ * Instantiates a function to split an AVL tree by key.
+ * The generated function takes (AvlTree *tree, AvlTree_Node *key, AvlTree *other)
+ * and moves all nodes not less than the key node to other, which must be empty.
+ * The key node is only used for comparison and need not be in the tree.
+ * @param functionName name of the function to generate (e.g. AvlTreeUintptr_split)
+ * @param isLess name of the function comparing nodes.
+ */
+#define AvlTree_instantiateSplit(functionName, isLess)\
+void functionName(AvlTree *tree, AvlTree_Node *key, AvlTree *other) {\
+    AvlTree_Node *found = &tree->sentinel;\
+    AvlTree_Node *i = tree->sentinel.left;\
+    while (i != &tree->sentinel) {\
+        if (isLess(i, key)) {\
+            i = i->right;\
+        } else {\
+            found = i;\
+            i = i->left;\
+        }\
+    }\
+    if (found != &tree->sentinel) AvlTree_split(tree, found, other);\
+}
+
+/**
+ * Instantiates a function removing all nodes not less than lo and less than hi
+ * from a concrete AVL tree, as with AvlTree_removeRange.
+ * The generated function takes (AvlTree *tree, AvlTree_Node *lo, AvlTree_Node *hi),
+ * where lo and hi are nodes, not necessarily in the tree, with the bounds of
+ * the range, and returns the list of removed nodes.
+ * @param functionName name of the function to generate (e.g. AvlTreeUintptr_removeRange)
+ * @param isLess name of the function comparing nodes.
+ */
+#define AvlTree_instantiateRemoveRange(functionName, isLess)\
+AvlTree_instantiateLowerBoundWith(static inline, functionName##_lowerBound, isLess)\
+\
+AvlTree_Node *functionName(AvlTree *tree, AvlTree_Node *lo, AvlTree_Node *hi) {\
+    if (!isLess(lo, hi)) return NULL;\
+    return AvlTree_removeRange(tree, functionName##_lowerBound(tree, lo), functionName##_lowerBound(tree, hi));\
+}
+
+/**
+ * Instantiates functions to freeze a concrete AVL tree and look up its frozen
+ * copy (see AvlTreeFrozen). Lookups compare items only, without touching
+ * tree nodes, so items should embed the keys. Generates:
+ * - void prefix##_freeze(const AvlTreeFrozen *frozen, const AvlTree *tree, Item *items)
+ *   copying all nodes of tree into items, in linear time; frozen must have
+ *   been initialized from the same tree, unchanged since then;
+ * - const Item *prefix##_find(const AvlTreeFrozen *frozen, const Item *items, const Item *key)
+ *   returning an item equal to key, or NULL if not found;
+ * - const Item *prefix##_lowerBound(const AvlTreeFrozen *frozen, const Item *items, const Item *key)
+ *   returning the first item not less than key, or NULL if all items are less than key.
+ * @param prefix prefix for names of the generated functions (e.g. AvlTreeUintptr_Frozen)
+ * @param Item type of the items of the frozen copy.
+ * @param copy name of the function taking (Item *item, AvlTree_Node *node) to fill an item from a node.
+ * @param isLess name of the function taking (const Item *item, const Item *other) comparing items.
+ */
+#define AvlTree_instantiateFreeze(prefix, Item, copy, isLess)\
+void prefix##_freeze(const AvlTreeFrozen *frozen, const AvlTree *tree, Item *items) {\
+    AvlTree_Node *node = tree->leftmost;\
+    for (size_t i = AvlTreeFrozen_first(frozen); i != 0; i = AvlTreeFrozen_next(frozen, i)) {\
+        assert(node != &tree->sentinel);\
+        copy(&items[AvlTreeFrozen_getSlot(frozen, i)], node);\
+        node = AvlTree_next(tree, node);\
+    }\
+    assert(node == &tree->sentinel);\
+}\
+\
+const Item *prefix##_lowerBound(const AvlTreeFrozen *frozen, const Item *items, const Item *key) {\
+    size_t slots[AvlTreeFrozen_maxHeight];\
+    const Item *found = NULL;\
+    size_t i = 1;\
+    slots[0] = 0;\
+    for (unsigned depth = 0; i <= frozen->count; depth++) {\
+        size_t topSize = frozen->levels[depth].topSize;\
+        slots[depth] = slots[frozen->levels[depth].topDepth] + topSize + (i & topSize) * frozen->levels[depth].bottomSize;\
+        const Item *item = &items[slots[depth]];\
+        if (isLess(item, key)) {\
+            i = 2 * i + 1;\
+        } else {\
+            found = item;\
+            i = 2 * i;\
+        }\
+    }\
+    return found;\
+}\
+\
+const Item *prefix##_find(const AvlTreeFrozen *frozen, const Item *items, const Item *key) {\
+    const Item *found = prefix##_lowerBound(frozen, items, key);\
+    if (found != NULL && isLess(key, found)) return NULL;\
+    return found;\
+}
+
 #endif
@@ -75,6 +75,8 @@ BinaryHeap##_Node *BinaryHeap##_remove(BinaryHeap *heap, BinaryHeap##_Node *node
 BinaryHeap##_Node *BinaryHeap##_poll(BinaryHeap *heap);\
 BinaryHeap##_Node *BinaryHeap##_pollAndInsert(BinaryHeap *heap, BinaryHeap##_Node *newNode);\
 void BinaryHeap##_update(BinaryHeap *heap, BinaryHeap##_Node *node);\
+void BinaryHeap##_buildFromArray(BinaryHeap *heap, BinaryHeap##_Node **nodes, size_t count);\
+void BinaryHeap##_insertMany(BinaryHeap *heap, BinaryHeap##_Node **nodes, size_t count);\
 void BinaryHeap##_check(const BinaryHeap *heap);
 
 
@@ -138,8 +140,8 @@ static void update(BinaryHeap *heap, BinaryHeap##_Node *node) {\
     }\
 }\
 \
-/** Inserts the specified node into the heap. */\
-void BinaryHeap##_insert(BinaryHeap *heap, BinaryHeap##_Node *newNode) {\
+/** Links the specified node as the last level-order node, without restoring the heap property. */\
+static void linkLast(BinaryHeap *heap, BinaryHeap##_Node *newNode) {\
     BinaryHeap##_Node *last = heap->last;\
     newNode->left = NULL;\
     newNode->prev = last;\
@@ -166,6 +168,11 @@ void BinaryHeap##_insert(BinaryHeap *heap, BinaryHeap##_Node *newNode) {\
     newNode->parent = parent;\
     last->next = newNode;\
     heap->last = newNode;\
+}\
+\
+/** Inserts the specified node into the heap. */\
+void BinaryHeap##_insert(BinaryHeap *heap, BinaryHeap##_Node *newNode) {\
+    linkLast(heap, newNode);\
     heapifyUp(heap, newNode);\
 }\
 \
@@ -227,6 +234,76 @@ void BinaryHeap##_replace(BinaryHeap *heap, BinaryHeap##_Node *oldNode, BinaryHe
     update(heap, oldNode);\
 }\
 \
+/**
+ * Links the specified nodes into an empty heap in linear time, rather than
+ * inserting them one at a time. Each node must refer to its value, and the
+ * value to the node, as for insertion. Nodes are linked in level order, then
+ * the heap property is restored by sifting down values of nodes having
+ * children, from the last one to the root (Floyd's construction).
+ */\
+void BinaryHeap##_buildFromArray(BinaryHeap *heap, BinaryHeap##_Node **nodes, size_t count) {\
+    assert(BinaryHeap##_isEmpty(heap));\
+    if (count == 0) return;\
+    for (size_t i = 0; i < count; i++) {\
+        BinaryHeap##_Node *node = nodes[i];\
+        node->parent = (i > 0) ? nodes[(i - 1) / 2] : NULL;\
+        node->left = (2 * i + 1 < count) ? nodes[2 * i + 1] : NULL;\
+        node->prev = (i > 0) ? nodes[i - 1] : NULL;\
+        node->next = (i + 1 < count) ? nodes[i + 1] : NULL;\
+    }\
+    heap->root = nodes[0];\
+    heap->last = nodes[count - 1];\
+    for (size_t i = count / 2; i-- > 0; ) {\
+        heapifyDown(heap, nodes[i]);\
+    }\
+}\
+\
+/**
+ * Inserts the specified nodes into the heap. Each node must refer to its
+ * value, and the value to the node, as for insertion. Nodes are linked
+ * after the last one. If they are all leaves, that is there are fewer
+ * new nodes than old ones, each of them is sifted up, which takes constant
+ * time on average. Otherwise, the heap property is restored by sifting down
+ * values of their ancestors only, from the last one to the root, as in
+ * Floyd's construction. Ancestors of new nodes at each level form a range
+ * in level order, narrowing while going up, thus this takes time linear
+ * in the count of new nodes, plus one sift down per level above.
+ */\
+void BinaryHeap##_insertMany(BinaryHeap *heap, BinaryHeap##_Node **nodes, size_t count) {\
+    if (count == 0) return;\
+    if (heap->root == NULL) {\
+        BinaryHeap##_buildFromArray(heap, nodes, count);\
+        return;\
+    }\
+    BinaryHeap##_Node *oldLast = heap->last;\
+    bool allLeaves = true;\
+    for (size_t i = 0; i < count; i++) {\
+        linkLast(heap, nodes[i]);\
+        if (nodes[i]->parent == oldLast) allLeaves = false;\
+    }\
+    if (allLeaves) {\
+        for (size_t i = 0; i < count; i++) {\
+            heapifyUp(heap, nodes[i]);\
+        }\
+        return;\
+    }\
+    BinaryHeap##_Node *first = nodes[0]->parent;\
+    BinaryHeap##_Node *last = nodes[count - 1]->parent;\
+    while (true) {\
+        /* If the range above overlaps this one, its overlapping part is sifted down in this pass */\
+        BinaryHeap##_Node *lastAbove = last->parent;\
+        bool overlapping = false;\
+        for (BinaryHeap##_Node *x = last; ; x = x->prev) {\
+            if (x == lastAbove) overlapping = true;\
+            heapifyDown(heap, x);\
+            if (x == first) break;\
+        }\
+        if (first->parent == NULL) break;\
+        last = overlapping ? first->prev : lastAbove;\
+        first = first->parent;\
+    }\
+}\
+\
 /** Checks heap invariants. */\
 void BinaryHeap##_check(const BinaryHeap *heap) {\
     for (const BinaryHeap##_Node *i = heap->root; i != NULL; i = i->next) {\
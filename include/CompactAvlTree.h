@@ -0,0 +1,420 @@
+/*
+Intrusive AVL tree container with 32-bit index links.
+Copyright 2015-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/******************************************************************************
+ * This is a poor man's template file.
+ * In order to use the container, you need to instantiate the poor man's
+ * template macros for header and implementation.
+ *
+ * This is a variant of AvlTree for elements living in a single array, where
+ * links are 32-bit indices into the array instead of pointers, resulting in
+ * a 12-byte node instead of a 24-byte one on 64-bit architectures.
+ * The element at index 0 is reserved and used as sentinel, exactly as the
+ * sentinel embedded in AvlTree: its left link refers to the root, and all
+ * leaf links refer to it. Thus up to 2^30 - 1 elements are supported, as
+ * two bits of the parent link hold the balance factor.
+ ******************************************************************************/
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Instantiates the header for an AVL tree with 32-bit index links.
+ * @param CompactAvlTree name of the container to instantiate.
+ * @param Element type of the elements of the array, embedding a CompactAvlTree##_Node.
+ */
+#define CompactAvlTree_header(CompactAvlTree, Element) \
+\
+typedef struct CompactAvlTree##_Node CompactAvlTree##_Node;\
+\
+/** Node of the AVL tree. Embed into elements to be added to the tree. */\
+struct CompactAvlTree##_Node {\
+    uint32_t parent; /* index of the parent shifted left by 2, balance factor in lowest two bits */\
+    uint32_t left;\
+    uint32_t right;\
+};\
+\
+/** AVL tree of elements of an array, caching the leftmost and rightmost ones. */\
+typedef struct CompactAvlTree {\
+    Element *elements; /* elements[0] is the sentinel */\
+    uint32_t leftmost;\
+    uint32_t rightmost;\
+} CompactAvlTree;\
+\
+void     CompactAvlTree##_initialize(CompactAvlTree *tree, Element *elements);\
+void     CompactAvlTree##_insert(CompactAvlTree *tree, uint32_t index);\
+void     CompactAvlTree##_remove(CompactAvlTree *tree, uint32_t index);\
+uint32_t CompactAvlTree##_find(const CompactAvlTree *tree, const Element *key);\
+uint32_t CompactAvlTree##_lowerBound(const CompactAvlTree *tree, const Element *key);\
+\
+/** Returns true if the AVL tree contains no elements. */\
+static inline bool CompactAvlTree##_isEmpty(const CompactAvlTree *tree) {\
+    return tree->leftmost == 0;\
+}
+
+
+/**
+ * Instantiates the implementation for an AVL tree with 32-bit index links.
+ * @param CompactAvlTree name of the container to instantiate.
+ * @param Element type of the elements of the array.
+ * @param nodeField name of the CompactAvlTree##_Node field in Element.
+ * @param isLess function taking (const Element *a, const Element *b) and
+ *        returning a bool indicating whether a is less than b.
+ */
+#define CompactAvlTree_implementation(CompactAvlTree, Element, nodeField, isLess) \
+\
+enum {\
+    CompactAvlTree##_balanced,\
+    CompactAvlTree##_rightHeavy,\
+    CompactAvlTree##_leftHeavy\
+};\
+\
+static inline CompactAvlTree##_Node *CompactAvlTree##_getNode(const CompactAvlTree *tree, uint32_t index) {\
+    return &tree->elements[index].nodeField;\
+}\
+\
+/** Returns the index of the root element, or 0 if the tree is empty. */\
+static inline uint32_t CompactAvlTree##_getRoot(const CompactAvlTree *tree) {\
+    return CompactAvlTree##_getNode(tree, 0)->left;\
+}\
+\
+static inline uint32_t CompactAvlTree##_getParent(const CompactAvlTree##_Node *n) {\
+    return n->parent >> 2;\
+}\
+\
+static inline int CompactAvlTree##_getBalance(const CompactAvlTree##_Node *n) {\
+    return n->parent & 3;\
+}\
+\
+static inline void CompactAvlTree##_setParent(const CompactAvlTree *tree, uint32_t index, uint32_t parent) {\
+    CompactAvlTree##_Node *n = CompactAvlTree##_getNode(tree, index);\
+    n->parent = (parent << 2) | (n->parent & 3);\
+}\
+\
+static inline void CompactAvlTree##_setBalance(CompactAvlTree##_Node *n, int balance) {\
+    n->parent = (n->parent & ~3u) | balance;\
+}\
+\
+static inline uint32_t CompactAvlTree##_findMin(const CompactAvlTree *tree, uint32_t root) {\
+    for (uint32_t left; (left = CompactAvlTree##_getNode(tree, root)->left) != 0; root = left);\
+    return root;\
+}\
+\
+static inline uint32_t CompactAvlTree##_findMax(const CompactAvlTree *tree, uint32_t root) {\
+    for (uint32_t right; (right = CompactAvlTree##_getNode(tree, root)->right) != 0; root = right);\
+    return root;\
+}\
+\
+static void CompactAvlTree##_rotateLeft(CompactAvlTree *tree, uint32_t parent) {\
+    CompactAvlTree##_Node *p = CompactAvlTree##_getNode(tree, parent);\
+    uint32_t child = p->right;\
+    CompactAvlTree##_Node *c = CompactAvlTree##_getNode(tree, child);\
+    int parentBalance = CompactAvlTree##_balanced;\
+    int childBalance = CompactAvlTree##_balanced;\
+    if (CompactAvlTree##_getBalance(c) != CompactAvlTree##_rightHeavy) {\
+        parentBalance = CompactAvlTree##_rightHeavy;\
+        childBalance = CompactAvlTree##_leftHeavy;\
+    }\
+    uint32_t grandParent = CompactAvlTree##_getParent(p);\
+    c->parent = (grandParent << 2) | childBalance;\
+    p->right = c->left;\
+    c->left = parent;\
+    p->parent = (child << 2) | parentBalance;\
+    CompactAvlTree##_setParent(tree, p->right, parent);\
+    CompactAvlTree##_Node *g = CompactAvlTree##_getNode(tree, grandParent);\
+    if (g->right == parent) g->right = child;\
+    else g->left = child;\
+}\
+\
+static void CompactAvlTree##_rotateRight(CompactAvlTree *tree, uint32_t parent) {\
+    CompactAvlTree##_Node *p = CompactAvlTree##_getNode(tree, parent);\
+    uint32_t child = p->left;\
+    CompactAvlTree##_Node *c = CompactAvlTree##_getNode(tree, child);\
+    int parentBalance = CompactAvlTree##_balanced;\
+    int childBalance = CompactAvlTree##_balanced;\
+    if (CompactAvlTree##_getBalance(c) != CompactAvlTree##_leftHeavy) {\
+        parentBalance = CompactAvlTree##_leftHeavy;\
+        childBalance = CompactAvlTree##_rightHeavy;\
+    }\
+    uint32_t grandParent = CompactAvlTree##_getParent(p);\
+    c->parent = (grandParent << 2) | childBalance;\
+    p->left = c->right;\
+    c->right = parent;\
+    p->parent = (child << 2) | parentBalance;\
+    CompactAvlTree##_setParent(tree, p->left, parent);\
+    CompactAvlTree##_Node *g = CompactAvlTree##_getNode(tree, grandParent);\
+    if (g->left == parent) g->left = child;\
+    else g->right = child;\
+}\
+\
+static void CompactAvlTree##_rotateLeftRight(CompactAvlTree *tree, uint32_t parent) {\
+    CompactAvlTree##_Node *p = CompactAvlTree##_getNode(tree, parent);\
+    uint32_t child = p->left;\
+    CompactAvlTree##_Node *c = CompactAvlTree##_getNode(tree, child);\
+    uint32_t grandChild = c->right;\
+    CompactAvlTree##_Node *gc = CompactAvlTree##_getNode(tree, grandChild);\
+    int parentBalance = CompactAvlTree##_balanced;\
+    int childBalance = CompactAvlTree##_balanced;\
+    if (CompactAvlTree##_getBalance(gc) == CompactAvlTree##_rightHeavy) childBalance = CompactAvlTree##_leftHeavy;\
+    else if (CompactAvlTree##_getBalance(gc) == CompactAvlTree##_leftHeavy) parentBalance = CompactAvlTree##_rightHeavy;\
+    uint32_t grandParent = CompactAvlTree##_getParent(p);\
+    p->left = gc->right;\
+    c->right = gc->left;\
+    gc->right = parent;\
+    gc->left = child;\
+    gc->parent = (grandParent << 2) | CompactAvlTree##_balanced;\
+    p->parent = (grandChild << 2) | parentBalance;\
+    c->parent = (grandChild << 2) | childBalance;\
+    CompactAvlTree##_setParent(tree, p->left, parent);\
+    CompactAvlTree##_setParent(tree, c->right, child);\
+    CompactAvlTree##_Node *g = CompactAvlTree##_getNode(tree, grandParent);\
+    if (g->left == parent) g->left = grandChild;\
+    else g->right = grandChild;\
+}\
+\
+static void CompactAvlTree##_rotateRightLeft(CompactAvlTree *tree, uint32_t parent) {\
+    CompactAvlTree##_Node *p = CompactAvlTree##_getNode(tree, parent);\
+    uint32_t child = p->right;\
+    CompactAvlTree##_Node *c = CompactAvlTree##_getNode(tree, child);\
+    uint32_t grandChild = c->left;\
+    CompactAvlTree##_Node *gc = CompactAvlTree##_getNode(tree, grandChild);\
+    int parentBalance = CompactAvlTree##_balanced;\
+    int childBalance = CompactAvlTree##_balanced;\
+    if (CompactAvlTree##_getBalance(gc) == CompactAvlTree##_leftHeavy) childBalance = CompactAvlTree##_rightHeavy;\
+    else if (CompactAvlTree##_getBalance(gc) == CompactAvlTree##_rightHeavy) parentBalance = CompactAvlTree##_leftHeavy;\
+    uint32_t grandParent = CompactAvlTree##_getParent(p);\
+    p->right = gc->left;\
+    c->left = gc->right;\
+    gc->left = parent;\
+    gc->right = child;\
+    gc->parent = (grandParent << 2) | CompactAvlTree##_balanced;\
+    p->parent = (grandChild << 2) | parentBalance;\
+    c->parent = (grandChild << 2) | childBalance;\
+    CompactAvlTree##_setParent(tree, p->right, parent);\
+    CompactAvlTree##_setParent(tree, c->left, child);\
+    CompactAvlTree##_Node *g = CompactAvlTree##_getNode(tree, grandParent);\
+    if (g->right == parent) g->right = grandChild;\
+    else g->left = grandChild;\
+}\
+\
+static void CompactAvlTree##_rebalanceAfterInsertion(CompactAvlTree *tree, uint32_t node) {\
+    while (node != CompactAvlTree##_getRoot(tree)) {\
+        uint32_t parent = CompactAvlTree##_getParent(CompactAvlTree##_getNode(tree, node));\
+        CompactAvlTree##_Node *p = CompactAvlTree##_getNode(tree, parent);\
+        int balance = CompactAvlTree##_getBalance(p);\
+        if (balance == CompactAvlTree##_balanced) {\
+            CompactAvlTree##_setBalance(p, (node == p->left) ? CompactAvlTree##_leftHeavy : CompactAvlTree##_rightHeavy);\
+            node = parent;\
+        } else if (balance == CompactAvlTree##_rightHeavy) {\
+            if (node == p->left) {\
+                CompactAvlTree##_setBalance(p, CompactAvlTree##_balanced);\
+            } else if (CompactAvlTree##_getBalance(CompactAvlTree##_getNode(tree, node)) == CompactAvlTree##_leftHeavy) {\
+                CompactAvlTree##_rotateRightLeft(tree, parent);\
+            } else {\
+                CompactAvlTree##_rotateLeft(tree, parent);\
+            }\
+            return;\
+        } else {\
+            assert(balance == CompactAvlTree##_leftHeavy);\
+            if (node == p->right) {\
+                CompactAvlTree##_setBalance(p, CompactAvlTree##_balanced);\
+            } else if (CompactAvlTree##_getBalance(CompactAvlTree##_getNode(tree, node)) == CompactAvlTree##_rightHeavy) {\
+                CompactAvlTree##_rotateLeftRight(tree, parent);\
+            } else {\
+                CompactAvlTree##_rotateRight(tree, parent);\
+            }\
+            return;\
+        }\
+    }\
+}\
+\
+static void CompactAvlTree##_rebalanceAfterDeletion(CompactAvlTree *tree, uint32_t current, uint32_t parent) {\
+    while (current != CompactAvlTree##_getRoot(tree)) {\
+        CompactAvlTree##_Node *p = CompactAvlTree##_getNode(tree, parent);\
+        int balance = CompactAvlTree##_getBalance(p);\
+        if (balance == CompactAvlTree##_balanced) {\
+            CompactAvlTree##_setBalance(p, (current == p->right) ? CompactAvlTree##_leftHeavy : CompactAvlTree##_rightHeavy);\
+            break;\
+        } else if (balance == CompactAvlTree##_leftHeavy) {\
+            if (current == p->left) {\
+                CompactAvlTree##_setBalance(p, CompactAvlTree##_balanced);\
+                current = parent;\
+            } else {\
+                assert(p->left != 0);\
+                if (CompactAvlTree##_getBalance(CompactAvlTree##_getNode(tree, p->left)) == CompactAvlTree##_rightHeavy) {\
+                    CompactAvlTree##_rotateLeftRight(tree, parent);\
+                } else {\
+                    CompactAvlTree##_rotateRight(tree, parent);\
+                }\
+                current = CompactAvlTree##_getParent(p);\
+                if (CompactAvlTree##_getBalance(CompactAvlTree##_getNode(tree, current)) == CompactAvlTree##_rightHeavy) break;\
+            }\
+        } else {\
+            assert(balance == CompactAvlTree##_rightHeavy);\
+            if (current == p->right) {\
+                CompactAvlTree##_setBalance(p, CompactAvlTree##_balanced);\
+                current = parent;\
+            } else {\
+                assert(p->right != 0);\
+                if (CompactAvlTree##_getBalance(CompactAvlTree##_getNode(tree, p->right)) == CompactAvlTree##_leftHeavy) {\
+                    CompactAvlTree##_rotateRightLeft(tree, parent);\
+                } else {\
+                    CompactAvlTree##_rotateLeft(tree, parent);\
+                }\
+                current = CompactAvlTree##_getParent(p);\
+                if (CompactAvlTree##_getBalance(CompactAvlTree##_getNode(tree, current)) == CompactAvlTree##_leftHeavy) break;\
+            }\
+        }\
+        parent = CompactAvlTree##_getParent(CompactAvlTree##_getNode(tree, current));\
+    }\
+}\
+\
+/**
+ * Initializes an empty AVL tree of elements of the specified array.
+ * The element at index 0 is reserved as sentinel, and must not be inserted.
+ */\
+void CompactAvlTree##_initialize(CompactAvlTree *tree, Element *elements) {\
+    tree->elements = elements;\
+    CompactAvlTree##_Node *sentinel = CompactAvlTree##_getNode(tree, 0);\
+    sentinel->parent = 0;\
+    sentinel->left = 0;\
+    sentinel->right = 0;\
+    tree->leftmost = 0;\
+    tree->rightmost = 0;\
+}\
+\
+/** Inserts the element with the specified index, not less than 1 and less than 2^30. */\
+void CompactAvlTree##_insert(CompactAvlTree *tree, uint32_t index) {\
+    assert(index > 0 && index < (UINT32_C(1) << 30));\
+    CompactAvlTree##_Node *n = CompactAvlTree##_getNode(tree, index);\
+    const Element *element = &tree->elements[index];\
+    n->left = 0;\
+    n->right = 0;\
+    uint32_t parent = tree->rightmost;\
+    if (parent == 0) {\
+        n->parent = CompactAvlTree##_balanced;\
+        CompactAvlTree##_getNode(tree, 0)->left = index;\
+        tree->leftmost = index;\
+        tree->rightmost = index;\
+        return;\
+    }\
+    if (isLess(element, &tree->elements[tree->leftmost])) {\
+        parent = tree->leftmost;\
+        CompactAvlTree##_getNode(tree, parent)->left = index;\
+        tree->leftmost = index;\
+    } else if (!isLess(element, &tree->elements[tree->rightmost])) {\
+        CompactAvlTree##_getNode(tree, parent)->right = index;\
+        tree->rightmost = index;\
+    } else {\
+        parent = CompactAvlTree##_getRoot(tree);\
+        while (true) {\
+            CompactAvlTree##_Node *p = CompactAvlTree##_getNode(tree, parent);\
+            if (isLess(element, &tree->elements[parent])) {\
+                if (p->left == 0) {\
+                    p->left = index;\
+                    break;\
+                }\
+                parent = p->left;\
+            } else {\
+                if (p->right == 0) {\
+                    p->right = index;\
+                    break;\
+                }\
+                parent = p->right;\
+            }\
+        }\
+    }\
+    n->parent = (parent << 2) | CompactAvlTree##_balanced;\
+    CompactAvlTree##_rebalanceAfterInsertion(tree, index);\
+}\
+\
+/** Removes the element with the specified index. */\
+void CompactAvlTree##_remove(CompactAvlTree *tree, uint32_t index) {\
+    CompactAvlTree##_Node *n = CompactAvlTree##_getNode(tree, index);\
+    if (n->left == 0 || n->right == 0) {\
+        uint32_t parent = CompactAvlTree##_getParent(n);\
+        CompactAvlTree##_Node *p = CompactAvlTree##_getNode(tree, parent);\
+        uint32_t replacement = (n->left != 0) ? n->left : n->right;\
+        CompactAvlTree##_setParent(tree, replacement, parent);\
+        if (p->left == index) p->left = replacement;\
+        else p->right = replacement;\
+        if (tree->leftmost == index) {\
+            tree->leftmost = (n->right == 0) ? parent : CompactAvlTree##_findMin(tree, replacement);\
+        }\
+        if (tree->rightmost == index) {\
+            tree->rightmost = (n->left == 0) ? parent : CompactAvlTree##_findMax(tree, replacement);\
+        }\
+        CompactAvlTree##_rebalanceAfterDeletion(tree, replacement, parent);\
+    } else {\
+        assert(index != tree->leftmost);\
+        assert(index != tree->rightmost);\
+        uint32_t successor = CompactAvlTree##_findMin(tree, n->right);\
+        CompactAvlTree##_Node *s = CompactAvlTree##_getNode(tree, successor);\
+        uint32_t replacement = s->right;\
+        uint32_t replacementParent;\
+        CompactAvlTree##_setParent(tree, n->left, successor);\
+        s->left = n->left;\
+        if (successor != n->right) {\
+            replacementParent = CompactAvlTree##_getParent(s);\
+            CompactAvlTree##_setParent(tree, replacement, replacementParent);\
+            CompactAvlTree##_getNode(tree, replacementParent)->left = replacement;\
+            s->right = n->right;\
+            CompactAvlTree##_setParent(tree, n->right, successor);\
+        } else {\
+            replacementParent = successor;\
+        }\
+        uint32_t parent = CompactAvlTree##_getParent(n);\
+        CompactAvlTree##_Node *p = CompactAvlTree##_getNode(tree, parent);\
+        s->parent = n->parent; /* both same parent and balance factor */\
+        if (p->left == index) p->left = successor;\
+        else p->right = successor;\
+        CompactAvlTree##_rebalanceAfterDeletion(tree, replacement, replacementParent);\
+    }\
+}\
+\
+/** Returns the index of the first element not less than key, or 0 if not found. */\
+uint32_t CompactAvlTree##_lowerBound(const CompactAvlTree *tree, const Element *key) {\
+    uint32_t found = 0;\
+    uint32_t i = CompactAvlTree##_getRoot(tree);\
+    while (i != 0) {\
+        const Element *element = &tree->elements[i];\
+        if (isLess(element, key)) {\
+            i = element->nodeField.right;\
+        } else {\
+            found = i;\
+            i = element->nodeField.left;\
+        }\
+    }\
+    return found;\
+}\
+\
+/** Returns the index of the first element equal to key, or 0 if not found. */\
+uint32_t CompactAvlTree##_find(const CompactAvlTree *tree, const Element *key) {\
+    uint32_t found = CompactAvlTree##_lowerBound(tree, key);\
+    if (found != 0 && isLess(key, &tree->elements[found])) return 0;\
+    return found;\
+}
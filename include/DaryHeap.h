@@ -0,0 +1,483 @@
+/*
+Array-backed intrusive d-ary min-heap container.
+Copyright 2009-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/******************************************************************************
+ * This is a poor man's template file.
+ * In order to use the container, you need to instantiate the poor man's
+ * template macros for header and implementation.
+ *
+ * Unlike BinaryHeap and IntrusiveBinaryHeap, nodes are kept in level order
+ * in a caller-provided array of node pointers, thus the children of a node
+ * are found by arithmetic on its index rather than by chasing pointers, and
+ * siblings are contiguous. Each node stores its own array index, so that
+ * arbitrary nodes can be removed or updated in logarithmic time.
+ * Higher arities make the heap shallower, trading more comparisons per level
+ * on the way down for fewer levels, and thus fewer cache misses, on the way
+ * both up and down. Powers of two let the compiler use shifts.
+ *
+ * The KeyedDaryHeap variant caches unsigned integer keys in an array parallel
+ * to the node array, with the children of each node aligned in a group of
+ * arity keys, so that the least child is found by a single SIMD minimum and
+ * position operation rather than by arity - 1 comparisons through pointers.
+ * SIMD is used if the compiler targets SSE4.1 or AVX2 (for example, using
+ * -msse4.1 or -mavx2), unless DARYHEAP_NO_SIMD is defined, otherwise a
+ * scalar fallback is used.
+ ******************************************************************************/
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#if !defined(DARYHEAP_NO_SIMD) && (defined(__SSE4_1__) || defined(__AVX2__))
+#include <immintrin.h>
+#endif
+
+/**
+ * Instantiates the header for an array-backed intrusive d-ary heap container.
+ * @param DaryHeap name of the container to instantiate.
+ */
+#define DaryHeap_header(DaryHeap) \
+\
+typedef struct DaryHeap##_Node DaryHeap##_Node;\
+\
+struct DaryHeap##_Node {\
+    size_t index;\
+};\
+\
+typedef struct DaryHeap {\
+    DaryHeap##_Node **nodes;\
+    size_t count;\
+    size_t capacity;\
+} DaryHeap;\
+\
+/** Initializes an empty heap using the specified array to hold up to capacity nodes. */\
+static inline void DaryHeap##_initialize(DaryHeap *heap, DaryHeap##_Node **nodes, size_t capacity) {\
+    heap->nodes = nodes;\
+    heap->count = 0;\
+    heap->capacity = capacity;\
+}\
+\
+static inline bool DaryHeap##_isEmpty(const DaryHeap *heap) {\
+    return heap->count == 0;\
+}\
+\
+static inline DaryHeap##_Node* DaryHeap##_peek(const DaryHeap *heap) {\
+    return (heap->count != 0) ? heap->nodes[0] : NULL;\
+}\
+\
+void DaryHeap##_insert(DaryHeap *heap, DaryHeap##_Node *node);\
+void DaryHeap##_remove(DaryHeap *heap, DaryHeap##_Node *node);\
+DaryHeap##_Node *DaryHeap##_poll(DaryHeap *heap);\
+DaryHeap##_Node *DaryHeap##_pollAndInsert(DaryHeap *heap, DaryHeap##_Node *newNode);\
+void DaryHeap##_update(DaryHeap *heap, DaryHeap##_Node *node);\
+void DaryHeap##_check(const DaryHeap *heap);
+
+
+/**
+ * Instantiates the implementation for an array-backed intrusive d-ary heap container.
+ * @param DaryHeap name of the container to instantiate.
+ * @param arity count of children of each node, such as 2, 4 or 8.
+ * @param isLess name of the function comparing nodes having the following prototype: bool isLess(DaryHeap_Node *node, DaryHeap_Node *other)
+ */
+#define DaryHeap_implementation(DaryHeap, arity, isLess) \
+\
+_Static_assert((arity) >= 2, "The arity of a d-ary heap must be at least 2");\
+\
+/** Moves parents of the hole at index down until node can fill it. */\
+static void DaryHeap##_siftUp(DaryHeap *heap, DaryHeap##_Node *node, size_t index) {\
+    DaryHeap##_Node **nodes = heap->nodes;\
+    while (index > 0) {\
+        size_t parentIndex = (index - 1) / (arity);\
+        DaryHeap##_Node *parent = nodes[parentIndex];\
+        if (!isLess(node, parent)) break;\
+        nodes[index] = parent;\
+        parent->index = index;\
+        index = parentIndex;\
+    }\
+    nodes[index] = node;\
+    node->index = index;\
+}\
+\
+/** Moves the least children of the hole at index up until node can fill it. */\
+static void DaryHeap##_siftDown(DaryHeap *heap, DaryHeap##_Node *node, size_t index) {\
+    DaryHeap##_Node **nodes = heap->nodes;\
+    size_t count = heap->count;\
+    while (true) {\
+        size_t first = index * (arity) + 1;\
+        if (first >= count) break;\
+        size_t end = (count - first > (arity)) ? first + (arity) : count;\
+        size_t least = first;\
+        for (size_t i = first + 1; i < end; i++) {\
+            if (isLess(nodes[i], nodes[least])) least = i;\
+        }\
+        if (!isLess(nodes[least], node)) break;\
+        nodes[index] = nodes[least];\
+        nodes[index]->index = index;\
+        index = least;\
+    }\
+    nodes[index] = node;\
+    node->index = index;\
+}\
+\
+/** Places node into the hole at index, moving it up or down as needed. */\
+static void DaryHeap##_fill(DaryHeap *heap, DaryHeap##_Node *node, size_t index) {\
+    if ((index > 0) && isLess(node, heap->nodes[(index - 1) / (arity)])) {\
+        DaryHeap##_siftUp(heap, node, index);\
+    } else {\
+        DaryHeap##_siftDown(heap, node, index);\
+    }\
+}\
+\
+/** Inserts the specified node into the heap. The heap must not be full. */\
+void DaryHeap##_insert(DaryHeap *heap, DaryHeap##_Node *node) {\
+    assert(heap->count < heap->capacity);\
+    DaryHeap##_siftUp(heap, node, heap->count++);\
+}\
+\
+/** Removes the specified node from the heap. */\
+void DaryHeap##_remove(DaryHeap *heap, DaryHeap##_Node *node) {\
+    assert(!DaryHeap##_isEmpty(heap));\
+    assert(heap->nodes[node->index] == node);\
+    DaryHeap##_Node *last = heap->nodes[--heap->count];\
+    if (node != last) DaryHeap##_fill(heap, last, node->index);\
+}\
+\
+/** Removes the node for the minimum element from the heap. */\
+DaryHeap##_Node *DaryHeap##_poll(DaryHeap *heap) {\
+    assert(!DaryHeap##_isEmpty(heap));\
+    DaryHeap##_Node *result = heap->nodes[0];\
+    DaryHeap##_Node *last = heap->nodes[--heap->count];\
+    if (heap->count > 0) DaryHeap##_siftDown(heap, last, 0);\
+    return result;\
+}\
+\
+/** Combines a poll and an insert in a single efficient operation. */\
+DaryHeap##_Node *DaryHeap##_pollAndInsert(DaryHeap *heap, DaryHeap##_Node *newNode) {\
+    assert(!DaryHeap##_isEmpty(heap));\
+    DaryHeap##_Node *result = heap->nodes[0];\
+    DaryHeap##_siftDown(heap, newNode, 0);\
+    return result;\
+}\
+\
+/** Updates the heap structure after a change to the key of the specified node. */\
+void DaryHeap##_update(DaryHeap *heap, DaryHeap##_Node *node) {\
+    assert(heap->nodes[node->index] == node);\
+    DaryHeap##_fill(heap, node, node->index);\
+}\
+\
+/** Checks heap invariants. */\
+void DaryHeap##_check(const DaryHeap *heap) {\
+    for (size_t i = 0; i < heap->count; i++) {\
+        assert(heap->nodes[i]->index == i);\
+        if (i > 0) assert(!isLess(heap->nodes[i], heap->nodes[(i - 1) / (arity)]));\
+    }\
+}
+
+
+#ifndef DARYHEAP_SIMD_H
+#define DARYHEAP_SIMD_H
+
+/**
+ * Returns the position of the least of 4 consecutive 32-bit keys,
+ * using SSE4.1 if available.
+ */
+static inline unsigned DaryHeap_findMin4x32(const uint32_t *keys) {
+    #if !defined(DARYHEAP_NO_SIMD) && defined(__SSE4_1__)
+    __m128i v = _mm_loadu_si128((const __m128i *) keys);
+    __m128i m = _mm_min_epu32(v, _mm_shuffle_epi32(v, 0x4E));
+    m = _mm_min_epu32(m, _mm_shuffle_epi32(m, 0xB1));
+    return __builtin_ctz(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, m))));
+    #else
+    unsigned least = 0;
+    for (unsigned i = 1; i < 4; i++) {
+        if (keys[i] < keys[least]) least = i;
+    }
+    return least;
+    #endif
+}
+
+/**
+ * Returns the position of the least of 8 consecutive 32-bit keys,
+ * using AVX2 if available, or SSE4.1 on two halves.
+ */
+static inline unsigned DaryHeap_findMin8x32(const uint32_t *keys) {
+    #if !defined(DARYHEAP_NO_SIMD) && defined(__AVX2__)
+    __m256i v = _mm256_loadu_si256((const __m256i *) keys);
+    __m256i m = _mm256_min_epu32(v, _mm256_permute2x128_si256(v, v, 0x01));
+    m = _mm256_min_epu32(m, _mm256_shuffle_epi32(m, 0x4E));
+    m = _mm256_min_epu32(m, _mm256_shuffle_epi32(m, 0xB1));
+    return __builtin_ctz(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, m))));
+    #elif !defined(DARYHEAP_NO_SIMD) && defined(__SSE4_1__)
+    __m128i lo = _mm_loadu_si128((const __m128i *) keys);
+    __m128i hi = _mm_loadu_si128((const __m128i *) keys + 1);
+    __m128i m = _mm_min_epu32(lo, hi);
+    m = _mm_min_epu32(m, _mm_shuffle_epi32(m, 0x4E));
+    m = _mm_min_epu32(m, _mm_shuffle_epi32(m, 0xB1));
+    unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lo, m)))
+            | (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(hi, m))) << 4);
+    return __builtin_ctz(mask);
+    #else
+    unsigned least = 0;
+    for (unsigned i = 1; i < 8; i++) {
+        if (keys[i] < keys[least]) least = i;
+    }
+    return least;
+    #endif
+}
+
+#if !defined(DARYHEAP_NO_SIMD) && defined(__AVX2__)
+/**
+ * Internal function returning the lane-wise minimum of 64-bit keys biased
+ * by their sign bit, as AVX2 only has signed 64-bit comparisons.
+ */
+static inline __m256i DaryHeap_min4x64(__m256i a, __m256i b) {
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+
+/** Internal function returning 4 consecutive 64-bit keys biased by their sign bit. */
+static inline __m256i DaryHeap_loadBiased4x64(const uint64_t *keys) {
+    return _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) keys), _mm256_set1_epi64x(INT64_MIN));
+}
+
+/** Internal function broadcasting the minimum of 4 biased 64-bit keys to all lanes. */
+static inline __m256i DaryHeap_reduceMin4x64(__m256i m) {
+    m = DaryHeap_min4x64(m, _mm256_permute4x64_epi64(m, 0x4E));
+    return DaryHeap_min4x64(m, _mm256_permute4x64_epi64(m, 0xB1));
+}
+#endif
+
+/** Returns the position of the least of 4 consecutive 64-bit keys, using AVX2 if available. */
+static inline unsigned DaryHeap_findMin4x64(const uint64_t *keys) {
+    #if !defined(DARYHEAP_NO_SIMD) && defined(__AVX2__)
+    __m256i v = DaryHeap_loadBiased4x64(keys);
+    __m256i m = DaryHeap_reduceMin4x64(v);
+    return __builtin_ctz(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, m))));
+    #else
+    unsigned least = 0;
+    for (unsigned i = 1; i < 4; i++) {
+        if (keys[i] < keys[least]) least = i;
+    }
+    return least;
+    #endif
+}
+
+/** Returns the position of the least of 8 consecutive 64-bit keys, using AVX2 on two halves if available. */
+static inline unsigned DaryHeap_findMin8x64(const uint64_t *keys) {
+    #if !defined(DARYHEAP_NO_SIMD) && defined(__AVX2__)
+    __m256i lo = DaryHeap_loadBiased4x64(keys);
+    __m256i hi = DaryHeap_loadBiased4x64(keys + 4);
+    __m256i m = DaryHeap_reduceMin4x64(DaryHeap_min4x64(lo, hi));
+    unsigned mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lo, m)))
+            | (_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(hi, m))) << 4);
+    return __builtin_ctz(mask);
+    #else
+    unsigned least = 0;
+    for (unsigned i = 1; i < 8; i++) {
+        if (keys[i] < keys[least]) least = i;
+    }
+    return least;
+    #endif
+}
+
+#endif /* DARYHEAP_SIMD_H */
+
+
+/**
+ * Instantiates the header for a key-cached intrusive d-ary heap container.
+ * Slots of the first arity - 1 positions are left unused, so that each
+ * group of children starts at a multiple of arity, and the last group is
+ * padded with the largest key. Hence both the node and the key arrays must
+ * have room for KeyedDaryHeap_getSlotCount(capacity) elements, and the
+ * key array is best aligned to arity keys.
+ * @param KeyedDaryHeap name of the container to instantiate.
+ * @param Key unsigned integral type for keys, such as uint32_t or uint64_t.
+ * @param arity count of children of each node, 4 or 8 for SIMD.
+ */
+#define KeyedDaryHeap_header(KeyedDaryHeap, Key, arity) \
+\
+typedef struct KeyedDaryHeap##_Node KeyedDaryHeap##_Node;\
+\
+struct KeyedDaryHeap##_Node {\
+    size_t index;\
+};\
+\
+typedef struct KeyedDaryHeap {\
+    Key *keys;\
+    KeyedDaryHeap##_Node **nodes;\
+    size_t count;\
+    size_t capacity;\
+} KeyedDaryHeap;\
+\
+/** Returns the count of slots the arrays of a heap with the specified capacity must have. */\
+static inline size_t KeyedDaryHeap##_getSlotCount(size_t capacity) {\
+    return (capacity + 2 * (arity) - 2) / (arity) * (arity);\
+}\
+\
+/** Initializes an empty heap using the specified arrays, each with KeyedDaryHeap_getSlotCount(capacity) slots. */\
+static inline void KeyedDaryHeap##_initialize(KeyedDaryHeap *heap, Key *keys, KeyedDaryHeap##_Node **nodes, size_t capacity) {\
+    heap->keys = keys;\
+    heap->nodes = nodes;\
+    heap->count = 0;\
+    heap->capacity = capacity;\
+}\
+\
+static inline bool KeyedDaryHeap##_isEmpty(const KeyedDaryHeap *heap) {\
+    return heap->count == 0;\
+}\
+\
+static inline KeyedDaryHeap##_Node* KeyedDaryHeap##_peek(const KeyedDaryHeap *heap) {\
+    return (heap->count != 0) ? heap->nodes[(arity) - 1] : NULL;\
+}\
+\
+/** Returns the key of the specified node, which must be in the heap. */\
+static inline Key KeyedDaryHeap##_getKey(const KeyedDaryHeap *heap, const KeyedDaryHeap##_Node *node) {\
+    return heap->keys[node->index];\
+}\
+\
+void KeyedDaryHeap##_insert(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *node, Key key);\
+void KeyedDaryHeap##_remove(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *node);\
+KeyedDaryHeap##_Node *KeyedDaryHeap##_poll(KeyedDaryHeap *heap);\
+KeyedDaryHeap##_Node *KeyedDaryHeap##_pollAndInsert(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *newNode, Key key);\
+void KeyedDaryHeap##_update(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *node, Key key);\
+void KeyedDaryHeap##_check(const KeyedDaryHeap *heap);
+
+
+/**
+ * Instantiates the implementation for a key-cached intrusive d-ary heap container.
+ * The node at level order position k lives in slot k + arity - 1, so the
+ * children of slot s are the arity slots starting at arity * (s - arity + 2).
+ * @param KeyedDaryHeap name of the container to instantiate.
+ * @param Key unsigned integral type for keys, such as uint32_t or uint64_t.
+ * @param arity count of children of each node, 4 or 8 for SIMD.
+ * @param findMin name of the function returning the position of the least of arity consecutive keys, such as DaryHeap_findMin4x64.
+ */
+#define KeyedDaryHeap_implementation(KeyedDaryHeap, Key, arity, findMin) \
+\
+_Static_assert((arity) >= 2, "The arity of a d-ary heap must be at least 2");\
+\
+static inline void KeyedDaryHeap##_place(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *node, Key key, size_t slot) {\
+    heap->keys[slot] = key;\
+    heap->nodes[slot] = node;\
+    node->index = slot;\
+}\
+\
+/** Moves parents of the hole at slot down until node can fill it. */\
+static void KeyedDaryHeap##_siftUp(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *node, Key key, size_t slot) {\
+    while (slot > (arity) - 1) {\
+        size_t parent = slot / (arity) + (arity) - 2;\
+        if (!(key < heap->keys[parent])) break;\
+        KeyedDaryHeap##_place(heap, heap->nodes[parent], heap->keys[parent], slot);\
+        slot = parent;\
+    }\
+    KeyedDaryHeap##_place(heap, node, key, slot);\
+}\
+\
+/** Moves the least children of the hole at slot up until node can fill it. */\
+static void KeyedDaryHeap##_siftDown(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *node, Key key, size_t slot) {\
+    size_t end = heap->count + (arity) - 1;\
+    while (true) {\
+        size_t first = (arity) * (slot - (arity) + 2);\
+        if (first >= end) break;\
+        size_t least = first + findMin(&heap->keys[first]);\
+        if (!(heap->keys[least] < key)) break;\
+        KeyedDaryHeap##_place(heap, heap->nodes[least], heap->keys[least], slot);\
+        slot = least;\
+    }\
+    KeyedDaryHeap##_place(heap, node, key, slot);\
+}\
+\
+/** Places node into the hole at slot, moving it up or down as needed. */\
+static void KeyedDaryHeap##_fill(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *node, Key key, size_t slot) {\
+    if ((slot > (arity) - 1) && (key < heap->keys[slot / (arity) + (arity) - 2])) {\
+        KeyedDaryHeap##_siftUp(heap, node, key, slot);\
+    } else {\
+        KeyedDaryHeap##_siftDown(heap, node, key, slot);\
+    }\
+}\
+\
+/** Inserts the specified node with the specified key into the heap. The heap must not be full. */\
+void KeyedDaryHeap##_insert(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *node, Key key) {\
+    assert(heap->count < heap->capacity);\
+    size_t slot = heap->count + (arity) - 1;\
+    if (slot % (arity) == 0) {\
+        /* Starting a new group of children, pad it with the largest key */\
+        for (size_t i = slot + 1; i < slot + (arity); i++) heap->keys[i] = (Key) -1;\
+    }\
+    heap->count++;\
+    KeyedDaryHeap##_siftUp(heap, node, key, slot);\
+}\
+\
+/** Removes the last node from the heap, returning it along with its key. */\
+static KeyedDaryHeap##_Node *KeyedDaryHeap##_removeLast(KeyedDaryHeap *heap, Key *key) {\
+    size_t slot = --heap->count + (arity) - 1;\
+    *key = heap->keys[slot];\
+    heap->keys[slot] = (Key) -1;\
+    return heap->nodes[slot];\
+}\
+\
+/** Removes the specified node from the heap. */\
+void KeyedDaryHeap##_remove(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *node) {\
+    assert(!KeyedDaryHeap##_isEmpty(heap));\
+    assert(heap->nodes[node->index] == node);\
+    Key key;\
+    KeyedDaryHeap##_Node *last = KeyedDaryHeap##_removeLast(heap, &key);\
+    if (node != last) KeyedDaryHeap##_fill(heap, last, key, node->index);\
+}\
+\
+/** Removes the node for the minimum key from the heap. */\
+KeyedDaryHeap##_Node *KeyedDaryHeap##_poll(KeyedDaryHeap *heap) {\
+    assert(!KeyedDaryHeap##_isEmpty(heap));\
+    KeyedDaryHeap##_Node *result = heap->nodes[(arity) - 1];\
+    Key key;\
+    KeyedDaryHeap##_Node *last = KeyedDaryHeap##_removeLast(heap, &key);\
+    if (heap->count > 0) KeyedDaryHeap##_siftDown(heap, last, key, (arity) - 1);\
+    return result;\
+}\
+\
+/** Combines a poll and an insert in a single efficient operation. */\
+KeyedDaryHeap##_Node *KeyedDaryHeap##_pollAndInsert(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *newNode, Key key) {\
+    assert(!KeyedDaryHeap##_isEmpty(heap));\
+    KeyedDaryHeap##_Node *result = heap->nodes[(arity) - 1];\
+    KeyedDaryHeap##_siftDown(heap, newNode, key, (arity) - 1);\
+    return result;\
+}\
+\
+/** Changes the key of the specified node, updating the heap structure. */\
+void KeyedDaryHeap##_update(KeyedDaryHeap *heap, KeyedDaryHeap##_Node *node, Key key) {\
+    assert(heap->nodes[node->index] == node);\
+    KeyedDaryHeap##_fill(heap, node, key, node->index);\
+}\
+\
+/** Checks heap invariants, including padding of the last group of children. */\
+void KeyedDaryHeap##_check(const KeyedDaryHeap *heap) {\
+    size_t end = heap->count + (arity) - 1;\
+    for (size_t slot = (arity) - 1; slot < end; slot++) {\
+        assert(heap->nodes[slot]->index == slot);\
+        if (slot > (arity) - 1) assert(!(heap->keys[slot] < heap->keys[slot / (arity) + (arity) - 2]));\
+    }\
+    for (size_t slot = end; (slot % (arity) != 0) && (slot > (arity) - 1); slot++) {\
+        assert(heap->keys[slot] == (Key) -1);\
+    }\
+}
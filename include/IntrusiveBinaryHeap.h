@@ -30,6 +30,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * template macros for header and implementation.
  ******************************************************************************/
 #include <assert.h>
+#include <limits.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -70,6 +71,8 @@ void IntrusiveBinaryHeap##_insert(IntrusiveBinaryHeap *heap, IntrusiveBinaryHeap
 void IntrusiveBinaryHeap##_remove(IntrusiveBinaryHeap *heap, IntrusiveBinaryHeap##_Node *node);\
 IntrusiveBinaryHeap##_Node *IntrusiveBinaryHeap##_poll(IntrusiveBinaryHeap *heap);\
 IntrusiveBinaryHeap##_Node *IntrusiveBinaryHeap##_pollAndInsert(IntrusiveBinaryHeap *heap, IntrusiveBinaryHeap##_Node *newNode);\
+void IntrusiveBinaryHeap##_buildFromArray(IntrusiveBinaryHeap *heap, IntrusiveBinaryHeap##_Node **nodes, size_t count);\
+void IntrusiveBinaryHeap##_insertMany(IntrusiveBinaryHeap *heap, IntrusiveBinaryHeap##_Node **nodes, size_t count);\
 void IntrusiveBinaryHeap##_check(IntrusiveBinaryHeap *heap);
 
 
@@ -80,6 +83,17 @@ void IntrusiveBinaryHeap##_check(IntrusiveBinaryHeap *heap);
  */
 #define IntrusiveBinaryHeap_implementation(IntrusiveBinaryHeap, isLess) \
 \
+/**
+ * Computes the depth of the node with the specified 1-based index, that is
+ * the position of its most significant bit, for whatever width of size_t.
+ */\
+static inline unsigned getDepth(size_t index) {\
+    if (sizeof(size_t) <= sizeof(unsigned long)) {\
+        return sizeof(unsigned long) * CHAR_BIT - 1 - __builtin_clzl(index);\
+    }\
+    return sizeof(unsigned long long) * CHAR_BIT - 1 - __builtin_clzll(index);\
+}\
+\
 /**
  * Computes the level mask for the specified 1-based node index.
  * The level mask is used to mask bits of the node index to decide whether
@@ -93,9 +107,45 @@ void IntrusiveBinaryHeap##_check(IntrusiveBinaryHeap *heap);
  * with index 6 (110b) we need to turn right then left (discard the first 1,
  * then 1, then 0).
  */\
-static inline unsigned getLevelMask(unsigned index) {\
+static inline size_t getLevelMask(size_t index) {\
     if (index == 1) return 0;\
-    return 1 << (32 - __builtin_clz(index) - 2);\
+    return (size_t) 1 << (getDepth(index) - 1);\
+}\
+\
+/**
+ * Places a node into the hole with the specified index, linked from
+ * parentLink and having the specified children, pulling up the lesser child
+ * until the node is less than both children.
+ */\
+static void pullUpChildren(IntrusiveBinaryHeap##_Node **parentLink, IntrusiveBinaryHeap##_Node *descendingNode, size_t index,\
+        IntrusiveBinaryHeap##_Node *left, IntrusiveBinaryHeap##_Node *right) {\
+    while (true) {\
+        IntrusiveBinaryHeap##_Node *higher = left;\
+        if (higher == NULL) higher = right;\
+        else if (right != NULL) higher = isLess(left, right) ? left : right;\
+        if (higher == NULL || isLess(descendingNode, higher)) {\
+            descendingNode->index = index;\
+            descendingNode->left = left;\
+            descendingNode->right = right;\
+            *parentLink = descendingNode;\
+            return;\
+        }\
+        IntrusiveBinaryHeap##_Node *childLeft = higher->left;\
+        IntrusiveBinaryHeap##_Node *childRight = higher->right;\
+        *parentLink = higher;\
+        if (higher == left) {\
+            higher->right = right;\
+            parentLink = &higher->left;\
+        } else {\
+            higher->left = left;\
+            parentLink = &higher->right;\
+        }\
+        size_t childIndex = higher->index;\
+        higher->index = index;\
+        index = childIndex;\
+        left = childLeft;\
+        right = childRight;\
+    }\
 }\
 \
 /**
@@ -158,37 +208,7 @@ static void insertFromRoot(IntrusiveBinaryHeap *heap, IntrusiveBinaryHeap##_Node
      * parentLink to the link to parent.
      * If the current node is not less than its children, pull up children.
      */\
-    IntrusiveBinaryHeap##_Node *left = curr->left;\
-    IntrusiveBinaryHeap##_Node *right = curr->right;\
-    descendingNode->left = left;\
-    descendingNode->right = right;\
-    while (true) {\
-        IntrusiveBinaryHeap##_Node *higher = left;\
-        if (higher == NULL) higher = right;\
-        else if (right != NULL) higher = isLess(left, right) ? left : right;\
-        if (higher == NULL || isLess(descendingNode, higher)) {\
-            descendingNode->index = index;\
-            descendingNode->left = left;\
-            descendingNode->right = right;\
-            *parentLink = descendingNode;\
-            return;\
-        }\
-        IntrusiveBinaryHeap##_Node *childLeft = higher->left;\
-        IntrusiveBinaryHeap##_Node *childRight = higher->right;\
-        *parentLink = higher;\
-        if (higher == left) {\
-            higher->right = right;\
-            parentLink = &higher->left;\
-        } else {\
-            higher->left = left;\
-            parentLink = &higher->right;\
-        }\
-        size_t childIndex = higher->index;\
-        higher->index = index;\
-        index = childIndex;\
-        left = childLeft;\
-        right = childRight;\
-    }\
+    pullUpChildren(parentLink, descendingNode, index, curr->left, curr->right);\
 }\
 \
 static IntrusiveBinaryHeap##_Node *removeLast(IntrusiveBinaryHeap *heap) {\
@@ -252,6 +272,80 @@ IntrusiveBinaryHeap##_Node *IntrusiveBinaryHeap##_pollAndInsert(IntrusiveBinaryH
     newNode->index = 1;\
     insertFromRoot(heap, newNode);\
     return result;\
+}\
+\
+/**
+ * Links the specified nodes into an empty heap in linear time, rather than
+ * inserting them one at a time. Nodes are linked in level order, assigning
+ * their indices, then the heap property is restored by sifting down nodes
+ * having children, from the last one to the root (Floyd's construction).
+ * The parent of a node still to sift down keeps its original position,
+ * thus it is found in the array.
+ */\
+void IntrusiveBinaryHeap##_buildFromArray(IntrusiveBinaryHeap *heap, IntrusiveBinaryHeap##_Node **nodes, size_t count) {\
+    assert(heap->root == NULL);\
+    if (count == 0) return;\
+    for (size_t i = 0; i < count; i++) {\
+        nodes[i]->index = i + 1;\
+        nodes[i]->left = (2 * i + 1 < count) ? nodes[2 * i + 1] : NULL;\
+        nodes[i]->right = (2 * i + 2 < count) ? nodes[2 * i + 2] : NULL;\
+    }\
+    heap->root = nodes[0];\
+    heap->count = count;\
+    for (size_t i = count / 2; i-- > 0; ) {\
+        IntrusiveBinaryHeap##_Node *parent = (i > 0) ? nodes[(i - 1) / 2] : NULL;\
+        IntrusiveBinaryHeap##_Node **parentLink = &heap->root;\
+        if (parent != NULL) parentLink = (i % 2 == 1) ? &parent->left : &parent->right;\
+        pullUpChildren(parentLink, nodes[i], i + 1, nodes[i]->left, nodes[i]->right);\
+    }\
+}\
+\
+/** Tells whether the subtree rooted at the specified index has nodes with index first or greater. */\
+static bool reachesIndex(size_t index, size_t first, size_t count) {\
+    if (index > count) return false;\
+    unsigned shift = getDepth(count) - getDepth(index);\
+    if ((index << shift) > count) shift--;\
+    size_t lastIndex = ((index + 1) << shift) - 1;\
+    return ((lastIndex < count) ? lastIndex : count) >= first;\
+}\
+\
+/**
+ * Restores the heap property in the subtree rooted at the specified index,
+ * whose nodes from index first onwards are new, taken from newNodes.
+ * Subtrees with no new nodes are left alone, the others are restored
+ * recursively before pulling up children into the hole at index.
+ */\
+static void heapifyNewNodes(IntrusiveBinaryHeap##_Node **parentLink, size_t index, size_t first, size_t count,\
+        IntrusiveBinaryHeap##_Node **newNodes) {\
+    IntrusiveBinaryHeap##_Node *node;\
+    if (index >= first) {\
+        node = newNodes[index - first];\
+        node->left = NULL;\
+        node->right = NULL;\
+    } else {\
+        node = *parentLink;\
+    }\
+    if (reachesIndex(2 * index, first, count)) {\
+        heapifyNewNodes(&node->left, 2 * index, first, count, newNodes);\
+    }\
+    if (reachesIndex(2 * index + 1, first, count)) {\
+        heapifyNewNodes(&node->right, 2 * index + 1, first, count, newNodes);\
+    }\
+    pullUpChildren(parentLink, node, index, node->left, node->right);\
+}\
+\
+/**
+ * Inserts the specified nodes into the heap. Rather than descending from
+ * the root for each of them, nodes are placed after the last one, then the
+ * heap property is restored by sifting down only their ancestors, deepest
+ * first, as in Floyd's construction. This takes time linear in the count
+ * of new nodes, plus one sift down per level above.
+ */\
+void IntrusiveBinaryHeap##_insertMany(IntrusiveBinaryHeap *heap, IntrusiveBinaryHeap##_Node **nodes, size_t count) {\
+    if (count == 0) return;\
+    size_t first = heap->count + 1;\
+    heap->count += count;\
+    heapifyNewNodes(&heap->root, 1, first, heap->count, nodes);\
 }
 
 
@@ -278,9 +372,8 @@ static void check(IntrusiveBinaryHeap *heap, IntrusiveBinaryHeap##_Node *parent,
 \
 /** Checks structural invariants for the heap. */\
 void IntrusiveBinaryHeap##_check(IntrusiveBinaryHeap *heap) {\
-    if (heap->root != NULL) {\
-        check(heap, NULL, heap->root);\
-    }\
+    if (heap->root == NULL) return;\
+    check(heap, NULL, heap->root);\
     IntrusiveBinaryHeap##_Node **nodes = malloc(heap->count * sizeof(IntrusiveBinaryHeap##_Node *));\
     size_t head = 0;\
     nodes[0] = heap->root;\
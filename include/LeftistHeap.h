@@ -64,6 +64,7 @@ static inline bool LeftistHeap##_isEmpty(const LeftistHeap *tree) {\
 void LeftistHeap##_insert(LeftistHeap *heap, LeftistHeap##_Node *node);\
 void LeftistHeap##_remove(LeftistHeap *heap, LeftistHeap##_Node *node);\
 LeftistHeap##_Node *LeftistHeap##_poll(LeftistHeap *heap);\
+void LeftistHeap##_insertMany(LeftistHeap *heap, LeftistHeap##_Node **nodes, size_t count);\
 void LeftistHeap##_merge(LeftistHeap *heap, LeftistHeap *other);\
 void LeftistHeap##_check(LeftistHeap *heap);
 
@@ -183,6 +184,39 @@ LeftistHeap##_Node *LeftistHeap##_poll(LeftistHeap *heap) {\
     return root;\
 }\
 \
+/**
+ * Inserts the specified nodes into the heap. Rather than merging them
+ * one at a time with the whole heap, they are merged pairwise into a heap
+ * of their own in linear time, using a queue of heaps threaded through
+ * the parent links of their roots, then the result is merged with the heap.
+ */\
+void LeftistHeap##_insertMany(LeftistHeap *heap, LeftistHeap##_Node **nodes, size_t count) {\
+    if (count == 0) return;\
+    LeftistHeap##_Node *head = NULL;\
+    LeftistHeap##_Node *tail = NULL;\
+    for (size_t i = 0; i < count; i++) {\
+        LeftistHeap##_Node *node = nodes[i];\
+        node->parent = NULL;\
+        node->left = NULL;\
+        node->right = NULL;\
+        node->s = 1;\
+        if (tail != NULL) tail->parent = node;\
+        else head = node;\
+        tail = node;\
+    }\
+    while (head != tail) {\
+        LeftistHeap##_Node *first = head;\
+        LeftistHeap##_Node *second = first->parent;\
+        head = second->parent;\
+        LeftistHeap##_Node *merged = merge(first, second);\
+        merged->parent = NULL;\
+        if (head != NULL) tail->parent = merged;\
+        else head = merged;\
+        tail = merged;\
+    }\
+    heap->root = (heap->root != NULL) ? merge(heap->root, head) : head;\
+}\
+\
 /** Merges to non-empty heaps. */\
 void LeftistHeap##_merge(LeftistHeap *heap, LeftistHeap *other) {\
     heap->root = merge(heap->root, other->root);\
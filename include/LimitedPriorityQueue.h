@@ -28,6 +28,21 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * This is a poor man's template file.
  * In order to use the container, you need to instantiate the poor man's
  * template macros for header and implementation.
+ *
+ * Elements are kept in a linked list for each priority. A hierarchy of
+ * 64-bit summary bitmaps finds the first non-empty list: level 0 has a bit
+ * for each priority, and each bit of a higher level tells whether a word of
+ * the level below is non-zero, up to a single word. Finding the first
+ * non-empty list thus takes one bit scan per level, that is 1 level up to 64
+ * priorities, 2 levels up to 4096, 3 levels up to 262144 and so on.
+ *
+ * The SparseLimitedPriorityQueue variant has no sentinel for each priority,
+ * that would take 16 bytes per priority on 64-bit architectures even if
+ * empty. Lists are circular among their elements, and the first element of
+ * each non-empty list is kept in a caller-provided hash table, by priority,
+ * with linear probing. Memory thus scales with the count of distinct
+ * priorities in the queue, plus one bit per priority for bitmaps, while
+ * insertion and removal still take expected constant time.
  ******************************************************************************/
 #include <assert.h>
 #include <stddef.h>
@@ -35,6 +50,101 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdbool.h>
 #include <string.h>
 
+/** Count of 64-bit words of the summary bitmap level above one with the specified count of words, 0 if it is the top level. */
+#define LimitedPriorityQueue_upperWords(words) ((words) > 1 ? ((words) + 63) / 64 : 0)
+
+/** The highest supported priorityCount, with 5 levels of bitmaps. */
+#define LimitedPriorityQueue_maxPriorityCount (1 << 30)
+
+/**
+ * Instantiates the sizes of the summary bitmaps, shared by all variants.
+ * @param LimitedPriorityQueue name of the container to instantiate.
+ * @param priorityCount one past the highest allowed value for priorities.
+ */
+#define LimitedPriorityQueue_bitmapHeader(LimitedPriorityQueue, priorityCount) \
+\
+_Static_assert((priorityCount) > 0 && (priorityCount) <= LimitedPriorityQueue_maxPriorityCount, "priorityCount exceeds the limit of LimitedPriorityQueue");\
+\
+/* Count of 64-bit words of each level of the summary bitmaps, from level 0 */\
+enum {\
+    LimitedPriorityQueue##_words0 = ((priorityCount) + 63) / 64,\
+    LimitedPriorityQueue##_words1 = LimitedPriorityQueue_upperWords(LimitedPriorityQueue##_words0),\
+    LimitedPriorityQueue##_words2 = LimitedPriorityQueue_upperWords(LimitedPriorityQueue##_words1),\
+    LimitedPriorityQueue##_words3 = LimitedPriorityQueue_upperWords(LimitedPriorityQueue##_words2),\
+    LimitedPriorityQueue##_words4 = LimitedPriorityQueue_upperWords(LimitedPriorityQueue##_words3),\
+    LimitedPriorityQueue##_levelCount = 1 + (LimitedPriorityQueue##_words1 > 0) + (LimitedPriorityQueue##_words2 > 0)\
+            + (LimitedPriorityQueue##_words3 > 0) + (LimitedPriorityQueue##_words4 > 0),\
+    LimitedPriorityQueue##_bitmapWords = LimitedPriorityQueue##_words0 + LimitedPriorityQueue##_words1\
+            + LimitedPriorityQueue##_words2 + LimitedPriorityQueue##_words3 + LimitedPriorityQueue##_words4\
+};
+
+
+/**
+ * Instantiates the functions operating on the summary bitmaps, shared by all variants.
+ * Bitmaps are arrays of LimitedPriorityQueue##_bitmapWords words, with levels
+ * from 0, thus the top level is the last word.
+ * @param LimitedPriorityQueue name of the container to instantiate.
+ * @param priorityCount one past the highest allowed value for priorities.
+ */
+#define LimitedPriorityQueue_bitmapImplementation(LimitedPriorityQueue, priorityCount) \
+\
+/** Offsets of each level of the summary bitmaps in the bitmap array. */\
+static const size_t LimitedPriorityQueue##_offsets[5] = {\
+    0,\
+    LimitedPriorityQueue##_words0,\
+    LimitedPriorityQueue##_words0 + LimitedPriorityQueue##_words1,\
+    LimitedPriorityQueue##_words0 + LimitedPriorityQueue##_words1 + LimitedPriorityQueue##_words2,\
+    LimitedPriorityQueue##_words0 + LimitedPriorityQueue##_words1 + LimitedPriorityQueue##_words2 + LimitedPriorityQueue##_words3\
+};\
+\
+/** Returns the first priority whose bit is set, scanning bitmaps from the top level. Call only if not empty. */\
+static inline size_t LimitedPriorityQueue##_findFirstBitSet(const uint64_t *bitmap) {\
+    size_t i = 0;\
+    for (int level = LimitedPriorityQueue##_levelCount - 1; level >= 0; level--) {\
+        uint64_t word = bitmap[LimitedPriorityQueue##_offsets[level] + i];\
+        assert(word != 0);\
+        i = i * 64 + __builtin_ctzll(word);\
+    }\
+    return i;\
+}\
+\
+/** Sets the bit for the specified priority, and the bits of upper levels for words becoming non-zero. */\
+static inline void LimitedPriorityQueue##_setBit(uint64_t *bitmap, size_t i) {\
+    for (size_t level = 0; level < LimitedPriorityQueue##_levelCount; level++) {\
+        uint64_t *word = &bitmap[LimitedPriorityQueue##_offsets[level] + i / 64];\
+        uint64_t old = *word;\
+        *word = old | (UINT64_C(1) << (i % 64));\
+        if (old != 0) break;\
+        i /= 64;\
+    }\
+}\
+\
+/** Clears the bit for the specified priority, and the bits of upper levels for words becoming zero. */\
+static inline void LimitedPriorityQueue##_clearBit(uint64_t *bitmap, size_t i) {\
+    for (size_t level = 0; level < LimitedPriorityQueue##_levelCount; level++) {\
+        uint64_t *word = &bitmap[LimitedPriorityQueue##_offsets[level] + i / 64];\
+        *word &= ~(UINT64_C(1) << (i % 64));\
+        if (*word != 0) break;\
+        i /= 64;\
+    }\
+}\
+\
+static inline bool LimitedPriorityQueue##_isBitSet(const uint64_t *bitmap, size_t i) {\
+    return ((bitmap[i / 64] >> (i % 64)) & 1) != 0;\
+}\
+\
+/** Checks that each level of the summary bitmaps above 0 matches the level below. */\
+static void LimitedPriorityQueue##_checkBitmap(const uint64_t *bitmap) {\
+    size_t count = (priorityCount);\
+    for (size_t level = 1; level < LimitedPriorityQueue##_levelCount; level++) {\
+        count = (count + 63) / 64;\
+        for (size_t i = 0; i < count; i++) {\
+            assert(LimitedPriorityQueue##_isBitSet(bitmap + LimitedPriorityQueue##_offsets[level], i)\
+                    == (bitmap[LimitedPriorityQueue##_offsets[level - 1] + i] != 0));\
+        }\
+    }\
+}
+
 /**
  * Instantiates the header for a limited priority queue.
  * @param LimitedPriorityQueue name of the container to instantiate.
@@ -49,20 +159,22 @@ struct LimitedPriorityQueue##_Node {\
     LimitedPriorityQueue##_Node *next;\
 };\
 \
+LimitedPriorityQueue_bitmapHeader(LimitedPriorityQueue, priorityCount)\
+\
 typedef struct LimitedPriorityQueue {\
     LimitedPriorityQueue##_Node lists[priorityCount];\
     LimitedPriorityQueue##_Node *top;\
-    uint32_t topmap;\
-    uint32_t bitmap[priorityCount / 32];\
+    uint64_t bitmap[LimitedPriorityQueue##_bitmapWords]; /* levels from 0, the top level is the last word */\
 } LimitedPriorityQueue;\
 \
-static inline bool LimitedPriorityQueue##_isEmpty(const LimitedPriorityQueue *queue) { return queue->topmap == 0; }\
-static LimitedPriorityQueue##_Node* LimitedPriorityQueue##_peek(const LimitedPriorityQueue *queue) { return queue->top; }\
+static inline bool LimitedPriorityQueue##_isEmpty(const LimitedPriorityQueue *queue) { return queue->bitmap[LimitedPriorityQueue##_bitmapWords - 1] == 0; }\
+static inline LimitedPriorityQueue##_Node* LimitedPriorityQueue##_peek(const LimitedPriorityQueue *queue) { return queue->top; }\
 void LimitedPriorityQueue##_initialize(LimitedPriorityQueue *queue);\
 void LimitedPriorityQueue##_insertFront(LimitedPriorityQueue *queue, LimitedPriorityQueue##_Node *x);\
 void LimitedPriorityQueue##_insert(LimitedPriorityQueue *queue, LimitedPriorityQueue##_Node *x);\
-LimitedPriorityQueue##_Node *LimitedPriorityQueue_poll(LimitedPriorityQueue *queue);\
-void LimitedPriorityQueue##_remove(LimitedPriorityQueue *queue, LimitedPriorityQueue##_Node *x);
+LimitedPriorityQueue##_Node *LimitedPriorityQueue##_poll(LimitedPriorityQueue *queue);\
+void LimitedPriorityQueue##_remove(LimitedPriorityQueue *queue, LimitedPriorityQueue##_Node *x);\
+void LimitedPriorityQueue##_check(const LimitedPriorityQueue *queue);
 
 
 /**
@@ -74,13 +186,7 @@ void LimitedPriorityQueue##_remove(LimitedPriorityQueue *queue, LimitedPriorityQ
  */
 #define LimitedPriorityQueue_implementation(LimitedPriorityQueue, priorityCount, Priority, getPriority) \
 \
-/** Returns the index (between 0 and \a N - 1) of the first bit set, or -1 if none is set. */\
-static int findFirstBitSet(const LimitedPriorityQueue *queue) {\
-    assert(queue->topmap != 0);\
-    int i = __builtin_ctz(queue->topmap);\
-    assert(queue->bitmap[i] != 0);\
-    return i * 32 + __builtin_ctz(queue->bitmap[i]);\
-}\
+LimitedPriorityQueue_bitmapImplementation(LimitedPriorityQueue, priorityCount)\
 \
 void LimitedPriorityQueue##_initialize(LimitedPriorityQueue *queue) {\
     memset(queue, 0, sizeof(LimitedPriorityQueue));\
@@ -102,8 +208,7 @@ void LimitedPriorityQueue##_insertFront(LimitedPriorityQueue *queue, LimitedPrio
     x->next = l->next;\
     l->next->prev = x;\
     l->next = x;\
-    queue->bitmap[key >> 5] |= 1 << (key & 0x1F);\
-    queue->topmap |= 1 << (key >> 5);\
+    LimitedPriorityQueue##_setBit(queue->bitmap, key);\
     if (queue->top == NULL || key <= getPriority(queue->top)) queue->top = x;\
 }\
 \
@@ -119,8 +224,7 @@ void LimitedPriorityQueue##_insert(LimitedPriorityQueue *queue, LimitedPriorityQ
     x->next = l;\
     l->prev->next = x;\
     l->prev = x;\
-    queue->bitmap[key >> 5] |= 1 << (key & 0x1F);\
-    queue->topmap |= 1 << (key >> 5);\
+    LimitedPriorityQueue##_setBit(queue->bitmap, key);\
     if (queue->top == NULL || key < getPriority(queue->top)) queue->top = x;\
 }\
 \
@@ -145,16 +249,276 @@ void LimitedPriorityQueue##_remove(LimitedPriorityQueue *queue, LimitedPriorityQ
     LimitedPriorityQueue##_Node *l = &queue->lists[key];\
     x->next->prev = x->prev;\
     x->prev->next = x->next;\
-    if (l->next == l) {\
-        queue->bitmap[key >> 5] &= ~(1 << (key & 0x1F));\
-        if (queue->bitmap[key >> 5] == 0) queue->topmap &= ~(1 << (key >> 5));\
-    }\
+    if (l->next == l) LimitedPriorityQueue##_clearBit(queue->bitmap, key);\
     if (x == queue->top) {\
-        if (queue->topmap != 0) {\
-            int n = findFirstBitSet(queue);\
+        if (!LimitedPriorityQueue##_isEmpty(queue)) {\
+            size_t n = LimitedPriorityQueue##_findFirstBitSet(queue->bitmap);\
             queue->top = queue->lists[n].next;\
         } else {\
             queue->top = NULL;\
         }\
     }\
+}\
+\
+/**\
+ * Checks that each level of the summary bitmaps matches the level below,\
+ * down to the lists, and that the cached top is the first element.\
+ */\
+void LimitedPriorityQueue##_check(const LimitedPriorityQueue *queue) {\
+    for (size_t i = 0; i < priorityCount; i++) {\
+        const LimitedPriorityQueue##_Node *l = &queue->lists[i];\
+        assert(LimitedPriorityQueue##_isBitSet(queue->bitmap, i) == (l->next != l));\
+        for (const LimitedPriorityQueue##_Node *x = l->next; x != l; x = x->next) {\
+            assert(x->next->prev == x);\
+            assert((size_t) getPriority((LimitedPriorityQueue##_Node *) x) == i);\
+        }\
+    }\
+    LimitedPriorityQueue##_checkBitmap(queue->bitmap);\
+    if (LimitedPriorityQueue##_isEmpty(queue)) {\
+        assert(queue->top == NULL);\
+    } else {\
+        assert(queue->top == queue->lists[LimitedPriorityQueue##_findFirstBitSet(queue->bitmap)].next);\
+    }\
+}
+
+
+/**
+ * Instantiates the header for a limited priority queue with sparse storage.
+ * @param SparseLimitedPriorityQueue name of the container to instantiate.
+ * @param priorityCount one past the highest allowed value for priorities.
+ */
+#define SparseLimitedPriorityQueue_header(SparseLimitedPriorityQueue, priorityCount) \
+\
+typedef struct SparseLimitedPriorityQueue##_Node SparseLimitedPriorityQueue##_Node;\
+\
+struct SparseLimitedPriorityQueue##_Node {\
+    SparseLimitedPriorityQueue##_Node *prev;\
+    SparseLimitedPriorityQueue##_Node *next;\
+};\
+\
+LimitedPriorityQueue_bitmapHeader(SparseLimitedPriorityQueue, priorityCount)\
+\
+typedef struct SparseLimitedPriorityQueue {\
+    SparseLimitedPriorityQueue##_Node *top;\
+    SparseLimitedPriorityQueue##_Node **heads; /* hash table of the first element of each non-empty list */\
+    size_t mask; /* capacity of the hash table minus 1 */\
+    size_t headCount; /* count of non-empty lists */\
+    uint64_t bitmap[SparseLimitedPriorityQueue##_bitmapWords];\
+} SparseLimitedPriorityQueue;\
+\
+static inline bool SparseLimitedPriorityQueue##_isEmpty(const SparseLimitedPriorityQueue *queue) { return queue->headCount == 0; }\
+static inline SparseLimitedPriorityQueue##_Node* SparseLimitedPriorityQueue##_peek(const SparseLimitedPriorityQueue *queue) { return queue->top; }\
+/** Returns the count of distinct priorities in the queue, that is of entries used in the hash table. */\
+static inline size_t SparseLimitedPriorityQueue##_getHeadCount(const SparseLimitedPriorityQueue *queue) { return queue->headCount; }\
+static inline size_t SparseLimitedPriorityQueue##_getCapacity(const SparseLimitedPriorityQueue *queue) { return queue->mask + 1; }\
+void SparseLimitedPriorityQueue##_initialize(SparseLimitedPriorityQueue *queue, SparseLimitedPriorityQueue##_Node **heads, size_t capacity);\
+void SparseLimitedPriorityQueue##_rehash(SparseLimitedPriorityQueue *queue, SparseLimitedPriorityQueue##_Node **heads, size_t capacity);\
+void SparseLimitedPriorityQueue##_insertFront(SparseLimitedPriorityQueue *queue, SparseLimitedPriorityQueue##_Node *x);\
+void SparseLimitedPriorityQueue##_insert(SparseLimitedPriorityQueue *queue, SparseLimitedPriorityQueue##_Node *x);\
+SparseLimitedPriorityQueue##_Node *SparseLimitedPriorityQueue##_poll(SparseLimitedPriorityQueue *queue);\
+void SparseLimitedPriorityQueue##_remove(SparseLimitedPriorityQueue *queue, SparseLimitedPriorityQueue##_Node *x);\
+void SparseLimitedPriorityQueue##_check(const SparseLimitedPriorityQueue *queue);
+
+
+/**
+ * Instantiates the implementation for a limited priority queue with sparse storage.
+ * @param SparseLimitedPriorityQueue name of the container to instantiate.
+ * @param priorityCount one past the highest allowed value for priorities.
+ * @param Priority unsigned integral type for priorities.
+ * @param getPriority function taking a pointer to a node and returning its priority.
+ */
+#define SparseLimitedPriorityQueue_implementation(SparseLimitedPriorityQueue, priorityCount, Priority, getPriority) \
+\
+LimitedPriorityQueue_bitmapImplementation(SparseLimitedPriorityQueue, priorityCount)\
+\
+/** Returns the preferred hash table index for the specified priority, using Fibonacci hashing. */\
+static inline size_t SparseLimitedPriorityQueue##_hash(const SparseLimitedPriorityQueue *queue, size_t key) {\
+    return (size_t) (((uint64_t) key * UINT64_C(0x9E3779B97F4A7C15)) >> 32) & queue->mask;\
+}\
+\
+/** Returns the hash table index holding the list for the specified priority, or the empty entry where it would go. */\
+static inline size_t SparseLimitedPriorityQueue##_findHead(const SparseLimitedPriorityQueue *queue, size_t key) {\
+    size_t i = SparseLimitedPriorityQueue##_hash(queue, key);\
+    while (queue->heads[i] != NULL && (size_t) getPriority(queue->heads[i]) != key) {\
+        i = (i + 1) & queue->mask;\
+    }\
+    return i;\
+}\
+\
+/**\
+ * Removes the entry at the specified index of the hash table, moving back\
+ * the following entries of its cluster that would not be found anymore.\
+ */\
+static void SparseLimitedPriorityQueue##_removeHead(SparseLimitedPriorityQueue *queue, size_t i) {\
+    size_t j = i;\
+    while (true) {\
+        j = (j + 1) & queue->mask;\
+        if (queue->heads[j] == NULL) break;\
+        size_t k = SparseLimitedPriorityQueue##_hash(queue, getPriority(queue->heads[j]));\
+        /* Move entry j to the hole at i unless its preferred index k lies cyclically in (i, j] */\
+        if (((j - k) & queue->mask) >= ((j - i) & queue->mask)) {\
+            queue->heads[i] = queue->heads[j];\
+            i = j;\
+        }\
+    }\
+    queue->heads[i] = NULL;\
+}\
+\
+/**\
+ * Initializes an empty queue using the specified hash table for the first\
+ * element of each list. The capacity must be a power of two greater than the\
+ * count of distinct priorities in the queue at any time, and keeping it at\
+ * least twice that count keeps probes short.\
+ */\
+void SparseLimitedPriorityQueue##_initialize(SparseLimitedPriorityQueue *queue, SparseLimitedPriorityQueue##_Node **heads, size_t capacity) {\
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);\
+    memset(queue, 0, sizeof(SparseLimitedPriorityQueue));\
+    memset(heads, 0, capacity * sizeof(SparseLimitedPriorityQueue##_Node *));\
+    queue->heads = heads;\
+    queue->mask = capacity - 1;\
+}\
+\
+/**\
+ * Moves the hash table to the specified one, such as to grow it when the\
+ * queue holds more distinct priorities. The old hash table can be disposed\
+ * of afterwards. The capacity must be a power of two greater than the count\
+ * of distinct priorities in the queue.\
+ */\
+void SparseLimitedPriorityQueue##_rehash(SparseLimitedPriorityQueue *queue, SparseLimitedPriorityQueue##_Node **heads, size_t capacity) {\
+    assert(capacity > queue->headCount && (capacity & (capacity - 1)) == 0);\
+    SparseLimitedPriorityQueue##_Node **oldHeads = queue->heads;\
+    size_t oldCapacity = queue->mask + 1;\
+    memset(heads, 0, capacity * sizeof(SparseLimitedPriorityQueue##_Node *));\
+    queue->heads = heads;\
+    queue->mask = capacity - 1;\
+    for (size_t i = 0; i < oldCapacity; i++) {\
+        if (oldHeads[i] != NULL) {\
+            queue->heads[SparseLimitedPriorityQueue##_findHead(queue, getPriority(oldHeads[i]))] = oldHeads[i];\
+        }\
+    }\
+}\
+\
+/**\
+ * Inserts an element as the first come element given its priority.\
+ * The element must not be already in the queue.\
+ */\
+void SparseLimitedPriorityQueue##_insertFront(SparseLimitedPriorityQueue *queue, SparseLimitedPriorityQueue##_Node *x) {\
+    Priority key = getPriority(x);\
+    assert(key < priorityCount);\
+    size_t i = SparseLimitedPriorityQueue##_findHead(queue, key);\
+    SparseLimitedPriorityQueue##_Node *h = queue->heads[i];\
+    if (h == NULL) {\
+        assert(queue->headCount < queue->mask);\
+        x->prev = x;\
+        x->next = x;\
+        queue->headCount++;\
+        SparseLimitedPriorityQueue##_setBit(queue->bitmap, key);\
+    } else {\
+        x->prev = h->prev;\
+        x->next = h;\
+        h->prev->next = x;\
+        h->prev = x;\
+    }\
+    queue->heads[i] = x;\
+    if (queue->top == NULL || key <= getPriority(queue->top)) queue->top = x;\
+}\
+\
+/**\
+ * Inserts an element as the last come element given its priority.\
+ * The element must not be already in the queue.\
+ */\
+void SparseLimitedPriorityQueue##_insert(SparseLimitedPriorityQueue *queue, SparseLimitedPriorityQueue##_Node *x) {\
+    Priority key = getPriority(x);\
+    assert(key < priorityCount);\
+    size_t i = SparseLimitedPriorityQueue##_findHead(queue, key);\
+    SparseLimitedPriorityQueue##_Node *h = queue->heads[i];\
+    if (h == NULL) {\
+        assert(queue->headCount < queue->mask);\
+        x->prev = x;\
+        x->next = x;\
+        queue->heads[i] = x;\
+        queue->headCount++;\
+        SparseLimitedPriorityQueue##_setBit(queue->bitmap, key);\
+    } else {\
+        x->prev = h->prev;\
+        x->next = h;\
+        h->prev->next = x;\
+        h->prev = x;\
+    }\
+    if (queue->top == NULL || key < getPriority(queue->top)) queue->top = x;\
+}\
+\
+/**\
+ * Removes the highest priority, first come element from the queue.\
+ * Call only if not empty.\
+ */\
+SparseLimitedPriorityQueue##_Node *SparseLimitedPriorityQueue##_poll(SparseLimitedPriorityQueue *queue) {\
+    SparseLimitedPriorityQueue##_Node *top = queue->top;\
+    SparseLimitedPriorityQueue##_remove(queue, top);\
+    return top;\
+}\
+\
+/**\
+ * Removes the specified element from the queue.\
+ * The element must be in the queue.\
+ */\
+void SparseLimitedPriorityQueue##_remove(SparseLimitedPriorityQueue *queue, SparseLimitedPriorityQueue##_Node *x) {\
+    assert(!SparseLimitedPriorityQueue##_isEmpty(queue));\
+    Priority key = getPriority(x);\
+    assert(key < priorityCount);\
+    size_t i = SparseLimitedPriorityQueue##_findHead(queue, key);\
+    assert(queue->heads[i] != NULL);\
+    if (x->next == x) {\
+        SparseLimitedPriorityQueue##_removeHead(queue, i);\
+        queue->headCount--;\
+        SparseLimitedPriorityQueue##_clearBit(queue->bitmap, key);\
+        if (x == queue->top) {\
+            if (!SparseLimitedPriorityQueue##_isEmpty(queue)) {\
+                size_t n = SparseLimitedPriorityQueue##_findFirstBitSet(queue->bitmap);\
+                queue->top = queue->heads[SparseLimitedPriorityQueue##_findHead(queue, n)];\
+            } else {\
+                queue->top = NULL;\
+            }\
+        }\
+    } else {\
+        x->next->prev = x->prev;\
+        x->prev->next = x->next;\
+        if (queue->heads[i] == x) queue->heads[i] = x->next;\
+        if (x == queue->top) queue->top = x->next;\
+    }\
+}\
+\
+/**\
+ * Checks that each level of the summary bitmaps matches the level below,\
+ * down to the hash table and lists, and that the cached top is the first element.\
+ */\
+void SparseLimitedPriorityQueue##_check(const SparseLimitedPriorityQueue *queue) {\
+    size_t headCount = 0;\
+    for (size_t i = 0; i <= queue->mask; i++) {\
+        const SparseLimitedPriorityQueue##_Node *h = queue->heads[i];\
+        if (h == NULL) continue;\
+        headCount++;\
+        assert((size_t) getPriority((SparseLimitedPriorityQueue##_Node *) h) < priorityCount);\
+        assert(SparseLimitedPriorityQueue##_findHead(queue, getPriority((SparseLimitedPriorityQueue##_Node *) h)) == i);\
+        assert(SparseLimitedPriorityQueue##_isBitSet(queue->bitmap, getPriority((SparseLimitedPriorityQueue##_Node *) h)));\
+        const SparseLimitedPriorityQueue##_Node *x = h;\
+        do {\
+            assert(x->next->prev == x);\
+            assert(getPriority((SparseLimitedPriorityQueue##_Node *) x) == getPriority((SparseLimitedPriorityQueue##_Node *) h));\
+            x = x->next;\
+        } while (x != h);\
+    }\
+    assert(headCount == queue->headCount);\
+    size_t bitCount = 0;\
+    for (size_t i = 0; i < SparseLimitedPriorityQueue##_words0; i++) {\
+        bitCount += __builtin_popcountll(queue->bitmap[i]);\
+    }\
+    assert(bitCount == headCount);\
+    SparseLimitedPriorityQueue##_checkBitmap(queue->bitmap);\
+    if (SparseLimitedPriorityQueue##_isEmpty(queue)) {\
+        assert(queue->top == NULL);\
+    } else {\
+        assert(queue->top == queue->heads[SparseLimitedPriorityQueue##_findHead(queue,\
+                SparseLimitedPriorityQueue##_findFirstBitSet(queue->bitmap))]);\
+    }\
 }
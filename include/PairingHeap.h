@@ -0,0 +1,211 @@
+/*
+Intrusive pairing (min) heap container.
+Copyright 2017-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/******************************************************************************
+ * This is a poor man's template file.
+ * In order to use the container, you need to instantiate the poor man's
+ * template macros for header and implementation.
+ *
+ * A pairing heap is a heap-ordered multiway tree, where each node links to
+ * its first child and to its next sibling. Insertion and merge link two
+ * roots with a single comparison, leaving all the work to poll, that merges
+ * the children of the former root with the two-pass pairing method: pairs of
+ * adjacent siblings are linked from left to right, then the resulting heaps
+ * are linked from right to left. Decreasing the key of a node cuts its
+ * subtree away and links it to the root. Unlike LeftistHeap, there is no
+ * rank to keep up to date.
+ ******************************************************************************/
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Instantiates the header for an intrusive pairing heap container.
+ * @param PairingHeap name of the container to instantiate.
+ */
+#define PairingHeap_header(PairingHeap) \
+\
+typedef struct PairingHeap##_Node PairingHeap##_Node;\
+\
+struct PairingHeap##_Node {\
+    PairingHeap##_Node *child; /* first child */\
+    PairingHeap##_Node *next; /* next sibling */\
+    PairingHeap##_Node *prev; /* previous sibling, or parent for the first child */\
+};\
+\
+typedef struct PairingHeap {\
+    PairingHeap##_Node *root;\
+} PairingHeap;\
+\
+static inline void PairingHeap##_initialize(PairingHeap *heap) {\
+    heap->root = NULL;\
+}\
+\
+static inline bool PairingHeap##_isEmpty(const PairingHeap *heap) {\
+    return heap->root == NULL;\
+}\
+\
+static inline PairingHeap##_Node *PairingHeap##_peek(const PairingHeap *heap) {\
+    return heap->root;\
+}\
+\
+void PairingHeap##_insert(PairingHeap *heap, PairingHeap##_Node *node);\
+void PairingHeap##_remove(PairingHeap *heap, PairingHeap##_Node *node);\
+PairingHeap##_Node *PairingHeap##_poll(PairingHeap *heap);\
+void PairingHeap##_decreaseKey(PairingHeap *heap, PairingHeap##_Node *node);\
+void PairingHeap##_merge(PairingHeap *heap, PairingHeap *other);\
+void PairingHeap##_check(const PairingHeap *heap);
+
+
+/**
+ * Instantiates the implementation for an intrusive pairing heap container.
+ * @param PairingHeap name of the container to instantiate.
+ * @param isLess name of the function comparing nodes having the following prototype: bool isLess(PairingHeap##_Node *node, PairingHeap##_Node *other)
+ */
+#define PairingHeap_implementation(PairingHeap, isLess) \
+\
+/**
+ * Links two roots, making the greater one the first child of the lesser one.
+ * Sibling links of the resulting root are left untouched.
+ * @return The resulting root.
+ */\
+static inline PairingHeap##_Node *PairingHeap##_link(PairingHeap##_Node *a, PairingHeap##_Node *b) {\
+    if (isLess(b, a)) {\
+        PairingHeap##_Node *t = a;\
+        a = b;\
+        b = t;\
+    }\
+    b->prev = a;\
+    b->next = a->child;\
+    if (a->child != NULL) a->child->prev = b;\
+    a->child = b;\
+    return a;\
+}\
+\
+/**
+ * Merges a list of siblings into a single heap with the two-pass method.
+ * The first pass links pairs from left to right, pushing the results onto
+ * a stack threaded through their prev links, the second pass pops and links
+ * them, thus from right to left.
+ * @return The new root, or NULL if first is NULL.
+ */\
+static PairingHeap##_Node *PairingHeap##_mergePairs(PairingHeap##_Node *first) {\
+    if (first == NULL) return NULL;\
+    PairingHeap##_Node *stack = NULL;\
+    while (first != NULL) {\
+        PairingHeap##_Node *a = first;\
+        PairingHeap##_Node *b = a->next;\
+        if (b == NULL) {\
+            a->prev = stack;\
+            stack = a;\
+            break;\
+        }\
+        first = b->next;\
+        PairingHeap##_Node *linked = PairingHeap##_link(a, b);\
+        linked->prev = stack;\
+        stack = linked;\
+    }\
+    PairingHeap##_Node *result = stack;\
+    stack = stack->prev;\
+    while (stack != NULL) {\
+        PairingHeap##_Node *n = stack;\
+        stack = n->prev;\
+        result = PairingHeap##_link(n, result);\
+    }\
+    result->prev = NULL;\
+    result->next = NULL;\
+    return result;\
+}\
+\
+/** Detaches the subtree rooted at the specified non-root node from its parent and siblings. */\
+static inline void PairingHeap##_cut(PairingHeap##_Node *node) {\
+    if (node->prev->child == node) node->prev->child = node->next;\
+    else node->prev->next = node->next;\
+    if (node->next != NULL) node->next->prev = node->prev;\
+    node->prev = NULL;\
+    node->next = NULL;\
+}\
+\
+/** Inserts the specified node into the heap. */\
+void PairingHeap##_insert(PairingHeap *heap, PairingHeap##_Node *node) {\
+    node->child = NULL;\
+    node->next = NULL;\
+    node->prev = NULL;\
+    heap->root = (heap->root != NULL) ? PairingHeap##_link(heap->root, node) : node;\
+}\
+\
+/** Removes the node for the minimum element from the heap. */\
+PairingHeap##_Node *PairingHeap##_poll(PairingHeap *heap) {\
+    assert(heap->root != NULL);\
+    PairingHeap##_Node *root = heap->root;\
+    heap->root = PairingHeap##_mergePairs(root->child);\
+    return root;\
+}\
+\
+/** Removes the specified node from the heap. */\
+void PairingHeap##_remove(PairingHeap *heap, PairingHeap##_Node *node) {\
+    if (node == heap->root) {\
+        PairingHeap##_poll(heap);\
+        return;\
+    }\
+    PairingHeap##_cut(node);\
+    PairingHeap##_Node *subtree = PairingHeap##_mergePairs(node->child);\
+    if (subtree != NULL) heap->root = PairingHeap##_link(heap->root, subtree);\
+}\
+\
+/**
+ * Updates the heap structure after the key of the specified node has been
+ * decreased. Keys must not be increased this way: use remove and insert.
+ */\
+void PairingHeap##_decreaseKey(PairingHeap *heap, PairingHeap##_Node *node) {\
+    if (node == heap->root) return;\
+    PairingHeap##_cut(node);\
+    heap->root = PairingHeap##_link(heap->root, node);\
+}\
+\
+/** Moves all nodes of other into heap, leaving other empty. */\
+void PairingHeap##_merge(PairingHeap *heap, PairingHeap *other) {\
+    if (other->root == NULL) return;\
+    heap->root = (heap->root != NULL) ? PairingHeap##_link(heap->root, other->root) : other->root;\
+    other->root = NULL;\
+}\
+\
+static void PairingHeap##_checkNode(const PairingHeap##_Node *node) {\
+    for (const PairingHeap##_Node *c = node->child; c != NULL; c = c->next) {\
+        assert((c == node->child) ? c->prev == node : c->prev->next == c);\
+        assert(!isLess((PairingHeap##_Node *) c, (PairingHeap##_Node *) node));\
+        PairingHeap##_checkNode(c);\
+    }\
+}\
+\
+/** Checks heap invariants. */\
+void PairingHeap##_check(const PairingHeap *heap) {\
+    if (heap->root == NULL) return;\
+    assert(heap->root->prev == NULL);\
+    assert(heap->root->next == NULL);\
+    PairingHeap##_checkNode(heap->root);\
+}
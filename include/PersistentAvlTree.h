@@ -0,0 +1,345 @@
+/*
+Persistent AVL tree container with path copying.
+Copyright 2015-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/******************************************************************************
+ * This is a poor man's template file.
+ * In order to use the container, you need to instantiate the poor man's
+ * template macros for header and implementation.
+ *
+ * This is a variant of AvlTree whose versions can be snapshotted in constant
+ * time. Since a node may belong to many versions, nodes are not embedded
+ * into elements, but drawn from a caller-provided pool, and hold a copy of
+ * the element (that may well be a key and a pointer). Nodes have no parent
+ * link and store their height rather than a balance factor, so that they
+ * can be shared among versions.
+ *
+ * Nodes are reference counted. An update copies the nodes on its path that
+ * are shared with other versions, that is O(log n) nodes, and changes in
+ * place the ones it owns exclusively, so that a tree with no snapshots is
+ * updated without copies. Nodes reachable from a version are never changed
+ * nor freed while that version is alive, thus reading a version needs no
+ * synchronization and never blocks writers.
+ * Reference counts and pools are not thread-safe, though: all functions
+ * other than lookups, including taking and clearing snapshots, must be
+ * serialized for trees sharing a pool, typically being called only by the
+ * writer thread, that hands snapshots to readers and takes them back.
+ ******************************************************************************/
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Instantiates the header for a persistent AVL tree.
+ * @param PersistentAvlTree name of the container to instantiate.
+ * @param Element type of the elements copied into nodes.
+ */
+#define PersistentAvlTree_header(PersistentAvlTree, Element) \
+\
+typedef struct PersistentAvlTree##_Node PersistentAvlTree##_Node;\
+\
+/** Node of the persistent AVL tree, possibly shared among versions. Read-only for users. */\
+struct PersistentAvlTree##_Node {\
+    PersistentAvlTree##_Node *left; /* also links free nodes in the pool */\
+    PersistentAvlTree##_Node *right;\
+    uint32_t refCount;\
+    uint32_t height;\
+    Element element;\
+};\
+\
+/** Pool of free nodes, that may be shared by many trees. */\
+typedef struct PersistentAvlTree##_Pool {\
+    PersistentAvlTree##_Node *free;\
+    size_t freeCount;\
+} PersistentAvlTree##_Pool;\
+\
+/** A version of a persistent AVL tree, either the one being updated or a snapshot. */\
+typedef struct PersistentAvlTree {\
+    PersistentAvlTree##_Pool *pool;\
+    PersistentAvlTree##_Node *root;\
+} PersistentAvlTree;\
+\
+void PersistentAvlTree##_Pool_initialize(PersistentAvlTree##_Pool *pool, PersistentAvlTree##_Node *nodes, size_t count);\
+void PersistentAvlTree##_initialize(PersistentAvlTree *tree, PersistentAvlTree##_Pool *pool);\
+void PersistentAvlTree##_snapshot(const PersistentAvlTree *tree, PersistentAvlTree *snapshot);\
+void PersistentAvlTree##_clear(PersistentAvlTree *tree);\
+bool PersistentAvlTree##_insert(PersistentAvlTree *tree, const Element *element);\
+bool PersistentAvlTree##_remove(PersistentAvlTree *tree, const Element *key);\
+const Element *PersistentAvlTree##_find(const PersistentAvlTree *tree, const Element *key);\
+const Element *PersistentAvlTree##_lowerBound(const PersistentAvlTree *tree, const Element *key);\
+\
+/** Returns true if the version contains no elements. */\
+static inline bool PersistentAvlTree##_isEmpty(const PersistentAvlTree *tree) {\
+    return tree->root == NULL;\
+}
+
+
+/**
+ * Instantiates the implementation for a persistent AVL tree.
+ * The following functions are generated:
+ * - Pool_initialize(pool, nodes, count) adds an array of nodes to the pool;
+ * - initialize(tree, pool) initializes an empty tree drawing nodes from pool;
+ * - snapshot(tree, snapshot) makes snapshot, not holding a version, share
+ *   the current version of tree in constant time; both can then be updated
+ *   independently;
+ * - clear(tree) releases the version held by tree, leaving it empty;
+ * - insert(tree, element) inserts a copy of element after equal ones,
+ *   returning false without changes if the pool may run out of nodes;
+ * - remove(tree, key) removes one element equal to key, returning false
+ *   if not found or if the pool may run out of nodes;
+ * - find(tree, key) returns an element equal to key, or NULL if not found;
+ * - lowerBound(tree, key) returns the first element not less than key,
+ *   or NULL if all elements are less than key.
+ * @param PersistentAvlTree name of the container to instantiate.
+ * @param Element type of the elements copied into nodes.
+ * @param isLess function taking (const Element *a, const Element *b) and
+ *        returning a bool indicating whether a is less than b.
+ */
+#define PersistentAvlTree_implementation(PersistentAvlTree, Element, isLess) \
+\
+static inline uint32_t PersistentAvlTree##_getHeight(const PersistentAvlTree##_Node *node) {\
+    return (node != NULL) ? node->height : 0;\
+}\
+\
+static inline void PersistentAvlTree##_updateHeight(PersistentAvlTree##_Node *node) {\
+    uint32_t leftHeight = PersistentAvlTree##_getHeight(node->left);\
+    uint32_t rightHeight = PersistentAvlTree##_getHeight(node->right);\
+    node->height = ((leftHeight > rightHeight) ? leftHeight : rightHeight) + 1;\
+}\
+\
+static inline void PersistentAvlTree##_retain(PersistentAvlTree##_Node *node) {\
+    if (node != NULL) node->refCount++;\
+}\
+\
+static inline PersistentAvlTree##_Node *PersistentAvlTree##_allocate(PersistentAvlTree##_Pool *pool) {\
+    PersistentAvlTree##_Node *node = pool->free;\
+    assert(node != NULL);\
+    pool->free = node->left;\
+    pool->freeCount--;\
+    node->refCount = 1;\
+    return node;\
+}\
+\
+/** Drops a reference to a node, freeing it and releasing its children when no longer referenced. */\
+static void PersistentAvlTree##_release(PersistentAvlTree##_Pool *pool, PersistentAvlTree##_Node *node) {\
+    while (node != NULL && --node->refCount == 0) {\
+        PersistentAvlTree##_release(pool, node->left);\
+        PersistentAvlTree##_Node *right = node->right;\
+        node->left = pool->free;\
+        pool->free = node;\
+        pool->freeCount++;\
+        node = right;\
+    }\
+}\
+\
+/**
+ * Returns a node exclusively owned by the caller with the same contents of
+ * the specified one: the node itself if not shared, otherwise a copy
+ * sharing its children, dropping the caller's reference to the original.
+ */\
+static PersistentAvlTree##_Node *PersistentAvlTree##_unshare(PersistentAvlTree##_Pool *pool, PersistentAvlTree##_Node *node) {\
+    if (node->refCount == 1) return node;\
+    PersistentAvlTree##_Node *copy = PersistentAvlTree##_allocate(pool);\
+    copy->left = node->left;\
+    copy->right = node->right;\
+    copy->height = node->height;\
+    copy->element = node->element;\
+    PersistentAvlTree##_retain(copy->left);\
+    PersistentAvlTree##_retain(copy->right);\
+    node->refCount--;\
+    return copy;\
+}\
+\
+/** Rotates left an exclusively owned node, unsharing its right child, returning the new subtree root. */\
+static PersistentAvlTree##_Node *PersistentAvlTree##_rotateLeft(PersistentAvlTree##_Pool *pool, PersistentAvlTree##_Node *node) {\
+    PersistentAvlTree##_Node *child = PersistentAvlTree##_unshare(pool, node->right);\
+    node->right = child->left;\
+    child->left = node;\
+    PersistentAvlTree##_updateHeight(node);\
+    PersistentAvlTree##_updateHeight(child);\
+    return child;\
+}\
+\
+/** Rotates right an exclusively owned node, unsharing its left child, returning the new subtree root. */\
+static PersistentAvlTree##_Node *PersistentAvlTree##_rotateRight(PersistentAvlTree##_Pool *pool, PersistentAvlTree##_Node *node) {\
+    PersistentAvlTree##_Node *child = PersistentAvlTree##_unshare(pool, node->left);\
+    node->left = child->right;\
+    child->right = node;\
+    PersistentAvlTree##_updateHeight(node);\
+    PersistentAvlTree##_updateHeight(child);\
+    return child;\
+}\
+\
+/** Restores balance of an exclusively owned node whose subtrees differ in height by at most 2. */\
+static PersistentAvlTree##_Node *PersistentAvlTree##_rebalance(PersistentAvlTree##_Pool *pool, PersistentAvlTree##_Node *node) {\
+    uint32_t leftHeight = PersistentAvlTree##_getHeight(node->left);\
+    uint32_t rightHeight = PersistentAvlTree##_getHeight(node->right);\
+    if (leftHeight > rightHeight + 1) {\
+        const PersistentAvlTree##_Node *left = node->left;\
+        if (PersistentAvlTree##_getHeight(left->left) < PersistentAvlTree##_getHeight(left->right)) {\
+            node->left = PersistentAvlTree##_rotateLeft(pool, PersistentAvlTree##_unshare(pool, node->left));\
+        }\
+        return PersistentAvlTree##_rotateRight(pool, node);\
+    }\
+    if (rightHeight > leftHeight + 1) {\
+        const PersistentAvlTree##_Node *right = node->right;\
+        if (PersistentAvlTree##_getHeight(right->right) < PersistentAvlTree##_getHeight(right->left)) {\
+            node->right = PersistentAvlTree##_rotateRight(pool, PersistentAvlTree##_unshare(pool, node->right));\
+        }\
+        return PersistentAvlTree##_rotateLeft(pool, node);\
+    }\
+    node->height = ((leftHeight > rightHeight) ? leftHeight : rightHeight) + 1;\
+    return node;\
+}\
+\
+/**
+ * Returns whether the pool surely has enough nodes for an update: one for
+ * each node on the path and two more for each rotation, plus a new node.
+ */\
+static inline bool PersistentAvlTree##_hasRoom(const PersistentAvlTree *tree) {\
+    return tree->pool->freeCount >= 3 * (size_t) PersistentAvlTree##_getHeight(tree->root) + 1;\
+}\
+\
+static PersistentAvlTree##_Node *PersistentAvlTree##_insertNode(PersistentAvlTree##_Pool *pool, PersistentAvlTree##_Node *node, const Element *element) {\
+    if (node == NULL) {\
+        node = PersistentAvlTree##_allocate(pool);\
+        node->left = NULL;\
+        node->right = NULL;\
+        node->height = 1;\
+        node->element = *element;\
+        return node;\
+    }\
+    node = PersistentAvlTree##_unshare(pool, node);\
+    if (isLess(element, &node->element)) {\
+        node->left = PersistentAvlTree##_insertNode(pool, node->left, element);\
+    } else {\
+        node->right = PersistentAvlTree##_insertNode(pool, node->right, element);\
+    }\
+    return PersistentAvlTree##_rebalance(pool, node);\
+}\
+\
+/** Detaches the leftmost node of a subtree moving its element to *element, returning the new subtree root. */\
+static PersistentAvlTree##_Node *PersistentAvlTree##_removeMin(PersistentAvlTree##_Pool *pool, PersistentAvlTree##_Node *node, Element *element) {\
+    if (node->left == NULL) {\
+        PersistentAvlTree##_Node *right = node->right;\
+        *element = node->element;\
+        PersistentAvlTree##_retain(right);\
+        PersistentAvlTree##_release(pool, node);\
+        return right;\
+    }\
+    node = PersistentAvlTree##_unshare(pool, node);\
+    node->left = PersistentAvlTree##_removeMin(pool, node->left, element);\
+    return PersistentAvlTree##_rebalance(pool, node);\
+}\
+\
+/**
+ * Removes a node equal to key, that must be in the subtree, returning the new
+ * subtree root. The removed node is not copied, just released, if shared.
+ */\
+static PersistentAvlTree##_Node *PersistentAvlTree##_removeNode(PersistentAvlTree##_Pool *pool, PersistentAvlTree##_Node *node, const Element *key) {\
+    if (isLess(key, &node->element)) {\
+        node = PersistentAvlTree##_unshare(pool, node);\
+        node->left = PersistentAvlTree##_removeNode(pool, node->left, key);\
+    } else if (isLess(&node->element, key)) {\
+        node = PersistentAvlTree##_unshare(pool, node);\
+        node->right = PersistentAvlTree##_removeNode(pool, node->right, key);\
+    } else if (node->left == NULL || node->right == NULL) {\
+        PersistentAvlTree##_Node *child = (node->left != NULL) ? node->left : node->right;\
+        PersistentAvlTree##_retain(child);\
+        PersistentAvlTree##_release(pool, node);\
+        return child;\
+    } else {\
+        node = PersistentAvlTree##_unshare(pool, node);\
+        node->right = PersistentAvlTree##_removeMin(pool, node->right, &node->element);\
+    }\
+    return PersistentAvlTree##_rebalance(pool, node);\
+}\
+\
+void PersistentAvlTree##_Pool_initialize(PersistentAvlTree##_Pool *pool, PersistentAvlTree##_Node *nodes, size_t count) {\
+    pool->free = NULL;\
+    pool->freeCount = 0;\
+    for (size_t i = count; i > 0; i--) {\
+        nodes[i - 1].left = pool->free;\
+        pool->free = &nodes[i - 1];\
+    }\
+    pool->freeCount = count;\
+}\
+\
+void PersistentAvlTree##_initialize(PersistentAvlTree *tree, PersistentAvlTree##_Pool *pool) {\
+    tree->pool = pool;\
+    tree->root = NULL;\
+}\
+\
+void PersistentAvlTree##_snapshot(const PersistentAvlTree *tree, PersistentAvlTree *snapshot) {\
+    PersistentAvlTree##_retain(tree->root);\
+    snapshot->pool = tree->pool;\
+    snapshot->root = tree->root;\
+}\
+\
+void PersistentAvlTree##_clear(PersistentAvlTree *tree) {\
+    PersistentAvlTree##_release(tree->pool, tree->root);\
+    tree->root = NULL;\
+}\
+\
+bool PersistentAvlTree##_insert(PersistentAvlTree *tree, const Element *element) {\
+    if (!PersistentAvlTree##_hasRoom(tree)) return false;\
+    tree->root = PersistentAvlTree##_insertNode(tree->pool, tree->root, element);\
+    return true;\
+}\
+\
+bool PersistentAvlTree##_remove(PersistentAvlTree *tree, const Element *key) {\
+    if (PersistentAvlTree##_find(tree, key) == NULL || !PersistentAvlTree##_hasRoom(tree)) return false;\
+    tree->root = PersistentAvlTree##_removeNode(tree->pool, tree->root, key);\
+    return true;\
+}\
+\
+const Element *PersistentAvlTree##_find(const PersistentAvlTree *tree, const Element *key) {\
+    const PersistentAvlTree##_Node *node = tree->root;\
+    while (node != NULL) {\
+        if (isLess(key, &node->element)) {\
+            node = node->left;\
+        } else if (isLess(&node->element, key)) {\
+            node = node->right;\
+        } else {\
+            return &node->element;\
+        }\
+    }\
+    return NULL;\
+}\
+\
+const Element *PersistentAvlTree##_lowerBound(const PersistentAvlTree *tree, const Element *key) {\
+    const Element *found = NULL;\
+    const PersistentAvlTree##_Node *node = tree->root;\
+    while (node != NULL) {\
+        if (isLess(&node->element, key)) {\
+            node = node->right;\
+        } else {\
+            found = &node->element;\
+            node = node->left;\
+        }\
+    }\
+    return found;\
+}
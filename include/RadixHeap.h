@@ -0,0 +1,208 @@
+/*
+Intrusive monotone radix heap container.
+Copyright 2017-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/******************************************************************************
+ * This is a poor man's template file.
+ * In order to use the container, you need to instantiate the poor man's
+ * template macros for header and implementation.
+ *
+ * A radix heap is a priority queue for unsigned integer keys, where keys of
+ * removed elements never decrease, such as in timer queues and in Dijkstra's
+ * shortest path algorithm. Keys inserted must not be less than the key of
+ * the last removed element, "last". Elements are kept in a doubly linked list
+ * for each bucket, where bucket 0 holds keys equal to last and bucket i holds
+ * keys whose most significant bit differing from last is bit i - 1.
+ * A bitmap tells non-empty buckets apart. When bucket 0 is empty, polling
+ * finds the minimum in the first non-empty bucket, makes it the new last,
+ * then moves the elements of that bucket to lower buckets. Each element can
+ * move down at most once per bit of the key, thus insertion and removal take
+ * amortized O(log C) time, where C is the range of keys, comparing keys only
+ * to find the minimum of a bucket.
+ ******************************************************************************/
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Instantiates the header for an intrusive monotone radix heap.
+ * @param RadixHeap name of the container to instantiate.
+ * @param Key unsigned integral type for keys, up to 64 bits.
+ */
+#define RadixHeap_header(RadixHeap, Key) \
+\
+typedef struct RadixHeap##_Node RadixHeap##_Node;\
+\
+struct RadixHeap##_Node {\
+    RadixHeap##_Node *prev;\
+    RadixHeap##_Node *next;\
+};\
+\
+enum { RadixHeap##_bucketCount = sizeof(Key) * 8 + 1 };\
+\
+typedef struct RadixHeap {\
+    RadixHeap##_Node buckets[RadixHeap##_bucketCount];\
+    uint64_t bitmap[(RadixHeap##_bucketCount + 63) / 64];\
+    Key last;\
+} RadixHeap;\
+\
+static inline bool RadixHeap##_isEmpty(const RadixHeap *heap) {\
+    for (size_t i = 0; i < sizeof(heap->bitmap) / sizeof(heap->bitmap[0]); i++) {\
+        if (heap->bitmap[i] != 0) return false;\
+    }\
+    return true;\
+}\
+\
+/** Returns the key of the last removed element, that is the least key that can be inserted. */\
+static inline Key RadixHeap##_getLast(const RadixHeap *heap) {\
+    return heap->last;\
+}\
+\
+void RadixHeap##_initialize(RadixHeap *heap);\
+void RadixHeap##_insert(RadixHeap *heap, RadixHeap##_Node *x);\
+RadixHeap##_Node *RadixHeap##_peek(RadixHeap *heap);\
+RadixHeap##_Node *RadixHeap##_poll(RadixHeap *heap);\
+void RadixHeap##_remove(RadixHeap *heap, RadixHeap##_Node *x);\
+void RadixHeap##_check(const RadixHeap *heap);
+
+
+/**
+ * Instantiates the implementation for an intrusive monotone radix heap.
+ * @param RadixHeap name of the container to instantiate.
+ * @param Key unsigned integral type for keys, up to 64 bits.
+ * @param getKey function taking a pointer to a node and returning its key.
+ */
+#define RadixHeap_implementation(RadixHeap, Key, getKey) \
+\
+/** Returns the bucket for the specified key, that must not be less than last. */\
+static inline size_t RadixHeap##_getBucket(Key last, Key key) {\
+    if (key == last) return 0;\
+    return 64 - __builtin_clzll((uint64_t) (key ^ last));\
+}\
+\
+/** Returns the index of the first non-empty bucket. Call only if not empty. */\
+static inline size_t RadixHeap##_findFirstBucket(const RadixHeap *heap) {\
+    size_t i = 0;\
+    while (heap->bitmap[i] == 0) i++;\
+    return i * 64 + __builtin_ctzll(heap->bitmap[i]);\
+}\
+\
+static inline void RadixHeap##_append(RadixHeap *heap, size_t bucket, RadixHeap##_Node *x) {\
+    RadixHeap##_Node *l = &heap->buckets[bucket];\
+    x->prev = l->prev;\
+    x->next = l;\
+    l->prev->next = x;\
+    l->prev = x;\
+    heap->bitmap[bucket >> 6] |= UINT64_C(1) << (bucket & 0x3F);\
+}\
+\
+void RadixHeap##_initialize(RadixHeap *heap) {\
+    for (size_t i = 0; i < RadixHeap##_bucketCount; i++) {\
+        heap->buckets[i].next = &heap->buckets[i];\
+        heap->buckets[i].prev = &heap->buckets[i];\
+    }\
+    for (size_t i = 0; i < sizeof(heap->bitmap) / sizeof(heap->bitmap[0]); i++) {\
+        heap->bitmap[i] = 0;\
+    }\
+    heap->last = 0;\
+}\
+\
+/**
+ * Inserts an element after elements with the same key.
+ * Its key must not be less than the key of the last removed element.
+ */\
+void RadixHeap##_insert(RadixHeap *heap, RadixHeap##_Node *x) {\
+    Key key = getKey(x);\
+    assert(key >= heap->last);\
+    RadixHeap##_append(heap, RadixHeap##_getBucket(heap->last, key), x);\
+}\
+\
+/**
+ * Returns the element with the minimum key, the first come among equal keys,
+ * without removing it. This may move elements among buckets, making the
+ * minimum key the new last, thus keys less than it cannot be inserted anymore.
+ * Call only if not empty.
+ */\
+RadixHeap##_Node *RadixHeap##_peek(RadixHeap *heap) {\
+    assert(!RadixHeap##_isEmpty(heap));\
+    if ((heap->bitmap[0] & 1) == 0) {\
+        size_t bucket = RadixHeap##_findFirstBucket(heap);\
+        RadixHeap##_Node *l = &heap->buckets[bucket];\
+        Key min = getKey(l->next);\
+        for (RadixHeap##_Node *x = l->next->next; x != l; x = x->next) {\
+            Key key = getKey(x);\
+            if (key < min) min = key;\
+        }\
+        heap->last = min;\
+        RadixHeap##_Node *x = l->next;\
+        l->next = l;\
+        l->prev = l;\
+        heap->bitmap[bucket >> 6] &= ~(UINT64_C(1) << (bucket & 0x3F));\
+        while (x != l) {\
+            RadixHeap##_Node *next = x->next;\
+            size_t newBucket = RadixHeap##_getBucket(min, getKey(x));\
+            assert(newBucket < bucket);\
+            RadixHeap##_append(heap, newBucket, x);\
+            x = next;\
+        }\
+    }\
+    return heap->buckets[0].next;\
+}\
+\
+/**
+ * Removes the element with the minimum key, the first come among equal keys.
+ * Call only if not empty.
+ */\
+RadixHeap##_Node *RadixHeap##_poll(RadixHeap *heap) {\
+    RadixHeap##_Node *top = RadixHeap##_peek(heap);\
+    RadixHeap##_remove(heap, top);\
+    return top;\
+}\
+\
+/** Removes the specified element from the heap. */\
+void RadixHeap##_remove(RadixHeap *heap, RadixHeap##_Node *x) {\
+    assert(!RadixHeap##_isEmpty(heap));\
+    x->next->prev = x->prev;\
+    x->prev->next = x->next;\
+    if (x->prev == x->next) {\
+        /* The element was alone, thus both links point to the sentinel of its bucket */\
+        size_t bucket = x->prev - heap->buckets;\
+        heap->bitmap[bucket >> 6] &= ~(UINT64_C(1) << (bucket & 0x3F));\
+    }\
+}\
+\
+/** Checks that each element is in the bucket for its key and that the bitmap matches buckets. */\
+void RadixHeap##_check(const RadixHeap *heap) {\
+    for (size_t i = 0; i < RadixHeap##_bucketCount; i++) {\
+        const RadixHeap##_Node *l = &heap->buckets[i];\
+        assert(((heap->bitmap[i >> 6] & (UINT64_C(1) << (i & 0x3F))) != 0) == (l->next != l));\
+        for (const RadixHeap##_Node *x = l->next; x != l; x = x->next) {\
+            assert(x->next->prev == x);\
+            assert(getKey((RadixHeap##_Node *) x) >= heap->last);\
+            assert(RadixHeap##_getBucket(heap->last, getKey((RadixHeap##_Node *) x)) == i);\
+        }\
+    }\
+}
@@ -62,6 +62,22 @@ struct RedBlackTree_Node {
     RedBlackTree_Node *right;
 };
 
+/**
+ * Counters of the work done by a red-black tree to insert and remove nodes,
+ * to compare it against AvlTree on a given workload (see AvlTree_Stats).
+ * Kept only if REDBLACKTREE_STATS is defined, otherwise they cost nothing.
+ * Define it when compiling both RedBlackTree.c and the code instantiating
+ * the templates, as it changes the layout of RedBlackTree.
+ */
+typedef struct RedBlackTree_Stats {
+    uint64_t insertions;
+    uint64_t removals;
+    uint64_t descentSteps; // nodes visited looking for the insertion point
+    uint64_t rotations;
+    uint64_t insertRebalanceSteps; // iterations of the fix up after insertion
+    uint64_t removeRebalanceSteps; // iterations of the fix up after removal
+} RedBlackTree_Stats;
+
 /**
  * Red-black tree caching the leftmost and rightmost nodes.
  *
@@ -78,13 +94,26 @@ typedef struct RedBlackTree {
     RedBlackTree_Node *root;
     RedBlackTree_Node *leftmost;
     RedBlackTree_Node *rightmost;
+    #ifdef REDBLACKTREE_STATS
+    RedBlackTree_Stats stats;
+    #endif
 } RedBlackTree;
 
+/** Internal macro adding to a counter of a tree. Expands to nothing unless REDBLACKTREE_STATS is defined. */
+#ifdef REDBLACKTREE_STATS
+#define RedBlackTree_countStat(tree, counter, amount) ((tree)->stats.counter += (amount))
+#else
+#define RedBlackTree_countStat(tree, counter, amount) ((void) 0)
+#endif
+
 /** Initializes an empty red-black tree. */
 static inline void RedBlackTree_initialize(RedBlackTree *tree) {
     tree->root = NULL;
     tree->leftmost = NULL;
     tree->rightmost = NULL;
+    #ifdef REDBLACKTREE_STATS
+    tree->stats = (RedBlackTree_Stats) { 0 };
+    #endif
 }
 
 /** Returns true if the red-black tree contains no elements. */
@@ -98,18 +127,342 @@ void RedBlackTree_remove(RedBlackTree *tree, RedBlackTree_Node *node);
 /** Internal function called after insertion of a node into a red-black tree. */
 void RedBlackTree_postInsert(RedBlackTree *tree, RedBlackTree_Node *node);
 
+/**
+ * Links the specified nodes into a perfectly balanced red-black tree in linear
+ * time, coloring red the nodes on the deepest level.
+ * The tree must be empty, and nodes must be already sorted in ascending order.
+ * To build from unsorted nodes, see the RedBlackTree_instantiateBuild macro.
+ */
+void RedBlackTree_buildFromSorted(RedBlackTree *tree, RedBlackTree_Node **nodes, size_t count);
+
+/**
+ * Joins two red-black trees using the specified node, not already in a tree,
+ * as glue. All nodes in tree must be less than pivot, and pivot must be less
+ * than or equal to all nodes in other. The result is left in tree, and other
+ * is left empty. The cost is proportional to the difference of black heights,
+ * plus computing them, thus logarithmic. Not for augmented trees.
+ */
+void RedBlackTree_join(RedBlackTree *tree, RedBlackTree_Node *pivot, RedBlackTree *other);
+
+/**
+ * Splits a red-black tree moving the specified node and all the nodes
+ * following it to other, which must be empty, in logarithmic time.
+ * To split by key, see the RedBlackTree_instantiateSplit macro.
+ * Not for augmented trees.
+ */
+void RedBlackTree_split(RedBlackTree *tree, RedBlackTree_Node *node, RedBlackTree *other);
+
 /** Internal node colors. */
 typedef enum RedBlackTree_Color {
     RedBlackTree_red = 0,
     RedBlackTree_black = 1
 } RedBlackTree_Color;
 
+static inline RedBlackTree_Node *RedBlackTree_getParent(const RedBlackTree_Node *node) {
+    return (RedBlackTree_Node *) (node->parent & ~1);
+}
+
 /** Internal function to set the parent of a node without changing its color. */
 static inline void RedBlackTree_setParent(RedBlackTree_Node *node, RedBlackTree_Node *parent) {
     assert(((uintptr_t) parent & 1) == 0);
     node->parent = (node->parent & 1) | (uintptr_t) parent;
 }
 
+static inline bool RedBlackTree_isBlack(const RedBlackTree_Node *node) {
+    assert(RedBlackTree_black == 1);
+    return node->parent & 1;
+}
+
+static inline bool RedBlackTree_isRed(const RedBlackTree_Node *node) {
+    assert(RedBlackTree_red == 0);
+    return !RedBlackTree_isBlack(node);
+}
+
+static inline void RedBlackTree_setBlack(RedBlackTree_Node *node) {
+    node->parent |= 1;
+}
+
+static inline void RedBlackTree_setRed(RedBlackTree_Node *node) {
+    node->parent &= ~1;
+}
+
+static inline void RedBlackTree_setColor(RedBlackTree_Node *node, RedBlackTree_Color color) {
+    node->parent = (node->parent & ~1) | color;
+}
+
+/**
+ * Internal function prefetching both children of a node, one of which is
+ * going to be visited next while descending the tree, to overlap cache
+ * misses with the comparison. Enabled only if REDBLACKTREE_PREFETCH is
+ * defined, as it helps only on trees not fitting the caches. Define it when
+ * compiling the code instantiating the templates.
+ */
+static inline void RedBlackTree_prefetchChildren(const RedBlackTree_Node *node) {
+    #ifdef REDBLACKTREE_PREFETCH
+    __builtin_prefetch(node->left);
+    __builtin_prefetch(node->right);
+    #endif
+}
+
+/** Internal function returning the leftmost node of a non-empty subtree. */
+static inline RedBlackTree_Node *RedBlackTree_findMin(RedBlackTree_Node *root) {
+    while (root->left != NULL) root = root->left;
+    return root;
+}
+
+/** Internal function returning the rightmost node of a non-empty subtree. */
+static inline RedBlackTree_Node *RedBlackTree_findMax(RedBlackTree_Node *root) {
+    while (root->right != NULL) root = root->right;
+    return root;
+}
+
+/**
+ * Returns the node following the specified one in key order,
+ * or NULL if node is the rightmost one.
+ * Visiting all nodes this way takes constant amortized time per node.
+ */
+static inline RedBlackTree_Node *RedBlackTree_next(const RedBlackTree_Node *node) {
+    if (node->right != NULL) return RedBlackTree_findMin(node->right);
+    RedBlackTree_Node *parent = RedBlackTree_getParent(node);
+    while (parent != NULL && node == parent->right) {
+        node = parent;
+        parent = RedBlackTree_getParent(node);
+    }
+    return parent;
+}
+
+/**
+ * Returns the node preceding the specified one in key order,
+ * or NULL if node is the leftmost one.
+ * Visiting all nodes this way takes constant amortized time per node.
+ */
+static inline RedBlackTree_Node *RedBlackTree_prev(const RedBlackTree_Node *node) {
+    if (node->left != NULL) return RedBlackTree_findMax(node->left);
+    RedBlackTree_Node *parent = RedBlackTree_getParent(node);
+    while (parent != NULL && node == parent->left) {
+        node = parent;
+        parent = RedBlackTree_getParent(node);
+    }
+    return parent;
+}
+
+/**
+ * Internal poor man's template expanding the rebalancing code of red-black trees.
+ * The update function, taking (RedBlackTree_Node *node), is called on nodes
+ * moved by rotations, children first, to recompute per-subtree data of
+ * augmented trees. The plain tree passes a no-op, that the compiler optimizes away.
+ * Expands the following static functions:
+ * - prefix##_rebalanceAfterInsertion(tree, node) restores colors and balance
+ *   after node has been linked as a leaf;
+ * - prefix##_unlink(tree, node) removes a node and restores balance,
+ *   returning the lowest node whose subtree lost a node (or NULL);
+ * - prefix##_updatePath(node) calls update from node up to the root.
+ * @param prefix prefix for names of the generated functions.
+ * @param update name of the function updating per-subtree data of a node.
+ */
+#define RedBlackTree_instantiateBalancing(prefix, update)\
+static void prefix##_rotateLeft(RedBlackTree *tree, RedBlackTree_Node *parent) {\
+    RedBlackTree_countStat(tree, rotations, 1);\
+    RedBlackTree_Node *child = parent->right;\
+    RedBlackTree_setParent(child, RedBlackTree_getParent(parent));\
+    parent->right = child->left;\
+    child->left = parent;\
+    RedBlackTree_setParent(parent, child);\
+    if (parent->right != NULL) RedBlackTree_setParent(parent->right, parent);\
+    if (parent == tree->root) tree->root = child;\
+    else if (RedBlackTree_getParent(child)->right == parent) RedBlackTree_getParent(child)->right = child;\
+    else RedBlackTree_getParent(child)->left = child;\
+    update(parent);\
+    update(child);\
+}\
+\
+static void prefix##_rotateRight(RedBlackTree *tree, RedBlackTree_Node *parent) {\
+    RedBlackTree_countStat(tree, rotations, 1);\
+    RedBlackTree_Node *child = parent->left;\
+    RedBlackTree_setParent(child, RedBlackTree_getParent(parent));\
+    parent->left = child->right;\
+    child->right = parent;\
+    RedBlackTree_setParent(parent, child);\
+    if (parent->left != NULL) RedBlackTree_setParent(parent->left, parent);\
+    if (parent == tree->root) tree->root = child;\
+    else if (RedBlackTree_getParent(child)->left == parent) RedBlackTree_getParent(child)->left = child;\
+    else RedBlackTree_getParent(child)->right = child;\
+    update(parent);\
+    update(child);\
+}\
+\
+static void prefix##_rebalanceAfterInsertion(RedBlackTree *tree, RedBlackTree_Node *node) {\
+    RedBlackTree_setRed(node);\
+    while (true) {\
+        RedBlackTree_countStat(tree, insertRebalanceSteps, 1);\
+        RedBlackTree_Node *parent = RedBlackTree_getParent(node);\
+        if (node == tree->root || RedBlackTree_isBlack(parent)) {\
+            break;\
+        }\
+        RedBlackTree_Node *grandParent = RedBlackTree_getParent(parent);\
+        assert(grandParent != NULL);\
+        if (parent == grandParent->left) {\
+            RedBlackTree_Node *uncle = grandParent->right;\
+            if (uncle != NULL && RedBlackTree_isRed(uncle)) {\
+                RedBlackTree_setBlack(parent);\
+                RedBlackTree_setBlack(uncle);\
+                RedBlackTree_setRed(grandParent);\
+                node = grandParent;\
+            } else {\
+                if (node == parent->right) {\
+                    node = parent;\
+                    prefix##_rotateLeft(tree, node);\
+                    parent = RedBlackTree_getParent(node);\
+                    grandParent = RedBlackTree_getParent(parent);\
+                }\
+                RedBlackTree_setBlack(parent);\
+                RedBlackTree_setRed(grandParent);\
+                prefix##_rotateRight(tree, grandParent);\
+            }\
+        } else {\
+            RedBlackTree_Node *uncle = grandParent->left;\
+            if (uncle != NULL && RedBlackTree_isRed(uncle)) {\
+                RedBlackTree_setBlack(parent);\
+                RedBlackTree_setBlack(uncle);\
+                RedBlackTree_setRed(grandParent);\
+                node = grandParent;\
+            } else {\
+                if (node == parent->left) {\
+                    node = parent;\
+                    prefix##_rotateRight(tree, node);\
+                    parent = RedBlackTree_getParent(node);\
+                    grandParent = RedBlackTree_getParent(parent);\
+                }\
+                RedBlackTree_setBlack(parent);\
+                RedBlackTree_setRed(grandParent);\
+                prefix##_rotateLeft(tree, grandParent);\
+            }\
+        }\
+    }\
+    RedBlackTree_setBlack(tree->root);\
+}\
+\
+static RedBlackTree_Node *prefix##_unlink(RedBlackTree *tree, RedBlackTree_Node *node) {\
+    RedBlackTree_countStat(tree, removals, 1);\
+    RedBlackTree_Node *successor = NULL; /* becomes not null if node has two children */\
+    RedBlackTree_Node *x = NULL;\
+    RedBlackTree_Node *xParent = NULL;\
+    if (node->left == NULL) x = node->right;\
+    else if (node->right == NULL) x = node->left;\
+    else {\
+        successor = RedBlackTree_findMin(node->right);\
+        x = successor->right;\
+    }\
+    RedBlackTree_Node *zp = RedBlackTree_getParent(node);\
+    if (successor != NULL) {\
+        RedBlackTree_setParent(node->left, successor);\
+        successor->left = node->left;\
+        if (successor != node->right) {\
+            xParent = RedBlackTree_getParent(successor);\
+            if (x != NULL) RedBlackTree_setParent(x, RedBlackTree_getParent(successor));\
+            RedBlackTree_getParent(successor)->left = x;\
+            successor->right = node->right;\
+            RedBlackTree_setParent(node->right, successor);\
+        } else {\
+            xParent = successor;\
+        }\
+        if (tree->root == node) tree->root = successor;\
+        else if (zp->left == node) zp->left = successor;\
+        else zp->right = successor;\
+        bool yBlack = RedBlackTree_isBlack(successor);\
+        successor->parent = node->parent; /* both same parent and color */\
+        RedBlackTree_setColor(node, yBlack);\
+    } else {\
+        xParent = RedBlackTree_getParent(node);\
+        if (x != NULL) RedBlackTree_setParent(x, RedBlackTree_getParent(node));\
+        if (tree->root == node) tree->root = x;\
+        else if (zp->left == node) zp->left = x;\
+        else zp->right = x;\
+        if (tree->leftmost == node) {\
+            if (node->right == NULL) {\
+                assert(node->left == NULL);\
+                tree->leftmost = zp;\
+            } else {\
+                tree->leftmost = RedBlackTree_findMin(x);\
+            }\
+        }\
+        if (tree->rightmost == node) {\
+            if (node->left == NULL) {\
+                assert(node->right == NULL);\
+                tree->rightmost = zp;\
+            } else {\
+                tree->rightmost = RedBlackTree_findMax(x);\
+            }\
+        }\
+    }\
+    RedBlackTree_Node *result = xParent;\
+    /* Balance */\
+    if (RedBlackTree_isRed(node)) return result;\
+    while (x != tree->root && (x == NULL || RedBlackTree_isBlack(x))) {\
+        RedBlackTree_countStat(tree, removeRebalanceSteps, 1);\
+        if (x == xParent->left) {\
+            RedBlackTree_Node *w = xParent->right;\
+            if (RedBlackTree_isRed(w)) {\
+                RedBlackTree_setBlack(w);\
+                RedBlackTree_setRed(xParent);\
+                prefix##_rotateLeft(tree, xParent);\
+                w = xParent->right;\
+            }\
+            if (((w->left == NULL) || RedBlackTree_isBlack(w->left)) && ((w->right == NULL) || RedBlackTree_isBlack(w->right))) {\
+                RedBlackTree_setRed(w);\
+                x = xParent;\
+                xParent = RedBlackTree_getParent(xParent);\
+            } else {\
+                if ((w->right == NULL) || RedBlackTree_isBlack(w->right)) {\
+                    if (w->left != NULL) RedBlackTree_setBlack(w->left);\
+                    RedBlackTree_setRed(w);\
+                    prefix##_rotateRight(tree, w);\
+                    w = xParent->right;\
+                }\
+                RedBlackTree_setColor(w, RedBlackTree_isBlack(xParent));\
+                RedBlackTree_setBlack(xParent);\
+                if (w->right != NULL) RedBlackTree_setBlack(w->right);\
+                prefix##_rotateLeft(tree, xParent);\
+                break;\
+            }\
+        } else {\
+            RedBlackTree_Node *w = xParent->left;\
+            if (RedBlackTree_isRed(w)) {\
+                RedBlackTree_setBlack(w);\
+                RedBlackTree_setRed(xParent);\
+                prefix##_rotateRight(tree, xParent);\
+                w = xParent->left;\
+            }\
+            if (((w->right == NULL) || RedBlackTree_isBlack(w->right)) && ((w->left == NULL) || RedBlackTree_isBlack(w->left))) {\
+                RedBlackTree_setRed(w);\
+                x = xParent;\
+                xParent = RedBlackTree_getParent(xParent);\
+            } else {\
+                if ((w->left == NULL) || RedBlackTree_isBlack(w->left)) {\
+                    if (w->right != NULL) RedBlackTree_setBlack(w->right);\
+                    RedBlackTree_setRed(w);\
+                    prefix##_rotateLeft(tree, w);\
+                    w = xParent->left;\
+                }\
+                RedBlackTree_setColor(w, RedBlackTree_isBlack(xParent));\
+                RedBlackTree_setBlack(xParent);\
+                if (w->left != NULL) RedBlackTree_setBlack(w->left);\
+                prefix##_rotateRight(tree, xParent);\
+                break;\
+            }\
+        }\
+    }\
+    if (x != NULL) RedBlackTree_setBlack(x);\
+    return result;\
+}\
+\
+static inline void prefix##_updatePath(RedBlackTree_Node *node) {\
+    while (node != NULL) {\
+        update(node);\
+        node = RedBlackTree_getParent(node);\
+    }\
+}
+
 
 /******************************************************************************
  * Code dependent on the node key
@@ -121,7 +474,15 @@ static inline void RedBlackTree_setParent(RedBlackTree_Node *node, RedBlackTree_
  * @param isLess name of the function comparing nodes.
  */
 #define RedBlackTree_instantiateInsert(functionName, isLess)\
+    RedBlackTree_instantiateInsertWith(functionName, isLess, RedBlackTree_postInsert)
+
+/**
+ * Internal poor man's template for insertion functions, parameterized
+ * on the function restoring balance after the node has been linked.
+ */
+#define RedBlackTree_instantiateInsertWith(functionName, isLess, postInsert)\
 void functionName(RedBlackTree *tree, RedBlackTree_Node *node) {\
+    RedBlackTree_countStat(tree, insertions, 1);\
     node->left = NULL;\
     node->right = NULL;\
     if (tree->root != NULL) {\
@@ -136,6 +497,8 @@ void functionName(RedBlackTree *tree, RedBlackTree_Node *node) {\
         } else {\
             RedBlackTree_Node *i = tree->root;\
             while (i != NULL) {\
+                RedBlackTree_countStat(tree, descentSteps, 1);\
+                RedBlackTree_prefetchChildren(i);\
                 if (isLess(node, i)) {\
                     if (i->left == NULL) {\
                         i->left = node;\
@@ -152,7 +515,7 @@ void functionName(RedBlackTree *tree, RedBlackTree_Node *node) {\
             }\
             RedBlackTree_setParent(node, i);\
         }\
-        RedBlackTree_postInsert(tree, node);\
+        postInsert(tree, node);\
     } else {\
         node->parent = RedBlackTree_black;\
         tree->root = node;\
@@ -161,4 +524,333 @@ void functionName(RedBlackTree *tree, RedBlackTree_Node *node) {\
     }\
 }
 
+/**
+ * Instantiates a function looking up a node by key in a concrete red-black tree.
+ * The generated function takes (RedBlackTree *tree, RedBlackTree_Node *key),
+ * where key is a node, not necessarily in the tree, with the key to look for,
+ * and returns the first node equal to key, or NULL if not found.
+ * Uses a single comparison per level, like lower bound, and another one at
+ * the end to check for equality.
+ * @param functionName name of the function to generate (e.g. RedBlackTreeUintptr_find)
+ * @param isLess name of the function comparing nodes.
+ */
+#define RedBlackTree_instantiateFind(functionName, isLess)\
+RedBlackTree_Node *functionName(RedBlackTree *tree, RedBlackTree_Node *key) {\
+    RedBlackTree_Node *found = NULL;\
+    RedBlackTree_Node *i = tree->root;\
+    while (i != NULL) {\
+        if (isLess(i, key)) {\
+            i = i->right;\
+        } else {\
+            found = i;\
+            i = i->left;\
+        }\
+    }\
+    if (found != NULL && isLess(key, found)) return NULL;\
+    return found;\
+}
+
+/**
+ * Instantiates a function returning the first node not less than a key
+ * in a concrete red-black tree, or NULL if all nodes are less than key.
+ * The generated function takes (RedBlackTree *tree, RedBlackTree_Node *key).
+ * @param functionName name of the function to generate (e.g. RedBlackTreeUintptr_lowerBound)
+ * @param isLess name of the function comparing nodes.
+ */
+#define RedBlackTree_instantiateLowerBound(functionName, isLess)\
+RedBlackTree_Node *functionName(RedBlackTree *tree, RedBlackTree_Node *key) {\
+    RedBlackTree_Node *found = NULL;\
+    RedBlackTree_Node *i = tree->root;\
+    while (i != NULL) {\
+        if (isLess(i, key)) {\
+            i = i->right;\
+        } else {\
+            found = i;\
+            i = i->left;\
+        }\
+    }\
+    return found;\
+}
+
+/**
+ * Instantiates a function returning the first node greater than a key
+ * in a concrete red-black tree, or NULL if no node is greater than key.
+ * The generated function takes (RedBlackTree *tree, RedBlackTree_Node *key).
+ * @param functionName name of the function to generate (e.g. RedBlackTreeUintptr_upperBound)
+ * @param isLess name of the function comparing nodes.
+ */
+#define RedBlackTree_instantiateUpperBound(functionName, isLess)\
+RedBlackTree_Node *functionName(RedBlackTree *tree, RedBlackTree_Node *key) {\
+    RedBlackTree_Node *found = NULL;\
+    RedBlackTree_Node *i = tree->root;\
+    while (i != NULL) {\
+        if (isLess(key, i)) {\
+            found = i;\
+            i = i->left;\
+        } else {\
+            i = i->right;\
+        }\
+    }\
+    return found;\
+}
+
+/**
+ * Instantiates a function visiting in key order, without modifying the tree,
+ * all nodes not less than lo and less than hi in a concrete red-black tree.
+ * The generated function takes (RedBlackTree *tree, RedBlackTree_Node *lo,
+ * RedBlackTree_Node *hi, void *context), where lo and hi are nodes, not
+ * necessarily in the tree, with the bounds of the range, and calls the visit
+ * function, taking (RedBlackTree_Node *node, void *context), on each node in range.
+ * @param functionName name of the function to generate (e.g. RedBlackTreeUintptr_visitRange)
+ * @param isLess name of the function comparing nodes.
+ * @param visit name of the function to call on each node.
+ */
+#define RedBlackTree_instantiateVisitRange(functionName, isLess, visit)\
+void functionName(RedBlackTree *tree, RedBlackTree_Node *lo, RedBlackTree_Node *hi, void *context) {\
+    RedBlackTree_Node *node = NULL;\
+    RedBlackTree_Node *i = tree->root;\
+    while (i != NULL) {\
+        if (isLess(i, lo)) {\
+            i = i->right;\
+        } else {\
+            node = i;\
+            i = i->left;\
+        }\
+    }\
+    while (node != NULL && isLess(node, hi)) {\
+        visit(node, context);\
+        node = RedBlackTree_next(node);\
+    }\
+}
+
+/**
+ * Instantiates a function looking up a node by key in a concrete red-black
+ * tree protected by a SeqLock (see SeqLock.h, to be included before
+ * expanding), for many reader threads concurrent with one writer, as with
+ * AvlTree_instantiateOptimisticFind. The writer keeps using the usual
+ * insertion function and RedBlackTree_remove, enclosed between
+ * SeqLock_writeBegin and SeqLock_writeEnd.
+ * The generated function takes (const SeqLock *lock, RedBlackTree *tree,
+ * RedBlackTree_Node *key, void *context) and returns true if a node equal to
+ * key was found, calling read, taking (RedBlackTree_Node *node, void *context),
+ * to copy data out of the found node, possibly more than once.
+ * @param functionName name of the function to generate (e.g. RedBlackTreeUintptr_optimisticFind)
+ * @param isLess name of the function comparing nodes.
+ * @param read name of the function copying data out of the found node.
+ */
+#define RedBlackTree_instantiateOptimisticFind(functionName, isLess, read)\
+bool functionName(const SeqLock *lock, RedBlackTree *tree, RedBlackTree_Node *key, void *context) {\
+    while (true) {\
+        unsigned sequence = SeqLock_readBegin(lock);\
+        RedBlackTree_Node *found = NULL;\
+        RedBlackTree_Node *i = __atomic_load_n(&tree->root, __ATOMIC_RELAXED);\
+        for (size_t depth = 0; i != NULL && depth < SeqLock_maxDescent; depth++) {\
+            if (isLess(i, key)) {\
+                i = __atomic_load_n(&i->right, __ATOMIC_RELAXED);\
+            } else {\
+                found = i;\
+                i = __atomic_load_n(&i->left, __ATOMIC_RELAXED);\
+            }\
+        }\
+        if (i != NULL) continue; /* torn by the writer */\
+        bool isFound = found != NULL && !isLess(key, found);\
+        if (isFound) read(found, context);\
+        if (!SeqLock_readRetry(lock, sequence)) return isFound;\
+    }\
+}
+
+/**
+ * Instantiates a function to build a red-black tree from an array of unsorted
+ * nodes. The generated function has the same parameters as
+ * RedBlackTree_buildFromSorted, and sorts the array in place using heapsort
+ * before linking nodes, thus the relative order of nodes with equal keys
+ * is not preserved.
+ * @param functionName name of the function to generate (e.g. RedBlackTreeUintptr_build)
+ * @param isLess name of the function comparing nodes.
+ */
+#define RedBlackTree_instantiateBuild(functionName, isLess)\
+static void functionName##_siftDown(RedBlackTree_Node **nodes, size_t index, size_t count) {\
+    RedBlackTree_Node *node = nodes[index];\
+    while (true) {\
+        size_t child = 2 * index + 1;\
+        if (child >= count) break;\
+        if ((child + 1 < count) && isLess(nodes[child], nodes[child + 1])) child++;\
+        if (!isLess(node, nodes[child])) break;\
+        nodes[index] = nodes[child];\
+        index = child;\
+    }\
+    nodes[index] = node;\
+}\
+\
+void functionName(RedBlackTree *tree, RedBlackTree_Node **nodes, size_t count) {\
+    for (size_t i = count / 2; i-- > 0; ) {\
+        functionName##_siftDown(nodes, i, count);\
+    }\
+    for (size_t i = count; i-- > 1; ) {\
+        RedBlackTree_Node *max = nodes[0];\
+        nodes[0] = nodes[i];\
+        nodes[i] = max;\
+        functionName##_siftDown(nodes, 0, i);\
+    }\
+    RedBlackTree_buildFromSorted(tree, nodes, count);\
+}
+
+/**
+ * Instantiates a function to split a red-black tree by key.
+ * The generated function takes (RedBlackTree *tree, RedBlackTree_Node *key, RedBlackTree *other)
+ * and moves all nodes not less than the key node to other, which must be empty.
+ * The key node is only used for comparison and need not be in the tree.
+ * @param functionName name of the function to generate (e.g. RedBlackTreeUintptr_split)
+ * @param isLess name of the function comparing nodes.
+ */
+#define RedBlackTree_instantiateSplit(functionName, isLess)\
+void functionName(RedBlackTree *tree, RedBlackTree_Node *key, RedBlackTree *other) {\
+    RedBlackTree_Node *found = NULL;\
+    RedBlackTree_Node *i = tree->root;\
+    while (i != NULL) {\
+        if (isLess(i, key)) {\
+            i = i->right;\
+        } else {\
+            found = i;\
+            i = i->left;\
+        }\
+    }\
+    if (found != NULL) RedBlackTree_split(tree, found, other);\
+}
+
+/**
+ * Instantiates insertion and removal functions for a red-black tree whose
+ * nodes carry data aggregated over their subtree, such as the minimum,
+ * maximum or sum of a field of the elements, to answer aggregate queries
+ * in logarithmic time.
+ * The update function, taking (RedBlackTree_Node *node), must recompute the
+ * aggregate of node from the node itself and its left and right children,
+ * any of which may be NULL. It is called on nodes moved by rotations and on
+ * the path to the root after insertion and removal. Such trees must be
+ * modified only using the generated functions:
+ * - void prefix##_insert(RedBlackTree *tree, RedBlackTree_Node *node);
+ * - void prefix##_remove(RedBlackTree *tree, RedBlackTree_Node *node).
+ * @param prefix prefix for names of the generated functions (e.g. RedBlackTreeUintptr).
+ * @param isLess name of the function comparing nodes.
+ * @param update name of the function updating the aggregate of a node.
+ */
+#define RedBlackTree_instantiateAugmented(prefix, isLess, update)\
+RedBlackTree_instantiateBalancing(prefix, update)\
+\
+static void prefix##_postInsert(RedBlackTree *tree, RedBlackTree_Node *node) {\
+    prefix##_updatePath(RedBlackTree_getParent(node));\
+    prefix##_rebalanceAfterInsertion(tree, node);\
+}\
+\
+RedBlackTree_instantiateInsertWith(prefix##_link, isLess, prefix##_postInsert)\
+\
+void prefix##_insert(RedBlackTree *tree, RedBlackTree_Node *node) {\
+    node->left = NULL;\
+    node->right = NULL;\
+    update(node);\
+    prefix##_link(tree, node);\
+}\
+\
+void prefix##_remove(RedBlackTree *tree, RedBlackTree_Node *node) {\
+    prefix##_updatePath(prefix##_unlink(tree, node));\
+}
+
+/**
+ * Instantiates an intrusive interval tree on a red-black tree, as an
+ * augmented tree ordered by interval beginning, whose nodes cache the
+ * maximum end of the intervals in their subtree, kept up to date through
+ * rotations. Intervals are half-open, that is [begin, end) with begin < end,
+ * and elements must provide storage for the cached maximum end.
+ * Besides prefix##_insert and prefix##_remove, as with
+ * RedBlackTree_instantiateAugmented, it defines the prefix##_Endpoint type
+ * and internal accessors used by the RedBlackTree_instantiateStabbingQuery
+ * and RedBlackTree_instantiateOverlapQuery macros.
+ * @param prefix prefix for names of the generated functions (e.g. IntervalTree).
+ * @param Endpoint type of interval endpoints, comparable with < (e.g. uint64_t).
+ * @param getBegin name of the function taking (const RedBlackTree_Node *node) and returning its interval beginning.
+ * @param getEnd name of the function taking (const RedBlackTree_Node *node) and returning its interval end.
+ * @param getMaxEnd name of the function taking (const RedBlackTree_Node *node) and returning its cached maximum end.
+ * @param setMaxEnd name of the function taking (RedBlackTree_Node *node, Endpoint maxEnd) and caching the maximum end.
+ */
+#define RedBlackTree_instantiateIntervalTree(prefix, Endpoint, getBegin, getEnd, getMaxEnd, setMaxEnd)\
+typedef Endpoint prefix##_Endpoint;\
+\
+static inline Endpoint prefix##_getBegin(const RedBlackTree_Node *node) {\
+    return getBegin(node);\
+}\
+\
+static inline Endpoint prefix##_getEnd(const RedBlackTree_Node *node) {\
+    return getEnd(node);\
+}\
+\
+static inline Endpoint prefix##_getMaxEnd(const RedBlackTree_Node *node) {\
+    return getMaxEnd(node);\
+}\
+\
+static inline bool prefix##_isLess(RedBlackTree_Node *node, RedBlackTree_Node *other) {\
+    return getBegin(node) < getBegin(other);\
+}\
+\
+static inline void prefix##_updateMaxEnd(RedBlackTree_Node *node) {\
+    Endpoint maxEnd = getEnd(node);\
+    if (node->left != NULL && maxEnd < getMaxEnd(node->left)) maxEnd = getMaxEnd(node->left);\
+    if (node->right != NULL && maxEnd < getMaxEnd(node->right)) maxEnd = getMaxEnd(node->right);\
+    setMaxEnd(node, maxEnd);\
+}\
+\
+RedBlackTree_instantiateAugmented(prefix, prefix##_isLess, prefix##_updateMaxEnd)
+
+/**
+ * Instantiates a function visiting, in order of beginning, all intervals
+ * containing a point in an interval tree (see RedBlackTree_instantiateIntervalTree).
+ * The generated function takes (RedBlackTree *tree, prefix##_Endpoint point,
+ * void *context) and calls the visit function, taking (RedBlackTree_Node *node,
+ * void *context), on each node whose interval contains point.
+ * Subtrees whose maximum end is not greater than point are skipped, as are
+ * right subtrees of nodes beginning after point, thus the query takes
+ * O(log n) time if no interval is found, and at most O(log n) per interval found.
+ * @param functionName name of the function to generate (e.g. IntervalTree_stab)
+ * @param prefix prefix used to instantiate the interval tree.
+ * @param visit name of the function to call on each interval found.
+ */
+#define RedBlackTree_instantiateStabbingQuery(functionName, prefix, visit)\
+static void functionName##_visitSubtree(RedBlackTree_Node *node, prefix##_Endpoint point, void *context) {\
+    while (node != NULL && point < prefix##_getMaxEnd(node)) {\
+        functionName##_visitSubtree(node->left, point, context);\
+        if (point < prefix##_getBegin(node)) return;\
+        if (point < prefix##_getEnd(node)) visit(node, context);\
+        node = node->right;\
+    }\
+}\
+\
+void functionName(RedBlackTree *tree, prefix##_Endpoint point, void *context) {\
+    functionName##_visitSubtree(tree->root, point, context);\
+}
+
+/**
+ * Instantiates a function visiting, in order of beginning, all intervals
+ * overlapping the interval [lo, hi) in an interval tree (see
+ * RedBlackTree_instantiateIntervalTree), that is beginning before hi and
+ * ending after lo. The generated function takes (RedBlackTree *tree,
+ * prefix##_Endpoint lo, prefix##_Endpoint hi, void *context) and calls the
+ * visit function, taking (RedBlackTree_Node *node, void *context), on each
+ * overlapping node, with the same complexity of stabbing queries.
+ * @param functionName name of the function to generate (e.g. IntervalTree_overlap)
+ * @param prefix prefix used to instantiate the interval tree.
+ * @param visit name of the function to call on each interval found.
+ */
+#define RedBlackTree_instantiateOverlapQuery(functionName, prefix, visit)\
+static void functionName##_visitSubtree(RedBlackTree_Node *node, prefix##_Endpoint lo, prefix##_Endpoint hi, void *context) {\
+    while (node != NULL && lo < prefix##_getMaxEnd(node)) {\
+        functionName##_visitSubtree(node->left, lo, hi, context);\
+        if (!(prefix##_getBegin(node) < hi)) return;\
+        if (lo < prefix##_getEnd(node)) visit(node, context);\
+        node = node->right;\
+    }\
+}\
+\
+void functionName(RedBlackTree *tree, prefix##_Endpoint lo, prefix##_Endpoint hi, void *context) {\
+    functionName##_visitSubtree(tree->root, lo, hi, context);\
+}
+
 #endif
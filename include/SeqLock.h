@@ -0,0 +1,99 @@
+/*
+Sequence lock for optimistic concurrent readers.
+Copyright 2012-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/******************************************************************************
+ * A sequence lock lets one writer at a time update a data structure while
+ * any number of readers access it without writing to shared memory, thus
+ * scaling with the count of reader threads. The writer makes the sequence
+ * odd while updating. Readers take note of an even sequence, read
+ * optimistically, then retry if the sequence changed meanwhile, discarding
+ * whatever they read.
+ *
+ * Optimistic readers may observe the data structure halfway through an
+ * update, so they must never crash nor loop forever on inconsistent data:
+ * memory reachable from the data structure must stay mapped and typed
+ * (for example, elements allocated from a pool never returned to the system)
+ * and loops must be bounded. The AvlTree_instantiateOptimisticFind and
+ * RedBlackTree_instantiateOptimisticFind macros expand such readers for trees.
+ * Writers must be serialized by other means, if more than one.
+ ******************************************************************************/
+#ifndef SEQLOCK_H_INCLUDED
+#define SEQLOCK_H_INCLUDED
+
+#include <stdbool.h>
+
+/**
+ * Maximum count of levels an optimistic reader descends in a balanced
+ * binary tree before giving up, as no valid AVL or red-black tree in the
+ * address space is that tall, thus the reader is seeing an update in progress.
+ */
+#define SeqLock_maxDescent (2 * sizeof(void *) * 8)
+
+/** Sequence lock, odd while a writer is updating the protected data. */
+typedef struct SeqLock {
+    unsigned sequence;
+} SeqLock;
+
+static inline void SeqLock_initialize(SeqLock *lock) {
+    lock->sequence = 0;
+}
+
+/** Hints the processor that the caller is spinning, using the pause instruction on x86. */
+static inline void SeqLock_cpuRelax(void) {
+    #if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+    #else
+    __asm__ __volatile__("" ::: "memory");
+    #endif
+}
+
+/** Begins an optimistic read, waiting for any update in progress, returning the sequence to validate. */
+static inline unsigned SeqLock_readBegin(const SeqLock *lock) {
+    unsigned sequence;
+    while ((sequence = __atomic_load_n(&lock->sequence, __ATOMIC_ACQUIRE)) & 1) {
+        SeqLock_cpuRelax();
+    }
+    return sequence;
+}
+
+/** Ends an optimistic read, returning true if a writer intervened and the read must be retried. */
+static inline bool SeqLock_readRetry(const SeqLock *lock, unsigned sequence) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&lock->sequence, __ATOMIC_RELAXED) != sequence;
+}
+
+/** Begins an update, making concurrent and new readers retry. */
+static inline void SeqLock_writeBegin(SeqLock *lock) {
+    __atomic_store_n(&lock->sequence, lock->sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/** Ends an update, publishing it to readers. */
+static inline void SeqLock_writeEnd(SeqLock *lock) {
+    __atomic_store_n(&lock->sequence, lock->sequence + 1, __ATOMIC_RELEASE);
+}
+
+#endif
@@ -0,0 +1,291 @@
+/*
+Intrusive hierarchical timing wheel container.
+Copyright 2017-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/******************************************************************************
+ * This is a poor man's template file.
+ * In order to use the container, you need to instantiate the poor man's
+ * template macros for header and implementation.
+ *
+ * A timing wheel keeps timers armed for a tick in the future in a doubly
+ * linked list for each slot, thus arming and cancelling a timer take
+ * constant time. This hierarchical variant has levels of 64 slots each:
+ * level L holds timers whose expiry, in base 64, first differs from the
+ * current time at digit L, in the slot for that digit. Timers too far in the
+ * future for the configured levels wait in an overflow list, that is placed
+ * again only when the current time reaches the range of its earliest timer.
+ * When the current time reaches the start of a slot of a higher level,
+ * timers of that slot are cascaded to lower levels, and level 0 slots
+ * expire timers. A bitmap for each level tells non-empty slots apart, so
+ * that advancing the time jumps straight to the next slot to cascade or to
+ * expire, rather than stepping through each tick.
+ ******************************************************************************/
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Instantiates the header for an intrusive hierarchical timing wheel.
+ * @param TimerWheel name of the container to instantiate.
+ * @param levelCount count of levels of 64 slots, covering 64^levelCount ticks.
+ */
+#define TimerWheel_header(TimerWheel, levelCount) \
+\
+typedef struct TimerWheel##_Node TimerWheel##_Node;\
+\
+struct TimerWheel##_Node {\
+    TimerWheel##_Node *prev;\
+    TimerWheel##_Node *next;\
+    uint64_t expiry;\
+};\
+\
+typedef struct TimerWheel {\
+    TimerWheel##_Node slots[levelCount][64];\
+    TimerWheel##_Node overflow;\
+    uint64_t overflowMin; /* not greater than the expiry of any timer in the overflow list */\
+    uint64_t bitmaps[levelCount];\
+    uint64_t now;\
+} TimerWheel;\
+\
+/** Initializes an empty list, such as the one to collect expired timers into. */\
+static inline void TimerWheel##_initializeList(TimerWheel##_Node *list) {\
+    list->prev = list;\
+    list->next = list;\
+}\
+\
+static inline uint64_t TimerWheel##_getTime(const TimerWheel *wheel) {\
+    return wheel->now;\
+}\
+\
+static inline bool TimerWheel##_isEmpty(const TimerWheel *wheel) {\
+    for (size_t i = 0; i < levelCount; i++) {\
+        if (wheel->bitmaps[i] != 0) return false;\
+    }\
+    return wheel->overflow.next == &wheel->overflow;\
+}\
+\
+void TimerWheel##_initialize(TimerWheel *wheel, uint64_t now);\
+void TimerWheel##_arm(TimerWheel *wheel, TimerWheel##_Node *timer, uint64_t expiry);\
+void TimerWheel##_cancel(TimerWheel *wheel, TimerWheel##_Node *timer);\
+void TimerWheel##_advance(TimerWheel *wheel, uint64_t time, TimerWheel##_Node *expired);\
+void TimerWheel##_check(const TimerWheel *wheel);
+
+
+/**
+ * Instantiates the implementation for an intrusive hierarchical timing wheel.
+ * @param TimerWheel name of the container to instantiate.
+ * @param levelCount count of levels of 64 slots, covering 64^levelCount ticks.
+ */
+#define TimerWheel_implementation(TimerWheel, levelCount) \
+\
+_Static_assert((levelCount) >= 1 && (levelCount) <= 11, "levelCount must be between 1 and 11");\
+\
+static inline void TimerWheel##_append(TimerWheel##_Node *list, TimerWheel##_Node *timer) {\
+    timer->prev = list->prev;\
+    timer->next = list;\
+    list->prev->next = timer;\
+    list->prev = timer;\
+}\
+\
+/** Moves all timers of the list from to the end of the list to. */\
+static inline void TimerWheel##_splice(TimerWheel##_Node *to, TimerWheel##_Node *from) {\
+    if (from->next == from) return;\
+    from->next->prev = to->prev;\
+    to->prev->next = from->next;\
+    from->prev->next = to;\
+    to->prev = from->prev;\
+    from->next = from;\
+    from->prev = from;\
+}\
+\
+/**
+ * Places a timer in the slot for its expiry with respect to the current time.
+ * Timers already expired are placed in the current slot of level 0.
+ */\
+static void TimerWheel##_place(TimerWheel *wheel, TimerWheel##_Node *timer) {\
+    uint64_t expiry = (timer->expiry > wheel->now) ? timer->expiry : wheel->now;\
+    uint64_t diff = expiry ^ wheel->now;\
+    unsigned level = (diff != 0) ? (63 - __builtin_clzll(diff)) / 6 : 0;\
+    if (level >= (levelCount)) {\
+        TimerWheel##_append(&wheel->overflow, timer);\
+        if (expiry < wheel->overflowMin) wheel->overflowMin = expiry;\
+        return;\
+    }\
+    unsigned slot = (expiry >> (6 * level)) & 63;\
+    TimerWheel##_append(&wheel->slots[level][slot], timer);\
+    wheel->bitmaps[level] |= UINT64_C(1) << slot;\
+}\
+\
+/** Places again all timers of the specified list, that must be detached from the wheel. */\
+static void TimerWheel##_placeAll(TimerWheel *wheel, TimerWheel##_Node *list) {\
+    TimerWheel##_Node *x = list->next;\
+    list->next = list;\
+    list->prev = list;\
+    while (x != list) {\
+        TimerWheel##_Node *next = x->next;\
+        TimerWheel##_place(wheel, x);\
+        x = next;\
+    }\
+}\
+\
+/**
+ * Returns the time where the overflow list must be placed again, that is the
+ * beginning of the range of the top level containing the earliest timer.
+ * Call only if the overflow list is not empty.
+ */\
+static inline uint64_t TimerWheel##_getOverflowStart(const TimerWheel *wheel) {\
+    unsigned shift = 6 * (levelCount) % 64;\
+    return (wheel->overflowMin >> shift) << shift;\
+}\
+\
+/**
+ * Finds the first time after the current one where a slot of a level above 0
+ * begins and must be cascaded, or the overflow list must be placed again.
+ * As slots of higher levels begin after all slots of lower levels, this is
+ * the first non-empty slot following the current one in the lowest level.
+ * @return The time found, or UINT64_MAX if there is none.
+ */\
+static uint64_t TimerWheel##_findNextCascade(const TimerWheel *wheel) {\
+    for (unsigned level = 1; level < (levelCount); level++) {\
+        unsigned digit = (wheel->now >> (6 * level)) & 63;\
+        uint64_t following = (digit < 63) ? wheel->bitmaps[level] & (~UINT64_C(0) << (digit + 1)) : 0;\
+        if (following != 0) {\
+            unsigned shift = 6 * (level + 1);\
+            uint64_t base = (shift < 64) ? (wheel->now >> shift) << shift : 0;\
+            return base | ((uint64_t) __builtin_ctzll(following) << (6 * level));\
+        }\
+    }\
+    if (wheel->overflow.next != &wheel->overflow) {\
+        assert(TimerWheel##_getOverflowStart(wheel) > wheel->now);\
+        return TimerWheel##_getOverflowStart(wheel);\
+    }\
+    return UINT64_MAX;\
+}\
+\
+/** Cascades slots of levels above 0 beginning at the current time. */\
+static void TimerWheel##_cascade(TimerWheel *wheel) {\
+    if ((wheel->overflow.next != &wheel->overflow) && TimerWheel##_getOverflowStart(wheel) == wheel->now) {\
+        wheel->overflowMin = UINT64_MAX;\
+        TimerWheel##_placeAll(wheel, &wheel->overflow);\
+    }\
+    for (unsigned level = (levelCount) - 1; level > 0; level--) {\
+        if ((wheel->now & ((UINT64_C(1) << (6 * level)) - 1)) != 0) continue;\
+        unsigned digit = (wheel->now >> (6 * level)) & 63;\
+        if ((wheel->bitmaps[level] & (UINT64_C(1) << digit)) == 0) continue;\
+        wheel->bitmaps[level] &= ~(UINT64_C(1) << digit);\
+        TimerWheel##_placeAll(wheel, &wheel->slots[level][digit]);\
+    }\
+}\
+\
+/** Initializes an empty timing wheel with the specified current time. */\
+void TimerWheel##_initialize(TimerWheel *wheel, uint64_t now) {\
+    for (size_t i = 0; i < (levelCount); i++) {\
+        for (size_t j = 0; j < 64; j++) {\
+            TimerWheel##_initializeList(&wheel->slots[i][j]);\
+        }\
+        wheel->bitmaps[i] = 0;\
+    }\
+    TimerWheel##_initializeList(&wheel->overflow);\
+    wheel->overflowMin = UINT64_MAX;\
+    wheel->now = now;\
+}\
+\
+/**
+ * Arms a timer to expire at the specified time. The timer must not be armed.
+ * Timers armed for the current time or before are due at the current time,
+ * thus they expire on the next advance after timers already due then.
+ */\
+void TimerWheel##_arm(TimerWheel *wheel, TimerWheel##_Node *timer, uint64_t expiry) {\
+    timer->expiry = expiry;\
+    TimerWheel##_place(wheel, timer);\
+}\
+\
+/** Cancels an armed timer, that has not expired yet. */\
+void TimerWheel##_cancel(TimerWheel *wheel, TimerWheel##_Node *timer) {\
+    timer->next->prev = timer->prev;\
+    timer->prev->next = timer->next;\
+    if (timer->prev == timer->next) {\
+        /* The timer was alone, thus both links point to the sentinel of its slot */\
+        if (timer->prev == &wheel->overflow) {\
+            wheel->overflowMin = UINT64_MAX;\
+        } else {\
+            size_t index = timer->prev - &wheel->slots[0][0];\
+            wheel->bitmaps[index / 64] &= ~(UINT64_C(1) << (index % 64));\
+        }\
+    }\
+}\
+\
+/**
+ * Advances the current time to the specified one, not less than the current
+ * one, moving timers expired meanwhile to the end of the expired list,
+ * in order of the time they are due. Timers due at the same time, such as
+ * those armed for a time already past, expire in arming order.
+ * Empty slots are skipped using bitmaps.
+ */\
+void TimerWheel##_advance(TimerWheel *wheel, uint64_t time, TimerWheel##_Node *expired) {\
+    assert(time >= wheel->now);\
+    while (true) {\
+        bool lastRound = (time >> 6) == (wheel->now >> 6);\
+        unsigned first = wheel->now & 63;\
+        unsigned last = lastRound ? (time & 63) : 63;\
+        uint64_t mask = (~UINT64_C(0) << first) & (~UINT64_C(0) >> (63 - last));\
+        uint64_t due = wheel->bitmaps[0] & mask;\
+        wheel->bitmaps[0] &= ~mask;\
+        while (due != 0) {\
+            TimerWheel##_splice(expired, &wheel->slots[0][__builtin_ctzll(due)]);\
+            due &= due - 1;\
+        }\
+        if (lastRound) break;\
+        /* Level 0 is empty now, jump to the next slot to cascade, if any before time */\
+        uint64_t next = TimerWheel##_findNextCascade(wheel);\
+        if (next > time) break;\
+        wheel->now = next;\
+        TimerWheel##_cascade(wheel);\
+    }\
+    wheel->now = time;\
+}\
+\
+/** Checks that each timer is in the slot for its expiry and that bitmaps match slots. */\
+void TimerWheel##_check(const TimerWheel *wheel) {\
+    for (unsigned level = 0; level < (levelCount); level++) {\
+        for (unsigned slot = 0; slot < 64; slot++) {\
+            const TimerWheel##_Node *l = &wheel->slots[level][slot];\
+            assert(((wheel->bitmaps[level] & (UINT64_C(1) << slot)) != 0) == (l->next != l));\
+            for (const TimerWheel##_Node *x = l->next; x != l; x = x->next) {\
+                assert(x->next->prev == x);\
+                assert(level == 0 || x->expiry > wheel->now);\
+                assert(level == 0 || (unsigned) (63 - __builtin_clzll(x->expiry ^ wheel->now)) / 6 == level);\
+                assert(level == 0 || ((x->expiry >> (6 * level)) & 63) == slot);\
+                assert(level > 0 || x->expiry <= wheel->now || (x->expiry >> 6) == (wheel->now >> 6));\
+            }\
+        }\
+    }\
+    for (const TimerWheel##_Node *x = wheel->overflow.next; x != &wheel->overflow; x = x->next) {\
+        assert(x->next->prev == x);\
+        assert((unsigned) (63 - __builtin_clzll(x->expiry ^ wheel->now)) / 6 >= (levelCount));\
+        assert(x->expiry >= wheel->overflowMin);\
+    }\
+}
@@ -22,6 +22,14 @@ CND_ARTIFACT_PATH_Release=dist/Release/GNU-Linux/cutil
 CND_PACKAGE_DIR_Release=dist/Release/GNU-Linux/package
 CND_PACKAGE_NAME_Release=cutil.tar
 CND_PACKAGE_PATH_Release=dist/Release/GNU-Linux/package/cutil.tar
+# Release64 configuration
+CND_PLATFORM_Release64=GNU-Linux
+CND_ARTIFACT_DIR_Release64=dist/Release64/GNU-Linux
+CND_ARTIFACT_NAME_Release64=cutil
+CND_ARTIFACT_PATH_Release64=dist/Release64/GNU-Linux/cutil
+CND_PACKAGE_DIR_Release64=dist/Release64/GNU-Linux/package
+CND_PACKAGE_NAME_Release64=cutil.tar
+CND_PACKAGE_PATH_Release64=dist/Release64/GNU-Linux/package/cutil.tar
 #
 # include compiler specific variables
 #
@@ -35,171 +35,228 @@ https://rosettacode.org/wiki/AVL_tree
  ******************************************************************************/
 #include "AvlTree.h"
 
-static inline void setParent(AvlTree_Node *node, AvlTree_Node *parent) {
-    assert(((uintptr_t) parent & 3) == 0);
-    node->parent = (node->parent & 3) | (uintptr_t) parent;
+static inline void noUpdate(const AvlTree_Node *sentinel, AvlTree_Node *node) {
 }
 
-static inline void setBalance(AvlTree_Node *node, int balance) {
-    node->parent = (node->parent & ~3) | balance;
-}
+AvlTree_instantiateBalancing(AvlTree, noUpdate)
 
-static void rotateLeft(AvlTree_Node *parent) {
-    AvlTree_Node *child = parent->right;
-    int parentBalance = AvlTree_balanced;
-    int childBalance = AvlTree_balanced;
-    if (AvlTree_getBalance(child) != AvlTree_rightHeavy) {
-        parentBalance = AvlTree_rightHeavy;
-        childBalance = AvlTree_leftHeavy;
-    }
-    child->parent = (uintptr_t) AvlTree_getParent(parent) | childBalance;
-    parent->right = child->left;
-    child->left = parent;
-    parent->parent = (uintptr_t) child | parentBalance;
-    setParent(parent->right, parent);
-    if (AvlTree_getParent(child)->right == parent) AvlTree_getParent(child)->right = child;
-    else AvlTree_getParent(child)->left = child;
+void AvlTree_rebalanceAfterInsertion(AvlTree *tree, AvlTree_Node *node) {
+    AvlTree_rebalanceAfterGrowth(&tree->sentinel, &tree->sentinel, node);
 }
 
-static void rotateRight(AvlTree_Node *parent) {
-    AvlTree_Node *child = parent->left;
-    int parentBalance = AvlTree_balanced;
-    int childBalance = AvlTree_balanced;
-    if (AvlTree_getBalance(child) != AvlTree_leftHeavy) {
-        parentBalance = AvlTree_leftHeavy;
-        childBalance = AvlTree_rightHeavy;
-    }
-    child->parent = (uintptr_t) AvlTree_getParent(parent) | childBalance;
-    parent->left = child->right;
-    child->right = parent;
-    parent->parent = (uintptr_t) child | parentBalance;
-    setParent(parent->left, parent);
-    if (AvlTree_getParent(child)->left == parent) AvlTree_getParent(child)->left = child;
-    else AvlTree_getParent(child)->right = child;
+static inline void updateCount(const AvlTree_Node *sentinel, AvlTree_Node *node) {
+    size_t count = 1;
+    if (node->left != sentinel) count += AvlTreeCounted_getNode(node->left)->count;
+    if (node->right != sentinel) count += AvlTreeCounted_getNode(node->right)->count;
+    AvlTreeCounted_getNode(node)->count = count;
 }
 
-static void rotateLeftRight(AvlTree_Node *parent) {
-    AvlTree_Node *child = parent->left;
-    AvlTree_Node *grandChild = child->right;
-    int parentBalance = AvlTree_balanced;
-    int childBalance = AvlTree_balanced;
-    if (AvlTree_getBalance(grandChild) == AvlTree_rightHeavy) childBalance = AvlTree_leftHeavy;
-    else if (AvlTree_getBalance(grandChild) == AvlTree_leftHeavy) parentBalance = AvlTree_rightHeavy;
-    parent->left = grandChild->right;
-    child->right = grandChild->left;
-    grandChild->right = parent;
-    grandChild->left = child;
-    grandChild->parent = (uintptr_t) AvlTree_getParent(parent) | AvlTree_balanced;
-    parent->parent = (uintptr_t) grandChild | parentBalance;
-    child->parent = (uintptr_t) grandChild | childBalance;
-    setParent(parent->left, parent);
-    setParent(child->right, child);
-    if (parent == AvlTree_getParent(grandChild)->left) AvlTree_getParent(grandChild)->left = grandChild;
-    else AvlTree_getParent(grandChild)->right = grandChild;
-}
+AvlTree_instantiateBalancing(AvlTreeCounted, updateCount)
 
-static void rotateRightLeft(AvlTree_Node *parent) {
-    AvlTree_Node *child = parent->right;
-    AvlTree_Node *grandChild = child->left;
-    int parentBalance = AvlTree_balanced;
-    int childBalance = AvlTree_balanced;
-    if (AvlTree_getBalance(grandChild) == AvlTree_leftHeavy) childBalance = AvlTree_rightHeavy;
-    else if (AvlTree_getBalance(grandChild) == AvlTree_rightHeavy) parentBalance = AvlTree_leftHeavy;
-    parent->right = grandChild->left;
-    child->left = grandChild->right;
-    grandChild->left = parent;
-    grandChild->right = child;
-    grandChild->parent = (uintptr_t) AvlTree_getParent(parent) | AvlTree_balanced;
-    parent->parent = (uintptr_t) grandChild | parentBalance;
-    child->parent = (uintptr_t) grandChild | childBalance;
-    setParent(parent->right, parent);
-    setParent(child->left, child);
-    if (parent == AvlTree_getParent(grandChild)->right) AvlTree_getParent(grandChild)->right = grandChild;
-    else AvlTree_getParent(grandChild)->left = grandChild;
+/**
+ * Recursively links the specified sorted nodes into a perfectly balanced
+ * subtree, returning its root. The left half gets the extra node when
+ * the count is even, thus the resulting subtree has height floor(log2(count)) + 1
+ * and is left heavy if the left half is a power of two larger than the right.
+ */
+static AvlTree_Node *buildFromSorted(AvlTree_Node *sentinel, AvlTree_Node **nodes, size_t count, AvlTree_Node *parent) {
+    if (count == 0) return sentinel;
+    size_t leftCount = count / 2;
+    size_t rightCount = count - 1 - leftCount;
+    AvlTree_Node *node = nodes[leftCount];
+    bool leftHeavy = (leftCount != rightCount) && ((leftCount & (leftCount - 1)) == 0);
+    node->parent = (uintptr_t) parent | (leftHeavy ? AvlTree_leftHeavy : AvlTree_balanced);
+    node->left = buildFromSorted(sentinel, nodes, leftCount, node);
+    node->right = buildFromSorted(sentinel, nodes + leftCount + 1, rightCount, node);
+    return node;
 }
 
-static inline AvlTree_Node *findMin(const AvlTree_Node *sentinel, AvlTree_Node *root) {
-    while (root->left != sentinel) root = root->left;
-    return root;
+/** Subtree of an AVL tree along with its height, used to join and split trees. */
+typedef struct Subtree {
+    AvlTree_Node *root;
+    int height;
+} Subtree;
+
+/** Computes the height of a subtree following the taller child down to a leaf. */
+static int getHeight(const AvlTree_Node *sentinel, const AvlTree_Node *root) {
+    int height = 0;
+    while (root != sentinel) {
+        height++;
+        root = (AvlTree_getBalance(root) == AvlTree_leftHeavy) ? root->left : root->right;
+    }
+    return height;
 }
 
-static inline AvlTree_Node *findMax(const AvlTree_Node *sentinel, AvlTree_Node *root) {
-    while (root->right != sentinel) root = root->right;
-    return root;
+/**
+ * Joins two subtrees using pivot as glue, where nodes in left precede pivot
+ * and nodes in right follow pivot.
+ * If heights differ by more than one, pivot replaces the node on the inner
+ * spine of the taller subtree where heights match, then balance is restored
+ * as after an insertion, thus the cost is proportional to the height difference.
+ * The parent of the resulting root is set to the sentinel.
+ */
+static Subtree join(AvlTree_Node *sentinel, Subtree left, AvlTree_Node *pivot, Subtree right) {
+    Subtree result;
+    if (left.height > right.height + 1) {
+        AvlTree_Node holder = { .left = left.root, .right = sentinel };
+        AvlTree_Node *parent;
+        AvlTree_Node *node = left.root;
+        int height = left.height;
+        while (height > right.height + 1) {
+            height -= (AvlTree_getBalance(node) == AvlTree_leftHeavy) ? 2 : 1;
+            parent = node;
+            node = node->right;
+        }
+        AvlTree_setParent(left.root, &holder);
+        pivot->parent = (uintptr_t) parent | ((height > right.height) ? AvlTree_leftHeavy : AvlTree_balanced);
+        pivot->left = node;
+        pivot->right = right.root;
+        AvlTree_setParent(node, pivot);
+        AvlTree_setParent(right.root, pivot);
+        parent->right = pivot;
+        result.height = left.height + AvlTree_rebalanceAfterGrowth(sentinel, &holder, pivot);
+        result.root = holder.left;
+    } else if (right.height > left.height + 1) {
+        AvlTree_Node holder = { .left = right.root, .right = sentinel };
+        AvlTree_Node *parent;
+        AvlTree_Node *node = right.root;
+        int height = right.height;
+        while (height > left.height + 1) {
+            height -= (AvlTree_getBalance(node) == AvlTree_rightHeavy) ? 2 : 1;
+            parent = node;
+            node = node->left;
+        }
+        AvlTree_setParent(right.root, &holder);
+        pivot->parent = (uintptr_t) parent | ((height > left.height) ? AvlTree_rightHeavy : AvlTree_balanced);
+        pivot->left = left.root;
+        pivot->right = node;
+        AvlTree_setParent(left.root, pivot);
+        AvlTree_setParent(node, pivot);
+        parent->left = pivot;
+        result.height = right.height + AvlTree_rebalanceAfterGrowth(sentinel, &holder, pivot);
+        result.root = holder.left;
+    } else {
+        int balance = AvlTree_balanced;
+        if (left.height > right.height) balance = AvlTree_leftHeavy;
+        else if (right.height > left.height) balance = AvlTree_rightHeavy;
+        pivot->parent = balance;
+        pivot->left = left.root;
+        pivot->right = right.root;
+        AvlTree_setParent(left.root, pivot);
+        AvlTree_setParent(right.root, pivot);
+        result.height = ((left.height > right.height) ? left.height : right.height) + 1;
+        result.root = pivot;
+    }
+    AvlTree_setParent(result.root, sentinel);
+    return result;
 }
 
-void AvlTree_rebalanceAfterInsertion(AvlTree *tree, AvlTree_Node *node) {
-    while (node != tree->sentinel.left) {
-        AvlTree_Node *parent = AvlTree_getParent(node);
-        int balance = AvlTree_getBalance(parent);
-        if (balance == AvlTree_balanced) {
-            setBalance(parent, (node == parent->left) ? AvlTree_leftHeavy : AvlTree_rightHeavy);
-            node = parent;
-        } else if (balance == AvlTree_rightHeavy) {
-            if (node == parent->left) {
-                setBalance(parent, AvlTree_balanced);
-            } else if (AvlTree_getBalance(node) == AvlTree_leftHeavy) {
-                rotateRightLeft(parent);
-            } else {
-                rotateLeft(parent);
-            }
-            break;
+/**
+ * Splits the subtree rooted at root into the nodes preceding node and
+ * the nodes following node, excluding node itself.
+ * Walks up from node to root, joining each ancestor along with its other
+ * subtree to the side it belongs to. Heights of the joined subtrees increase
+ * along the walk, thus the overall cost is logarithmic.
+ * Parents of the resulting roots are set to the sentinel.
+ */
+static void split(AvlTree_Node *sentinel, AvlTree_Node *root, AvlTree_Node *node, Subtree *left, Subtree *right) {
+    int height = getHeight(sentinel, node);
+    int balance = AvlTree_getBalance(node);
+    left->root = node->left;
+    left->height = height - ((balance == AvlTree_rightHeavy) ? 2 : 1);
+    right->root = node->right;
+    right->height = height - ((balance == AvlTree_leftHeavy) ? 2 : 1);
+    AvlTree_Node *current = node;
+    AvlTree_Node *parent = AvlTree_getParent(node);
+    while (current != root) {
+        // Read links of parent before joining overwrites them
+        AvlTree_Node *grandParent = AvlTree_getParent(parent);
+        int parentBalance = AvlTree_getBalance(parent);
+        Subtree sibling;
+        if (current == parent->left) {
+            height += (parentBalance == AvlTree_rightHeavy) ? 2 : 1;
+            sibling.root = parent->right;
+            sibling.height = height - ((parentBalance == AvlTree_leftHeavy) ? 2 : 1);
+            *right = join(sentinel, *right, parent, sibling);
         } else {
-            assert(balance == AvlTree_leftHeavy);
-            if (node == parent->right) {
-                setBalance(parent, AvlTree_balanced);
-            } else if (AvlTree_getBalance(node) == AvlTree_rightHeavy) {
-                rotateLeftRight(parent);
-            } else {
-                rotateRight(parent);
-            }
-            break;
+            height += (parentBalance == AvlTree_leftHeavy) ? 2 : 1;
+            sibling.root = parent->left;
+            sibling.height = height - ((parentBalance == AvlTree_rightHeavy) ? 2 : 1);
+            *left = join(sentinel, sibling, parent, *left);
         }
+        current = parent;
+        parent = grandParent;
     }
+    AvlTree_setParent(left->root, sentinel);
+    AvlTree_setParent(right->root, sentinel);
 }
 
-static void rebalanceAfterDeletion(AvlTree *tree, AvlTree_Node *current, AvlTree_Node *parent) {
-    while (current != tree->sentinel.left) {
-        int balance = AvlTree_getBalance(parent);
-        if (balance == AvlTree_balanced) {
-            setBalance(parent, (current == parent->right) ? AvlTree_leftHeavy : AvlTree_rightHeavy);
-            break;
-        } else if (balance == AvlTree_leftHeavy) {
-            if (current == parent->left) {
-                setBalance(parent, AvlTree_balanced);
-                current = parent;
-            } else {
-                AvlTree_Node *sibling = parent->left;
-                assert(sibling != &tree->sentinel);
-                if (AvlTree_getBalance(sibling) == AvlTree_rightHeavy) {
-                    assert(sibling->right != &tree->sentinel);
-                    rotateLeftRight(parent);
-                } else {
-                    rotateRight(parent);
-                }
-                current = AvlTree_getParent(parent);
-                if (AvlTree_getBalance(current) == AvlTree_rightHeavy) break;
-            }
+/**
+ * Replaces the leaf links of the specified non-empty subtree, moving it
+ * to the tree owning the new sentinel. Visits nodes in order without
+ * recursion, using parent links to climb back.
+ */
+static void relinkLeaves(AvlTree_Node *root, const AvlTree_Node *oldSentinel, AvlTree_Node *newSentinel) {
+    AvlTree_Node *node = root;
+    while (true) {
+        while (node->left != oldSentinel) node = node->left;
+        node->left = newSentinel;
+        while (node->right == oldSentinel) {
+            node->right = newSentinel;
+            AvlTree_Node *child;
+            do {
+                if (node == root) return;
+                child = node;
+                node = AvlTree_getParent(node);
+            } while (node->right == child);
+        }
+        node = node->right;
+    }
+}
+
+/**
+ * Links the nodes of the specified subtree, preceded by first, into a list
+ * in key order using the right links, returning its head.
+ * Visits nodes in reverse order, because finding the predecessor only reads
+ * right links of nodes not yet visited.
+ */
+static AvlTree_Node *makeList(const AvlTree_Node *sentinel, AvlTree_Node *first, AvlTree_Node *root) {
+    AvlTree_Node *head = NULL;
+    AvlTree_Node *node = (root != sentinel) ? AvlTree_findMax(sentinel, root) : root;
+    while (node != sentinel) {
+        AvlTree_Node *prev;
+        if (node->left != sentinel) {
+            prev = AvlTree_findMax(sentinel, node->left);
         } else {
-            assert(balance == AvlTree_rightHeavy);
-            if (current == parent->right) {
-                setBalance(parent, AvlTree_balanced);
-                current = parent;
-            } else {
-                AvlTree_Node *sibling = parent->right;
-                assert(sibling != &tree->sentinel);
-                if (AvlTree_getBalance(sibling) == AvlTree_leftHeavy) {
-                    assert(sibling->left != &tree->sentinel);
-                    rotateRightLeft(parent);
-                } else {
-                    rotateLeft(parent);
-                }
-                current = AvlTree_getParent(parent);
-                if (AvlTree_getBalance(current) == AvlTree_leftHeavy) break;
+            AvlTree_Node *child = node;
+            prev = AvlTree_getParent(node);
+            while (prev != sentinel && child == prev->left) {
+                child = prev;
+                prev = AvlTree_getParent(prev);
             }
         }
-        parent = AvlTree_getParent(current);
-    }    
+        node->right = head;
+        head = node;
+        node = prev;
+    }
+    first->right = head;
+    return first;
+}
+
+/**
+ * Fills the van Emde Boas layout of a frozen tree for the subtree of the
+ * specified height rooted at rootDepth, by splitting it at half its height
+ * and recursing into the top tree and into the bottom trees, all alike.
+ */
+static void splitLevels(AvlTreeFrozen *frozen, unsigned rootDepth, unsigned height) {
+    if (height <= 1) return;
+    unsigned topHeight = height / 2;
+    unsigned depth = rootDepth + topHeight;
+    frozen->levels[depth].topSize = ((size_t) 1 << topHeight) - 1;
+    frozen->levels[depth].bottomSize = ((size_t) 1 << (height - topHeight)) - 1;
+    frozen->levels[depth].topDepth = rootDepth;
+    splitLevels(frozen, rootDepth, topHeight);
+    splitLevels(frozen, depth, height - topHeight);
 }
 
 void AvlTree_initialize(AvlTree *tree) {
@@ -208,54 +265,139 @@ void AvlTree_initialize(AvlTree *tree) {
     tree->sentinel.right = &tree->sentinel;
     tree->leftmost = &tree->sentinel;
     tree->rightmost = &tree->sentinel;
+    #ifdef AVLTREE_STATS
+    tree->stats = (AvlTree_Stats) { 0 };
+    #endif
 }
 
 void AvlTree_remove(AvlTree *tree, AvlTree_Node *node) {
-    if (node->left == &tree->sentinel || node->right == &tree->sentinel) {
-        AvlTree_Node *parent = AvlTree_getParent(node);
-        AvlTree_Node *replacement = (node->left != &tree->sentinel) ? node->left : node->right;
-        setParent(replacement, parent);
-        if (parent->left == node) parent->left = replacement;
-        else parent->right = replacement;
-        if (tree->leftmost == node) {
-            if (node->right == &tree->sentinel) {
-                assert(node->left == &tree->sentinel);
-                tree->leftmost = parent;
-            } else {
-                tree->leftmost = findMin(&tree->sentinel, replacement);
-            }
-        }
-        if (tree->rightmost == node) {
-            if (node->left == &tree->sentinel) {
-                assert(node->right == &tree->sentinel);
-                tree->rightmost = parent;
-            } else {
-                tree->rightmost = findMax(&tree->sentinel, replacement);
-            }
-        }
-        rebalanceAfterDeletion(tree, replacement, parent);
+    AvlTree_unlink(tree, node);
+}
+
+void AvlTree_buildFromSorted(AvlTree *tree, AvlTree_Node **nodes, size_t count) {
+    assert(AvlTree_isEmpty(tree));
+    if (count == 0) return;
+    tree->sentinel.left = buildFromSorted(&tree->sentinel, nodes, count, &tree->sentinel);
+    tree->leftmost = nodes[0];
+    tree->rightmost = nodes[count - 1];
+}
+
+void AvlTree_join(AvlTree *tree, AvlTree_Node *pivot, AvlTree *other) {
+    Subtree left = { tree->sentinel.left, getHeight(&tree->sentinel, tree->sentinel.left) };
+    Subtree right = { &tree->sentinel, 0 };
+    if (!AvlTree_isEmpty(other)) {
+        right.root = other->sentinel.left;
+        right.height = getHeight(&other->sentinel, right.root);
+        relinkLeaves(right.root, &other->sentinel, &tree->sentinel);
+    }
+    if (AvlTree_isEmpty(tree)) tree->leftmost = pivot;
+    tree->rightmost = AvlTree_isEmpty(other) ? pivot : other->rightmost;
+    tree->sentinel.left = join(&tree->sentinel, left, pivot, right).root;
+    AvlTree_initialize(other);
+}
+
+void AvlTree_split(AvlTree *tree, AvlTree_Node *node, AvlTree *other) {
+    assert(AvlTree_isEmpty(other));
+    Subtree left;
+    Subtree right;
+    split(&tree->sentinel, tree->sentinel.left, node, &left, &right);
+    Subtree empty = { &tree->sentinel, 0 };
+    right = join(&tree->sentinel, empty, node, right);
+    relinkLeaves(right.root, &tree->sentinel, &other->sentinel);
+    AvlTree_setParent(right.root, &other->sentinel);
+    other->sentinel.left = right.root;
+    other->leftmost = node;
+    other->rightmost = tree->rightmost;
+    tree->sentinel.left = left.root;
+    if (left.root != &tree->sentinel) {
+        tree->rightmost = AvlTree_findMax(&tree->sentinel, left.root);
     } else {
-        assert(node != tree->leftmost);
-        assert(node != tree->rightmost);
-        AvlTree_Node *successor = findMin(&tree->sentinel, node->right);
-        AvlTree_Node *replacement = successor->right;
-        AvlTree_Node *replacementParent;
-        setParent(node->left, successor);
-        successor->left = node->left;
-        if (successor != node->right) {
-            replacementParent = AvlTree_getParent(successor);
-            AvlTree_Node* successorParent = AvlTree_getParent(successor);
-            setParent(replacement, successorParent);
-            successorParent->left = replacement;
-            successor->right = node->right;
-            setParent(node->right, successor);
+        tree->leftmost = &tree->sentinel;
+        tree->rightmost = &tree->sentinel;
+    }
+}
+
+AvlTree_Node *AvlTree_removeRange(AvlTree *tree, AvlTree_Node *first, AvlTree_Node *end) {
+    if (first == end) return NULL;
+    AvlTree_Node *leftmost = (first == tree->leftmost) ? end : tree->leftmost;
+    AvlTree_Node *rightmost = (end == &tree->sentinel) ? AvlTree_prev(tree, first) : tree->rightmost;
+    Subtree left;
+    Subtree right;
+    Subtree removed;
+    split(&tree->sentinel, tree->sentinel.left, first, &left, &right);
+    if (end != &tree->sentinel) {
+        split(&tree->sentinel, right.root, end, &removed, &right);
+        left = join(&tree->sentinel, left, end, right);
+    } else {
+        removed = right;
+    }
+    tree->sentinel.left = left.root;
+    tree->leftmost = leftmost;
+    tree->rightmost = rightmost;
+    return makeList(&tree->sentinel, first, removed.root);
+}
+
+void AvlTreeFrozen_initialize(AvlTreeFrozen *frozen, const AvlTree *tree) {
+    size_t count = 0;
+    for (const AvlTree_Node *node = tree->leftmost; node != &tree->sentinel; node = AvlTree_next(tree, node)) {
+        count++;
+    }
+    unsigned height = 0;
+    while (height < AvlTreeFrozen_maxHeight && (count >> height) != 0) height++;
+    assert(height < AvlTreeFrozen_maxHeight);
+    frozen->count = count;
+    frozen->slotCount = ((size_t) 1 << height) - 1;
+    frozen->levels[0].topSize = 0;
+    frozen->levels[0].bottomSize = 0;
+    frozen->levels[0].topDepth = 0;
+    splitLevels(frozen, 0, height);
+}
+
+size_t AvlTreeFrozen_getSlot(const AvlTreeFrozen *frozen, size_t index) {
+    assert(index >= 1 && index <= frozen->count);
+    size_t slots[AvlTreeFrozen_maxHeight];
+    unsigned height = 0;
+    while ((index >> height) > 1) height++;
+    slots[0] = 0;
+    for (unsigned depth = 1; depth <= height; depth++) {
+        size_t i = index >> (height - depth);
+        size_t topSize = frozen->levels[depth].topSize;
+        slots[depth] = slots[frozen->levels[depth].topDepth] + topSize + (i & topSize) * frozen->levels[depth].bottomSize;
+    }
+    return slots[height];
+}
+
+void AvlTreeCounted_rebalanceAfterInsertion(AvlTree *tree, AvlTree_Node *node) {
+    AvlTreeCounted_updatePath(&tree->sentinel, AvlTree_getParent(node));
+    AvlTreeCounted_rebalanceAfterGrowth(&tree->sentinel, &tree->sentinel, node);
+}
+
+void AvlTreeCounted_remove(AvlTree *tree, AvlTree_Node *node) {
+    AvlTreeCounted_updatePath(&tree->sentinel, AvlTreeCounted_unlink(tree, node));
+}
+
+AvlTree_Node *AvlTreeCounted_select(AvlTree *tree, size_t index) {
+    AvlTree_Node *node = tree->sentinel.left;
+    while (node != &tree->sentinel) {
+        size_t leftCount = AvlTreeCounted_getCount(tree, node->left);
+        if (index < leftCount) {
+            node = node->left;
+        } else if (index > leftCount) {
+            index -= leftCount + 1;
+            node = node->right;
         } else {
-            replacementParent = successor;
+            break;
         }
-        AvlTree_Node* parent = AvlTree_getParent(node);
-        successor->parent = node->parent; // both same parent and balance factor
-        if (parent->left == node) parent->left = successor;
-        else parent->right = successor;
-        rebalanceAfterDeletion(tree, replacement, replacementParent);
     }
+    return node;
+}
+
+size_t AvlTreeCounted_getRank(const AvlTree *tree, const AvlTree_Node *node) {
+    size_t rank = AvlTreeCounted_getCount(tree, node->left);
+    while (node != tree->sentinel.left) {
+        const AvlTree_Node *parent = AvlTree_getParent(node);
+        if (node == parent->right) rank += AvlTreeCounted_getCount(tree, parent->left) + 1;
+        node = parent;
+    }
+    return rank;
 }
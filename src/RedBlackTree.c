@@ -46,222 +46,197 @@ modified is included with the above copyright notice.
  ******************************************************************************/
 #include "RedBlackTree.h"
 
-static inline RedBlackTree_Node *getParent(const RedBlackTree_Node *node) {
-    return (RedBlackTree_Node *) (node->parent & ~1);
+static inline void noUpdate(RedBlackTree_Node *node) {
 }
 
-static inline bool isBlack(const RedBlackTree_Node *node) {
-    assert(RedBlackTree_black == 1);
-    return node->parent & 1;
+RedBlackTree_instantiateBalancing(RedBlackTree, noUpdate)
+
+/**
+ * Recursively links the specified sorted nodes into a perfectly balanced
+ * subtree, returning its root. The left half gets the extra node when
+ * the count is even, thus all leaves lie at depth redDepth or one more.
+ * Nodes at redDepth are colored red and all others black, so that paths
+ * ending on either depth cross the same count of black nodes.
+ */
+static RedBlackTree_Node *buildFromSorted(RedBlackTree_Node **nodes, size_t count, RedBlackTree_Node *parent, unsigned depth, unsigned redDepth) {
+    if (count == 0) return NULL;
+    size_t leftCount = count / 2;
+    size_t rightCount = count - 1 - leftCount;
+    RedBlackTree_Node *node = nodes[leftCount];
+    node->parent = (uintptr_t) parent | ((depth == redDepth) ? RedBlackTree_red : RedBlackTree_black);
+    node->left = buildFromSorted(nodes, leftCount, node, depth + 1, redDepth);
+    node->right = buildFromSorted(nodes + leftCount + 1, rightCount, node, depth + 1, redDepth);
+    return node;
 }
 
-static inline bool isRed(const RedBlackTree_Node *node) {
-    assert(RedBlackTree_black == 0);
-    return !isBlack(node);
-}
-
-static inline void setBlack(RedBlackTree_Node *node) {
-    node->parent |= 1;
+/** Subtree of a red-black tree with a black root along with its black height, used to join and split trees. */
+typedef struct Subtree {
+    RedBlackTree_Node *root;
+    int blackHeight;
+} Subtree;
+
+/** Computes the count of black nodes on any path from the specified node down to a leaf, the node included. */
+static int getBlackHeight(const RedBlackTree_Node *root) {
+    int blackHeight = 0;
+    while (root != NULL) {
+        if (RedBlackTree_isBlack(root)) blackHeight++;
+        root = root->left;
+    }
+    return blackHeight;
 }
 
-static inline void setRed(RedBlackTree_Node *node) {
-    node->parent &= ~1;
+/** Makes a subtree root black if it is red, as required to join it, adjusting its black height. */
+static Subtree makeBlackRoot(RedBlackTree_Node *root, int blackHeight) {
+    Subtree result = { root, blackHeight };
+    if (root != NULL && RedBlackTree_isRed(root)) {
+        RedBlackTree_setBlack(root);
+        result.blackHeight++;
+    }
+    return result;
 }
 
-static inline void setColor(RedBlackTree_Node *node, RedBlackTree_Color color) {
-    node->parent = (node->parent & ~1) | color;
+/**
+ * Joins two subtrees using pivot as glue, where nodes in left precede pivot
+ * and nodes in right follow pivot.
+ * If black heights differ, pivot is colored red and replaces the black node
+ * on the inner spine of the taller subtree where black heights match, then
+ * colors are fixed as after an insertion, thus the cost is proportional to
+ * the black height difference. A holder node above the taller root stops
+ * the fix up before recoloring that root, so that the caller can tell whether
+ * the black height grew. The parent of the resulting root is set to NULL.
+ */
+static Subtree join(Subtree left, RedBlackTree_Node *pivot, Subtree right) {
+    Subtree result;
+    if (left.blackHeight != right.blackHeight) {
+        RedBlackTree_Node holder = { .parent = RedBlackTree_black, .right = NULL };
+        RedBlackTree temp = { .root = &holder };
+        RedBlackTree_Node *parent = &holder;
+        if (left.blackHeight > right.blackHeight) {
+            RedBlackTree_Node *node = left.root;
+            int blackHeight = left.blackHeight;
+            while (node != NULL && (RedBlackTree_isRed(node) || blackHeight > right.blackHeight)) {
+                if (RedBlackTree_isBlack(node)) blackHeight--;
+                parent = node;
+                node = node->right;
+            }
+            holder.left = left.root;
+            RedBlackTree_setParent(left.root, &holder);
+            pivot->left = node;
+            pivot->right = right.root;
+            parent->right = pivot;
+            result.blackHeight = left.blackHeight;
+        } else {
+            RedBlackTree_Node *node = right.root;
+            int blackHeight = right.blackHeight;
+            while (node != NULL && (RedBlackTree_isRed(node) || blackHeight > left.blackHeight)) {
+                if (RedBlackTree_isBlack(node)) blackHeight--;
+                parent = node;
+                node = node->left;
+            }
+            holder.left = right.root;
+            RedBlackTree_setParent(right.root, &holder);
+            pivot->left = left.root;
+            pivot->right = node;
+            parent->left = pivot;
+            result.blackHeight = right.blackHeight;
+        }
+        pivot->parent = (uintptr_t) parent;
+        if (pivot->left != NULL) RedBlackTree_setParent(pivot->left, pivot);
+        if (pivot->right != NULL) RedBlackTree_setParent(pivot->right, pivot);
+        RedBlackTree_rebalanceAfterInsertion(&temp, pivot);
+        result.root = holder.left;
+        if (RedBlackTree_isRed(result.root)) {
+            RedBlackTree_setBlack(result.root);
+            result.blackHeight++;
+        }
+    } else {
+        pivot->parent = RedBlackTree_black;
+        pivot->left = left.root;
+        pivot->right = right.root;
+        if (left.root != NULL) RedBlackTree_setParent(left.root, pivot);
+        if (right.root != NULL) RedBlackTree_setParent(right.root, pivot);
+        result.root = pivot;
+        result.blackHeight = left.blackHeight + 1;
+    }
+    RedBlackTree_setParent(result.root, NULL);
+    return result;
 }
 
-static void rotateLeft(RedBlackTree *tree, RedBlackTree_Node *parent) {
-    RedBlackTree_Node *child = parent->right;
-    RedBlackTree_setParent(child, getParent(parent));
-    parent->right = child->left;
-    child->left = parent;
-    RedBlackTree_setParent(parent, child);
-    if (parent->right != NULL) RedBlackTree_setParent(parent->right, parent);
-    if (parent == tree->root) tree->root = child;
-    else if (getParent(child)->right == parent) getParent(child)->right = child;
-    else getParent(child)->left = child;
+/**
+ * Splits the subtree rooted at root into the nodes preceding node and
+ * the nodes following node, excluding node itself.
+ * Walks up from node to root, joining each ancestor along with its other
+ * subtree to the side it belongs to. Black heights of the joined subtrees
+ * increase along the walk, thus the overall cost is logarithmic.
+ * Parents of the resulting roots are set to NULL.
+ */
+static void split(RedBlackTree_Node *root, RedBlackTree_Node *node, Subtree *left, Subtree *right) {
+    int blackHeight = getBlackHeight(node);
+    int childBlackHeight = blackHeight - (RedBlackTree_isBlack(node) ? 1 : 0);
+    *left = makeBlackRoot(node->left, childBlackHeight);
+    *right = makeBlackRoot(node->right, childBlackHeight);
+    if (left->root != NULL) RedBlackTree_setParent(left->root, NULL);
+    if (right->root != NULL) RedBlackTree_setParent(right->root, NULL);
+    RedBlackTree_Node *current = node;
+    RedBlackTree_Node *parent = RedBlackTree_getParent(node);
+    while (current != root) {
+        // Read links and color of parent before joining overwrites them
+        RedBlackTree_Node *grandParent = RedBlackTree_getParent(parent);
+        bool parentBlack = RedBlackTree_isBlack(parent);
+        if (current == parent->left) {
+            Subtree sibling = makeBlackRoot(parent->right, blackHeight);
+            *right = join(*right, parent, sibling);
+        } else {
+            Subtree sibling = makeBlackRoot(parent->left, blackHeight);
+            *left = join(sibling, parent, *left);
+        }
+        if (parentBlack) blackHeight++;
+        current = parent;
+        parent = grandParent;
+    }
 }
 
-static void rotateRight(RedBlackTree *tree, RedBlackTree_Node *parent) {
-    RedBlackTree_Node *child = parent->left;
-    RedBlackTree_setParent(child, getParent(parent));
-    parent->left = child->right;
-    child->right = parent;
-    RedBlackTree_setParent(parent, child);
-    if (parent->left != NULL) RedBlackTree_setParent(parent->left, parent);
-    if (parent == tree->root) tree->root = child;
-    else if (getParent(child)->left == parent) getParent(child)->left = child;
-    else getParent(child)->right = child;
+void RedBlackTree_postInsert(RedBlackTree *tree, RedBlackTree_Node *node) {
+    RedBlackTree_rebalanceAfterInsertion(tree, node);
 }
 
-static inline RedBlackTree_Node *findMin(RedBlackTree_Node *root) {
-    while (root->left != NULL) root = root->left;
-    return root;
+void RedBlackTree_remove(RedBlackTree *tree, RedBlackTree_Node *node) {
+    RedBlackTree_unlink(tree, node);
 }
 
-static inline RedBlackTree_Node *findMax(RedBlackTree_Node *root) {
-    while (root->right != NULL) root = root->right;
-    return root;
+void RedBlackTree_buildFromSorted(RedBlackTree *tree, RedBlackTree_Node **nodes, size_t count) {
+    assert(RedBlackTree_isEmpty(tree));
+    if (count == 0) return;
+    unsigned redDepth = 0;
+    while (((size_t) 2 << redDepth) <= count) redDepth++;
+    tree->root = buildFromSorted(nodes, count, NULL, 0, (redDepth > 0) ? redDepth : 1);
+    tree->leftmost = nodes[0];
+    tree->rightmost = nodes[count - 1];
 }
 
-void RedBlackTree_postInsert(RedBlackTree *tree, RedBlackTree_Node *node) {
-    setRed(node);
-    while (true) {
-        RedBlackTree_Node *parent = getParent(node);
-        if (node == tree->root || isBlack(parent)) {
-            break;
-        }
-        RedBlackTree_Node *grandParent = getParent(parent);
-        assert(grandParent != NULL);
-        if (parent == grandParent->left) {
-            RedBlackTree_Node *uncle = grandParent->right;
-            if (uncle != NULL && isRed(uncle)) {
-                setBlack(parent);
-                setBlack(uncle);
-                setRed(grandParent);
-                node = grandParent;
-            } else {
-                if (node == parent->right) {
-                    node = parent;
-                    rotateLeft(tree, node);
-                    parent = getParent(node);
-                    grandParent = getParent(parent);
-                }
-                setBlack(parent);
-                setRed(grandParent);
-                rotateRight(tree, grandParent);
-            }
-        } else {
-            RedBlackTree_Node *uncle = grandParent->left;
-            if (uncle != NULL && isRed(uncle)) {
-                setBlack(parent);
-                setBlack(uncle);
-                setRed(grandParent);
-                node = grandParent;
-            } else {
-                if (node == parent->left) {
-                    node = parent;
-                    rotateRight(tree, node);
-                    parent = getParent(node);
-                    grandParent = getParent(parent);
-                }
-                setBlack(parent);
-                setRed(grandParent);
-                rotateLeft(tree, grandParent);
-            }
-        }
-    }
-    setBlack(tree->root);
+void RedBlackTree_join(RedBlackTree *tree, RedBlackTree_Node *pivot, RedBlackTree *other) {
+    Subtree left = { tree->root, getBlackHeight(tree->root) };
+    Subtree right = { other->root, getBlackHeight(other->root) };
+    if (RedBlackTree_isEmpty(tree)) tree->leftmost = pivot;
+    tree->rightmost = RedBlackTree_isEmpty(other) ? pivot : other->rightmost;
+    tree->root = join(left, pivot, right).root;
+    RedBlackTree_initialize(other);
 }
 
-void RedBlackTree_remove(RedBlackTree *tree, RedBlackTree_Node *node) {
-    RedBlackTree_Node *successor = NULL; // becomes not null if node has two children
-    RedBlackTree_Node *x = NULL;
-    RedBlackTree_Node *xParent = NULL;
-    if (node->left == NULL) x = node->right;
-    else if (node->right == NULL) x = node->left;
-    else {
-        successor = findMin(node->right);
-        x = successor->right;
-    }
-    RedBlackTree_Node *zp = getParent(node);
-    if (successor != NULL) {
-        RedBlackTree_setParent(node->left, successor);
-        successor->left = node->left;
-        if (successor != node->right) {
-            xParent = getParent(successor);
-            if (x != NULL) RedBlackTree_setParent(x, getParent(successor));
-            getParent(successor)->left = x;
-            successor->right = node->right;
-            RedBlackTree_setParent(node->right, successor);
-        } else {
-            xParent = successor;
-        }
-        if (tree->root == node) tree->root = successor;
-        else if (zp->left == node) zp->left = successor;
-        else zp->right = successor;
-        bool yBlack = isBlack(successor);
-        successor->parent = node->parent; // both same parent and color
-        setColor(node, yBlack);
+void RedBlackTree_split(RedBlackTree *tree, RedBlackTree_Node *node, RedBlackTree *other) {
+    assert(RedBlackTree_isEmpty(other));
+    Subtree left;
+    Subtree right;
+    split(tree->root, node, &left, &right);
+    Subtree empty = { NULL, 0 };
+    other->root = join(empty, node, right).root;
+    other->leftmost = node;
+    other->rightmost = tree->rightmost;
+    tree->root = left.root;
+    if (left.root != NULL) {
+        tree->rightmost = RedBlackTree_findMax(left.root);
     } else {
-        xParent = getParent(node);
-        if (x != NULL) RedBlackTree_setParent(x, getParent(node));
-        if (tree->root == node) tree->root = x;
-        else if (zp->left == node) zp->left = x;
-        else zp->right = x;
-        if (tree->leftmost == node) {
-            if (node->right == NULL) {
-                assert(node->left == NULL);
-                tree->leftmost = zp;
-            } else {
-                tree->leftmost = findMin(x);
-            }
-        }
-        if (tree->rightmost == node) {
-            if (node->left == NULL) {
-                assert(node->right == NULL);
-                tree->rightmost = zp;
-            } else {
-                tree->rightmost = findMax(x);
-            }
-        }
-    }
-    // Balance
-    if (isRed(node)) return;
-    while (x != tree->root && (x == NULL || isBlack(x))) {
-        if (x == xParent->left) {
-            RedBlackTree_Node *w = xParent->right;
-            if (isRed(w)) {
-                setBlack(w);
-                setRed(xParent);
-                rotateLeft(tree, xParent);
-                w = xParent->right;
-            }
-            if (((w->left == NULL) || isBlack(w->left)) && ((w->right == NULL) || isBlack(w->right))) {
-                setRed(w);
-                x = xParent;
-                xParent = getParent(xParent);
-            } else {
-                if ((w->right == NULL) || isBlack(w->right)) {
-                    if (w->left != NULL) setBlack(w->left);
-                    setRed(w);
-                    rotateRight(tree, w);
-                    w = xParent->right;
-                }
-                setColor(w, isBlack(xParent));
-                setBlack(xParent);
-                if (w->right != NULL) setBlack(w->right);
-                rotateLeft(tree, xParent);
-                break;
-            }
-        } else {
-            RedBlackTree_Node *w = xParent->left;
-            if (isRed(w)) {
-                setBlack(w);
-                setRed(xParent);
-                rotateRight(tree, xParent);
-                w = xParent->left;
-            }
-            if (((w->right == NULL) || isBlack(w->right)) && ((w->left == NULL) || isBlack(w->left))) {
-                setRed(w);
-                x = xParent;
-                xParent = getParent(xParent);
-            } else {
-                if ((w->left == NULL) || isBlack(w->left)) {
-                    if (w->right != NULL) setBlack(w->right);
-                    setRed(w);
-                    rotateLeft(tree, w);
-                    w = xParent->left;
-                }
-                setColor(w, isBlack(xParent));
-                setBlack(xParent);
-                if (w->left != NULL) setBlack(w->left);
-                rotateRight(tree, xParent);
-                break;
-            }
-        }
+        tree->leftmost = NULL;
+        tree->rightmost = NULL;
     }
-    if (x != NULL) setBlack(x);
 }
@@ -51,6 +51,34 @@ static inline bool Value_isLess(AvlTree_Node *node, AvlTree_Node *other) {
 }
 
 AvlTree_instantiateInsert(TestAvlTree_insert, Value_isLess);
+AvlTree_instantiateBuild(TestAvlTree_build, Value_isLess);
+AvlTree_instantiateSplit(TestAvlTree_split, Value_isLess);
+AvlTree_instantiateFind(TestAvlTree_find, Value_isLess);
+AvlTree_instantiateLowerBound(TestAvlTree_lowerBound, Value_isLess);
+AvlTree_instantiateUpperBound(TestAvlTree_upperBound, Value_isLess);
+AvlTree_instantiateRemoveRange(TestAvlTree_removeRange, Value_isLess);
+
+static void sumKeys(AvlTree_Node *node, void *context) {
+    *(uint64_t *) context += Value_fromNode(node)->key;
+}
+
+AvlTree_instantiateVisitRange(TestAvlTree_sumRange, Value_isLess, sumKeys);
+
+typedef struct FrozenItem {
+    uint64_t key;
+    Value *value;
+} FrozenItem;
+
+static inline void FrozenItem_copy(FrozenItem *item, AvlTree_Node *node) {
+    item->value = Value_fromNode(node);
+    item->key = item->value->key;
+}
+
+static inline bool FrozenItem_isLess(const FrozenItem *item, const FrozenItem *other) {
+    return item->key < other->key;
+}
+
+AvlTree_instantiateFreeze(TestAvlTree_frozen, FrozenItem, FrozenItem_copy, FrozenItem_isLess);
 
 static uint64_t nextKey = 0;
 
@@ -74,6 +102,12 @@ static Value *createValues(size_t nodeCount) {
 }
 
 #ifndef NDEBUG
+static int compareValuePointers(const void *a, const void *b) {
+    uint64_t x = (*(const Value **) a)->key;
+    uint64_t y = (*(const Value **) b)->key;
+    return (x > y) - (x < y);
+}
+
 static bool isPresent(Value **arr, size_t size, Value *node) {
     for (size_t i = 0; i < size; ++i) {
         if (arr[i] == node) return true;
@@ -81,6 +115,133 @@ static bool isPresent(Value **arr, size_t size, Value *node) {
     return false;
 }
 
+/** Checks links, ordering and balance factors of a subtree, returning its height. */
+static int checkSubtree(AvlTree *tree, AvlTree_Node *node, AvlTree_Node *parent) {
+    if (node == &tree->sentinel) return 0;
+    assert(AvlTree_getParent(node) == parent);
+    if (node->left != &tree->sentinel) assert(!Value_isLess(node, node->left));
+    if (node->right != &tree->sentinel) assert(!Value_isLess(node->right, node));
+    int leftHeight = checkSubtree(tree, node->left, node);
+    int rightHeight = checkSubtree(tree, node->right, node);
+    switch (AvlTree_getBalance(node)) {
+        case AvlTree_balanced: assert(leftHeight == rightHeight); break;
+        case AvlTree_leftHeavy: assert(leftHeight == rightHeight + 1); break;
+        case AvlTree_rightHeavy: assert(rightHeight == leftHeight + 1); break;
+        default: assert(false);
+    }
+    return ((leftHeight > rightHeight) ? leftHeight : rightHeight) + 1;
+}
+
+static void checkTree(AvlTree *tree) {
+    checkSubtree(tree, tree->sentinel.left, &tree->sentinel);
+    if (!AvlTree_isEmpty(tree)) {
+        AvlTree_Node *n = tree->sentinel.left;
+        while (n->left != &tree->sentinel) n = n->left;
+        assert(tree->leftmost == n);
+        n = tree->sentinel.left;
+        while (n->right != &tree->sentinel) n = n->right;
+        assert(tree->rightmost == n);
+    } else {
+        assert(tree->leftmost == &tree->sentinel);
+        assert(tree->rightmost == &tree->sentinel);
+    }
+}
+
+static void testSplitJoinConsistency(size_t nodeCount) {
+    Value *values = createValues(nodeCount);
+    AvlTree tree;
+    AvlTree other;
+    AvlTree_initialize(&tree);
+    AvlTree_initialize(&other);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestAvlTree_insert(&tree, &values[i].node);
+    }
+    checkTree(&tree);
+    for (size_t r = 0; r < 100; ++r) {
+        // Split by a random key and rejoin using the minimum of the right part as pivot
+        Value key;
+        randomizeKey(&key);
+        TestAvlTree_split(&tree, &key.node, &other);
+        checkTree(&tree);
+        checkTree(&other);
+        if (!AvlTree_isEmpty(&tree)) assert(Value_isLess(tree.rightmost, &key.node));
+        if (!AvlTree_isEmpty(&other)) {
+            assert(!Value_isLess(other.leftmost, &key.node));
+            AvlTree_Node *pivot = other.leftmost;
+            AvlTree_remove(&other, pivot);
+            AvlTree_join(&tree, pivot, &other);
+        }
+        checkTree(&tree);
+        assert(AvlTree_isEmpty(&other));
+        // Split by a random node and rejoin
+        AvlTree_Node *node = &values[lrand48() % nodeCount].node;
+        AvlTree_split(&tree, node, &other);
+        checkTree(&tree);
+        checkTree(&other);
+        assert(other.leftmost == node);
+        AvlTree_remove(&other, node);
+        AvlTree_join(&tree, node, &other);
+        checkTree(&tree);
+        assert(AvlTree_isEmpty(&other));
+    }
+    size_t count = 0;
+    while (!AvlTree_isEmpty(&tree)) {
+        AvlTree_remove(&tree, tree.leftmost);
+        count++;
+    }
+    assert(count == nodeCount);
+    free(values);
+}
+
+static void testRemoveRangeConsistency(size_t nodeCount) {
+    Value *values = createValues(nodeCount);
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestAvlTree_insert(&tree, &values[i].node);
+    }
+    size_t count = nodeCount;
+    for (size_t r = 0; r < 100 && count > 0; ++r) {
+        // Remove the range between two random keys, then insert the removed nodes back
+        Value lo;
+        Value hi;
+        randomizeKey(&lo);
+        randomizeKey(&hi);
+        if (r % 10 == 0) lo.key = 0;
+        if (r % 10 == 1) hi.key = UINT64_MAX;
+        size_t inRange = 0;
+        for (AvlTree_Node *node = tree.leftmost; node != &tree.sentinel; node = AvlTree_next(&tree, node)) {
+            if (!Value_isLess(node, &lo.node) && Value_isLess(node, &hi.node)) inRange++;
+        }
+        AvlTree_Node *removed = TestAvlTree_removeRange(&tree, &lo.node, &hi.node);
+        checkTree(&tree);
+        size_t removedCount = 0;
+        for (AvlTree_Node *node = removed; node != NULL; node = node->right) {
+            assert(!Value_isLess(node, &lo.node) && Value_isLess(node, &hi.node));
+            assert(node->right == NULL || !Value_isLess(node->right, node));
+            removedCount++;
+        }
+        assert(removedCount == inRange);
+        if (r % 2 == 0) {
+            while (removed != NULL) {
+                AvlTree_Node *next = removed->right;
+                TestAvlTree_insert(&tree, removed);
+                removed = next;
+            }
+            checkTree(&tree);
+        } else {
+            count -= removedCount;
+        }
+    }
+    size_t remaining = 0;
+    while (!AvlTree_isEmpty(&tree)) {
+        AvlTree_remove(&tree, tree.leftmost);
+        remaining++;
+    }
+    assert(remaining == count);
+    free(values);
+}
+
 static void testConsistency(size_t nodeCount) {
     Value **seenValues = malloc(nodeCount * sizeof(Value *));
     size_t seenValuesSize;
@@ -117,11 +278,170 @@ static void testConsistency(size_t nodeCount) {
         printf("Removed %zu: %016" PRIX64 "\n", i, values[i].key);
     }
     assert(AvlTree_isEmpty(&tree));
+    // Test bulk construction
+    AvlTree_Node **nodes = malloc(nodeCount * sizeof(AvlTree_Node *));
+    for (size_t i = 0; i < nodeCount; ++i) {
+        nodes[i] = &values[i].node;
+    }
+    TestAvlTree_build(&tree, nodes, nodeCount);
+    seenValuesSize = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        assert(!AvlTree_isEmpty(&tree));
+        Value *value = Value_fromNode(tree.leftmost);
+        AvlTree_remove(&tree, &value->node);
+        assert(!isPresent(seenValues, seenValuesSize, value));
+        seenValues[seenValuesSize] = value;
+        seenValuesSize++;
+        printf("Built and polled %zu: %016" PRIX64 "\n", i, value->key);
+        assert(i == 0 || seenValues[i - 1]->key  <= seenValues[i]->key);
+    }
+    assert(AvlTree_isEmpty(&tree));
+    free(nodes);
     free(seenValues);
     free(values);
 }
+static void testLookupConsistency(size_t nodeCount) {
+    Value *values = createValues(nodeCount);
+    Value **sorted = malloc(nodeCount * sizeof(Value *));
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestAvlTree_insert(&tree, &values[i].node);
+        sorted[i] = &values[i];
+    }
+    qsort(sorted, nodeCount, sizeof(Value *), compareValuePointers);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        Value key = { .key = sorted[i]->key };
+        assert(Value_fromNode(TestAvlTree_find(&tree, &key.node))->key == key.key);
+        assert(Value_fromNode(TestAvlTree_lowerBound(&tree, &key.node))->key == key.key);
+        AvlTree_Node *upper = TestAvlTree_upperBound(&tree, &key.node);
+        assert(upper == &tree.sentinel || Value_fromNode(upper)->key > key.key);
+        if (key.key == UINT64_MAX) continue;
+        key.key++;
+        AvlTree_Node *lower = TestAvlTree_lowerBound(&tree, &key.node);
+        if (i + 1 < nodeCount && sorted[i + 1]->key == key.key) {
+            assert(lower == &sorted[i + 1]->node);
+        } else {
+            assert(TestAvlTree_find(&tree, &key.node) == &tree.sentinel);
+            assert(lower == (i + 1 < nodeCount ? &sorted[i + 1]->node : &tree.sentinel));
+        }
+    }
+    free(sorted);
+    free(values);
+}
+static void testFrozenLookupConsistency(size_t nodeCount) {
+    Value *values = createValues(nodeCount);
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestAvlTree_insert(&tree, &values[i].node);
+    }
+    AvlTreeFrozen frozen;
+    AvlTreeFrozen_initialize(&frozen, &tree);
+    assert(frozen.count == nodeCount);
+    assert(frozen.slotCount < 2 * nodeCount);
+    FrozenItem *items = malloc(frozen.slotCount * sizeof(FrozenItem));
+    TestAvlTree_frozen_freeze(&frozen, &tree, items);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        FrozenItem key = { .key = values[i].key };
+        const FrozenItem *found = TestAvlTree_frozen_find(&frozen, items, &key);
+        assert(found != NULL && found->key == key.key && found->value->key == key.key);
+        if (key.key == UINT64_MAX) continue;
+        key.key++;
+        Value probe = { .key = key.key };
+        AvlTree_Node *lower = TestAvlTree_lowerBound(&tree, &probe.node);
+        found = TestAvlTree_frozen_lowerBound(&frozen, items, &key);
+        assert(lower == &tree.sentinel ? found == NULL : found->value == Value_fromNode(lower));
+    }
+    // The live tree keeps working and can be frozen again
+    for (size_t i = 0; i < nodeCount; i += 2) {
+        AvlTree_remove(&tree, &values[i].node);
+    }
+    AvlTreeFrozen_initialize(&frozen, &tree);
+    assert(frozen.count == nodeCount / 2);
+    TestAvlTree_frozen_freeze(&frozen, &tree, items);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        FrozenItem key = { .key = values[i].key };
+        Value probe = { .key = key.key };
+        AvlTree_Node *found = TestAvlTree_find(&tree, &probe.node);
+        assert((TestAvlTree_frozen_find(&frozen, items, &key) == NULL) == (found == &tree.sentinel));
+    }
+    free(items);
+    free(values);
+}
+static void testIterationConsistency(size_t nodeCount) {
+    Value *values = createValues(nodeCount);
+    Value **sorted = malloc(nodeCount * sizeof(Value *));
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestAvlTree_insert(&tree, &values[i].node);
+        sorted[i] = &values[i];
+    }
+    qsort(sorted, nodeCount, sizeof(Value *), compareValuePointers);
+    // Full scans in both directions
+    AvlTree_Node *node = tree.leftmost;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        assert(Value_fromNode(node)->key == sorted[i]->key);
+        node = AvlTree_next(&tree, node);
+    }
+    assert(node == &tree.sentinel);
+    node = tree.rightmost;
+    for (size_t i = nodeCount; i-- > 0;) {
+        assert(Value_fromNode(node)->key == sorted[i]->key);
+        node = AvlTree_prev(&tree, node);
+    }
+    assert(node == &tree.sentinel);
+    // Range visits between the keys of random positions
+    for (size_t r = 0; r < 100; ++r) {
+        size_t first = lrand48() % nodeCount;
+        size_t last = first + lrand48() % (nodeCount - first);
+        Value lo = { .key = sorted[first]->key };
+        Value hi = { .key = sorted[last]->key };
+        uint64_t expected = 0;
+        for (size_t i = 0; i < nodeCount; ++i) {
+            if (sorted[i]->key >= lo.key && sorted[i]->key < hi.key) expected += sorted[i]->key;
+        }
+        uint64_t sum = 0;
+        TestAvlTree_sumRange(&tree, &lo.node, &hi.node, &sum);
+        assert(sum == expected);
+    }
+    free(sorted);
+    free(values);
+}
+
 #endif
 
+/**
+ * Header and row suffix with the counters of a tree per operation, printed
+ * only if AVLTREE_STATS is defined: nodes visited descending per insertion,
+ * rotations per insertion or removal, rebalancing steps per insertion
+ * and per removal.
+ */
+#ifdef AVLTREE_STATS
+#define STATS_HEADER ",Descent,Rotations,Ins. rebalance,Rem. rebalance"
+#else
+#define STATS_HEADER ""
+#endif
+
+static void resetStats(AvlTree *tree) {
+    #ifdef AVLTREE_STATS
+    tree->stats = (AvlTree_Stats) { 0 };
+    #endif
+}
+
+static void printStats(const AvlTree *tree) {
+    #ifdef AVLTREE_STATS
+    const AvlTree_Stats *stats = &tree->stats;
+    printf(",%g,%g,%g,%g",
+            (double) stats->descentSteps / stats->insertions,
+            (double) stats->rotations / (stats->insertions + stats->removals),
+            (double) stats->insertRebalanceSteps / stats->insertions,
+            (double) stats->removeRebalanceSteps / stats->removals);
+    #endif
+    printf("\n");
+}
+
 static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
     Value *values = createValues(nodeCount);
     AvlTree tree;
@@ -129,6 +449,7 @@ static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
     for (size_t i = 0; i < nodeCount - 1; ++i) {
         TestAvlTree_insert(&tree, &values[i].node);
     }
+    resetStats(&tree);
     double insertMean = 0;
     double removeMean = 0;
     double insertVar = 0;
@@ -153,7 +474,8 @@ static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
         delta2 = (double) (te - tb) - removeMean;
         removeVar += delta * delta2;
     }
-    printf("%zu,%g,%g,%g,%g\n", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    printf("%zu,%g,%g,%g,%g", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    printStats(&tree);
     free(values);
 }
 
@@ -165,6 +487,7 @@ static void testMinimumRemovalPerformance(size_t nodeCount, size_t roundCount) {
         TestAvlTree_insert(&tree, &values[i].node);
     }
     Value *value = &values[nodeCount - 1];
+    resetStats(&tree);
     double insertMean = 0;
     double removeMean = 0;
     double insertVar = 0;
@@ -189,7 +512,8 @@ static void testMinimumRemovalPerformance(size_t nodeCount, size_t roundCount) {
         delta2 = (double) (te - tb) - removeMean;
         removeVar += delta * delta2;
     }
-    printf("%zu,%g,%g,%g,%g\n", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    printf("%zu,%g,%g,%g,%g", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    printStats(&tree);
     free(values);
 }
 
@@ -212,6 +536,242 @@ static void testFullCyclePerformance(size_t nodeCount, size_t roundCount) {
     free(values);
 }
 
+static void testBuildPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    AvlTree_Node **unsorted = malloc(nodeCount * sizeof(AvlTree_Node *));
+    AvlTree_Node **nodes = malloc(nodeCount * sizeof(AvlTree_Node *));
+    for (size_t i = 0; i < nodeCount; i++) {
+        unsorted[i] = &values[i].node;
+    }
+    AvlTree tree;
+    uint64_t insertTicks = 0;
+    uint64_t sortAndBuildTicks = 0;
+    uint64_t buildTicks = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Repeated insertion
+        AvlTree_initialize(&tree);
+        uint64_t tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            TestAvlTree_insert(&tree, unsorted[i]);
+        }
+        uint64_t te = tscStopwatchEnd();
+        insertTicks += te - tb;
+        // Bulk construction from unsorted nodes
+        memcpy(nodes, unsorted, nodeCount * sizeof(AvlTree_Node *));
+        AvlTree_initialize(&tree);
+        tb = tscStopwatchBegin();
+        TestAvlTree_build(&tree, nodes, nodeCount);
+        te = tscStopwatchEnd();
+        sortAndBuildTicks += te - tb;
+        // Bulk construction from nodes already sorted by the previous step
+        AvlTree_initialize(&tree);
+        tb = tscStopwatchBegin();
+        AvlTree_buildFromSorted(&tree, nodes, nodeCount);
+        te = tscStopwatchEnd();
+        buildTicks += te - tb;
+    }
+    double divisor = (double) roundCount * nodeCount;
+    printf("%zu,%g,%g,%g\n", nodeCount, insertTicks / divisor, sortAndBuildTicks / divisor, buildTicks / divisor);
+    free(nodes);
+    free(unsorted);
+    free(values);
+}
+
+static volatile uintptr_t benchmarkSink;
+
+static void testLookupPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    Value *probes = createValues(nodeCount);
+    for (size_t i = 0; i < nodeCount; i++) {
+        randomizeKey(&probes[i]); // createValues reseeds with the same time
+    }
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; i++) {
+        TestAvlTree_insert(&tree, &values[i].node);
+    }
+    uintptr_t sink = 0;
+    uint64_t findTicks = 0;
+    uint64_t lowerBoundTicks = 0;
+    uint64_t upperBoundTicks = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Successful lookups of keys in the tree, in random order
+        uint64_t tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            sink += (uintptr_t) TestAvlTree_find(&tree, &values[i].node);
+        }
+        uint64_t te = tscStopwatchEnd();
+        findTicks += te - tb;
+        // Bounds of random keys, most likely not in the tree
+        tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            sink += (uintptr_t) TestAvlTree_lowerBound(&tree, &probes[i].node);
+        }
+        te = tscStopwatchEnd();
+        lowerBoundTicks += te - tb;
+        tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            sink += (uintptr_t) TestAvlTree_upperBound(&tree, &probes[i].node);
+        }
+        te = tscStopwatchEnd();
+        upperBoundTicks += te - tb;
+    }
+    benchmarkSink = sink;
+    double divisor = (double) roundCount * nodeCount;
+    printf("%zu,%g,%g,%g\n", nodeCount, findTicks / divisor, lowerBoundTicks / divisor, upperBoundTicks / divisor);
+    free(probes);
+    free(values);
+}
+
+static void testFrozenLookupPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    Value *probes = createValues(nodeCount);
+    for (size_t i = 0; i < nodeCount; i++) {
+        randomizeKey(&probes[i]); // createValues reseeds with the same time
+    }
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; i++) {
+        TestAvlTree_insert(&tree, &values[i].node);
+    }
+    FrozenItem *keys = malloc(nodeCount * sizeof(FrozenItem));
+    for (size_t i = 0; i < nodeCount; i++) {
+        keys[i].key = values[i].key;
+    }
+    FrozenItem *probeKeys = malloc(nodeCount * sizeof(FrozenItem));
+    for (size_t i = 0; i < nodeCount; i++) {
+        probeKeys[i].key = probes[i].key;
+    }
+    AvlTreeFrozen frozen;
+    FrozenItem *items = NULL;
+    uintptr_t sink = 0;
+    uint64_t freezeTicks = 0;
+    uint64_t liveFindTicks = 0;
+    uint64_t frozenFindTicks = 0;
+    uint64_t liveLowerBoundTicks = 0;
+    uint64_t frozenLowerBoundTicks = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        free(items);
+        uint64_t tb = tscStopwatchBegin();
+        AvlTreeFrozen_initialize(&frozen, &tree);
+        items = malloc(frozen.slotCount * sizeof(FrozenItem));
+        TestAvlTree_frozen_freeze(&frozen, &tree, items);
+        uint64_t te = tscStopwatchEnd();
+        freezeTicks += te - tb;
+        // Successful lookups of keys in the tree, in random order
+        tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            sink += (uintptr_t) TestAvlTree_find(&tree, &values[i].node);
+        }
+        te = tscStopwatchEnd();
+        liveFindTicks += te - tb;
+        tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            sink += (uintptr_t) TestAvlTree_frozen_find(&frozen, items, &keys[i]);
+        }
+        te = tscStopwatchEnd();
+        frozenFindTicks += te - tb;
+        // Bounds of random keys, most likely not in the tree
+        tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            sink += (uintptr_t) TestAvlTree_lowerBound(&tree, &probes[i].node);
+        }
+        te = tscStopwatchEnd();
+        liveLowerBoundTicks += te - tb;
+        tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            sink += (uintptr_t) TestAvlTree_frozen_lowerBound(&frozen, items, &probeKeys[i]);
+        }
+        te = tscStopwatchEnd();
+        frozenLowerBoundTicks += te - tb;
+    }
+    benchmarkSink = sink;
+    double divisor = (double) roundCount * nodeCount;
+    printf("%zu,%g,%g,%g,%g,%g\n", nodeCount, freezeTicks / divisor,
+            liveFindTicks / divisor, frozenFindTicks / divisor,
+            liveLowerBoundTicks / divisor, frozenLowerBoundTicks / divisor);
+    free(items);
+    free(probeKeys);
+    free(keys);
+    free(probes);
+    free(values);
+}
+
+static void testScanPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    uint64_t sum = 0;
+    uint64_t scanTicks = 0;
+    uint64_t removalTicks = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        for (size_t i = 0; i < nodeCount; i++) {
+            TestAvlTree_insert(&tree, &values[i].node);
+        }
+        // In-order scan leaving the tree untouched
+        uint64_t tb = tscStopwatchBegin();
+        for (AvlTree_Node *node = tree.leftmost; node != &tree.sentinel; node = AvlTree_next(&tree, node)) {
+            sum += Value_fromNode(node)->key;
+        }
+        uint64_t te = tscStopwatchEnd();
+        scanTicks += te - tb;
+        // In-order drain by repeated removal of the leftmost node
+        tb = tscStopwatchBegin();
+        while (!AvlTree_isEmpty(&tree)) {
+            Value *value = Value_fromNode(tree.leftmost);
+            sum += value->key;
+            AvlTree_remove(&tree, &value->node);
+        }
+        te = tscStopwatchEnd();
+        removalTicks += te - tb;
+    }
+    benchmarkSink = sum;
+    double divisor = (double) roundCount * nodeCount;
+    printf("%zu,%g,%g\n", nodeCount, scanTicks / divisor, removalTicks / divisor);
+    free(values);
+}
+
+static void testRemoveRangePerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    // Remove the middle half of the keys
+    Value lo = { .key = UINT64_MAX / 4 };
+    Value hi = { .key = UINT64_MAX / 4 * 3 };
+    size_t removedCount = 0;
+    uint64_t perNodeTicks = 0;
+    uint64_t rangeTicks = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Per node removal
+        for (size_t i = 0; i < nodeCount; i++) {
+            TestAvlTree_insert(&tree, &values[i].node);
+        }
+        uint64_t tb = tscStopwatchBegin();
+        AvlTree_Node *node = TestAvlTree_lowerBound(&tree, &lo.node);
+        while (node != &tree.sentinel && Value_isLess(node, &hi.node)) {
+            AvlTree_Node *next = AvlTree_next(&tree, node);
+            AvlTree_remove(&tree, node);
+            node = next;
+            removedCount++;
+        }
+        uint64_t te = tscStopwatchEnd();
+        perNodeTicks += te - tb;
+        AvlTree_initialize(&tree);
+        // Range removal
+        for (size_t i = 0; i < nodeCount; i++) {
+            TestAvlTree_insert(&tree, &values[i].node);
+        }
+        tb = tscStopwatchBegin();
+        TestAvlTree_removeRange(&tree, &lo.node, &hi.node);
+        te = tscStopwatchEnd();
+        rangeTicks += te - tb;
+        AvlTree_initialize(&tree);
+    }
+    double divisor = (removedCount > 0) ? (double) removedCount : 1;
+    printf("%zu,%g,%g\n", nodeCount, perNodeTicks / divisor, rangeTicks / divisor);
+    free(values);
+}
+
 static void burstRandomRemovalPerformance(size_t roundCount) {
     testRandomRemovalPerformance(1, roundCount);
     testRandomRemovalPerformance(3, roundCount);
@@ -260,6 +820,32 @@ static void burstMinimumRemovalPerformance(size_t roundCount) {
     testMinimumRemovalPerformance(10000000, roundCount);
 }
 
+static void burstBuildPerformance(size_t roundCount) {
+    testBuildPerformance(1, roundCount);
+    testBuildPerformance(3, roundCount);
+    testBuildPerformance(5, roundCount);
+    testBuildPerformance(10, roundCount);
+    testBuildPerformance(30, roundCount);
+    testBuildPerformance(50, roundCount);
+    testBuildPerformance(100, roundCount);
+    testBuildPerformance(300, roundCount);
+    testBuildPerformance(500, roundCount);
+    testBuildPerformance(1000, roundCount);
+    testBuildPerformance(3000, roundCount);
+    testBuildPerformance(5000, roundCount);
+    testBuildPerformance(10000, roundCount);
+    if (roundCount < 100) {
+        testBuildPerformance(30000, roundCount);
+        testBuildPerformance(50000, roundCount);
+        testBuildPerformance(100000, roundCount);
+        testBuildPerformance(300000, roundCount);
+        testBuildPerformance(1000000, roundCount);
+        testBuildPerformance(3000000, roundCount);
+        testBuildPerformance(5000000, roundCount);
+        testBuildPerformance(10000000, roundCount);
+    }
+}
+
 static void burstFullCyclePerformance(size_t roundCount) {
     testFullCyclePerformance(1, roundCount);
     testFullCyclePerformance(3, roundCount);
@@ -286,8 +872,115 @@ static void burstFullCyclePerformance(size_t roundCount) {
     }
 }
 
+static void burstLookupPerformance(size_t roundCount) {
+    testLookupPerformance(1, roundCount);
+    testLookupPerformance(3, roundCount);
+    testLookupPerformance(5, roundCount);
+    testLookupPerformance(10, roundCount);
+    testLookupPerformance(30, roundCount);
+    testLookupPerformance(50, roundCount);
+    testLookupPerformance(100, roundCount);
+    testLookupPerformance(300, roundCount);
+    testLookupPerformance(500, roundCount);
+    testLookupPerformance(1000, roundCount);
+    testLookupPerformance(3000, roundCount);
+    testLookupPerformance(5000, roundCount);
+    testLookupPerformance(10000, roundCount);
+    if (roundCount < 100) {
+        testLookupPerformance(30000, roundCount);
+        testLookupPerformance(50000, roundCount);
+        testLookupPerformance(100000, roundCount);
+        testLookupPerformance(300000, roundCount);
+        testLookupPerformance(1000000, roundCount);
+        testLookupPerformance(3000000, roundCount);
+        testLookupPerformance(5000000, roundCount);
+        testLookupPerformance(10000000, roundCount);
+    }
+}
+
+static void burstFrozenLookupPerformance(size_t roundCount) {
+    testFrozenLookupPerformance(1, roundCount);
+    testFrozenLookupPerformance(3, roundCount);
+    testFrozenLookupPerformance(5, roundCount);
+    testFrozenLookupPerformance(10, roundCount);
+    testFrozenLookupPerformance(30, roundCount);
+    testFrozenLookupPerformance(50, roundCount);
+    testFrozenLookupPerformance(100, roundCount);
+    testFrozenLookupPerformance(300, roundCount);
+    testFrozenLookupPerformance(500, roundCount);
+    testFrozenLookupPerformance(1000, roundCount);
+    testFrozenLookupPerformance(3000, roundCount);
+    testFrozenLookupPerformance(5000, roundCount);
+    testFrozenLookupPerformance(10000, roundCount);
+    if (roundCount < 100) {
+        testFrozenLookupPerformance(30000, roundCount);
+        testFrozenLookupPerformance(50000, roundCount);
+        testFrozenLookupPerformance(100000, roundCount);
+        testFrozenLookupPerformance(300000, roundCount);
+        testFrozenLookupPerformance(1000000, roundCount);
+        testFrozenLookupPerformance(3000000, roundCount);
+        testFrozenLookupPerformance(5000000, roundCount);
+        testFrozenLookupPerformance(10000000, roundCount);
+    }
+}
+
+static void burstScanPerformance(size_t roundCount) {
+    testScanPerformance(1, roundCount);
+    testScanPerformance(3, roundCount);
+    testScanPerformance(5, roundCount);
+    testScanPerformance(10, roundCount);
+    testScanPerformance(30, roundCount);
+    testScanPerformance(50, roundCount);
+    testScanPerformance(100, roundCount);
+    testScanPerformance(300, roundCount);
+    testScanPerformance(500, roundCount);
+    testScanPerformance(1000, roundCount);
+    testScanPerformance(3000, roundCount);
+    testScanPerformance(5000, roundCount);
+    testScanPerformance(10000, roundCount);
+    if (roundCount < 100) {
+        testScanPerformance(30000, roundCount);
+        testScanPerformance(50000, roundCount);
+        testScanPerformance(100000, roundCount);
+        testScanPerformance(300000, roundCount);
+        testScanPerformance(1000000, roundCount);
+        testScanPerformance(3000000, roundCount);
+        testScanPerformance(5000000, roundCount);
+        testScanPerformance(10000000, roundCount);
+    }
+}
+
+static void burstRemoveRangePerformance(size_t roundCount) {
+    testRemoveRangePerformance(1, roundCount);
+    testRemoveRangePerformance(3, roundCount);
+    testRemoveRangePerformance(5, roundCount);
+    testRemoveRangePerformance(10, roundCount);
+    testRemoveRangePerformance(30, roundCount);
+    testRemoveRangePerformance(50, roundCount);
+    testRemoveRangePerformance(100, roundCount);
+    testRemoveRangePerformance(300, roundCount);
+    testRemoveRangePerformance(500, roundCount);
+    testRemoveRangePerformance(1000, roundCount);
+    testRemoveRangePerformance(3000, roundCount);
+    testRemoveRangePerformance(5000, roundCount);
+    testRemoveRangePerformance(10000, roundCount);
+    if (roundCount < 100) {
+        testRemoveRangePerformance(30000, roundCount);
+        testRemoveRangePerformance(50000, roundCount);
+        testRemoveRangePerformance(100000, roundCount);
+        testRemoveRangePerformance(300000, roundCount);
+        testRemoveRangePerformance(1000000, roundCount);
+        testRemoveRangePerformance(3000000, roundCount);
+        testRemoveRangePerformance(5000000, roundCount);
+        testRemoveRangePerformance(10000000, roundCount);
+    }
+}
+
 int main() {
     printf("Value size: %zu\n", sizeof(Value));
+    #ifdef AVLTREE_PREFETCH
+    printf("Prefetching enabled\n");
+    #endif
     #ifndef NDEBUG
     for (size_t i = 0; i < 10; ++i) {
         printf("Round %zu\n", i);
@@ -296,15 +989,47 @@ int main() {
         testConsistency(5);
         testConsistency(10);
         testConsistency(5000);
+        testSplitJoinConsistency(1);
+        testSplitJoinConsistency(2);
+        testSplitJoinConsistency(3);
+        testSplitJoinConsistency(10);
+        testSplitJoinConsistency(1000);
+        testLookupConsistency(1);
+        testLookupConsistency(10);
+        testLookupConsistency(5000);
+        testFrozenLookupConsistency(1);
+        testFrozenLookupConsistency(10);
+        testFrozenLookupConsistency(5000);
+        testIterationConsistency(1);
+        testIterationConsistency(10);
+        testIterationConsistency(5000);
+        testRemoveRangeConsistency(1);
+        testRemoveRangeConsistency(10);
+        testRemoveRangeConsistency(1000);
     }
     #else
     printf("Random removal benchmark\n");
-    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev\n");
+    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev" STATS_HEADER "\n");
     burstRandomRemovalPerformance(1000000);
     printf("Minimum removal benchmark\n");
-    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev\n");
+    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev" STATS_HEADER "\n");
     burstMinimumRemovalPerformance(1000000);
     printf("Full cycle benchmark\n");
     burstFullCyclePerformance(1000);
+    printf("Bulk construction benchmark\n");
+    printf("Node count,Insert,Sort and build,Build sorted\n");
+    burstBuildPerformance(10);
+    printf("Lookup benchmark\n");
+    printf("Node count,Find,Lower bound,Upper bound\n");
+    burstLookupPerformance(10);
+    printf("Frozen lookup benchmark\n");
+    printf("Node count,Freeze,Live find,Frozen find,Live lower bound,Frozen lower bound\n");
+    burstFrozenLookupPerformance(10);
+    printf("In-order scan benchmark\n");
+    printf("Node count,Scan,Leftmost removal\n");
+    burstScanPerformance(10);
+    printf("Range removal benchmark\n");
+    printf("Node count,Per-node removal,Range removal\n");
+    burstRemoveRangePerformance(10);
     #endif
 }
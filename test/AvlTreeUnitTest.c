@@ -40,6 +40,82 @@ static inline bool Value_isLess(AvlTree_Node *node, AvlTree_Node *other) {
 }
 
 AvlTree_instantiateInsert(AvlTreeTest_insert, Value_isLess);
+AvlTree_instantiateBuild(AvlTreeTest_build, Value_isLess);
+AvlTree_instantiateSplit(AvlTreeTest_split, Value_isLess);
+AvlTree_instantiateFind(AvlTreeTest_find, Value_isLess);
+AvlTree_instantiateLowerBound(AvlTreeTest_lowerBound, Value_isLess);
+AvlTree_instantiateUpperBound(AvlTreeTest_upperBound, Value_isLess);
+
+typedef struct VisitedKeys {
+    int keys[16];
+    size_t count;
+} VisitedKeys;
+
+static void collectKey(AvlTree_Node *node, void *context) {
+    VisitedKeys *visited = (VisitedKeys *) context;
+    visited->keys[visited->count++] = Value_fromNode(node)->key;
+}
+
+AvlTree_instantiateVisitRange(AvlTreeTest_collectRange, Value_isLess, collectKey);
+AvlTree_instantiateRemoveRange(AvlTreeTest_removeRange, Value_isLess);
+
+typedef struct FrozenItem {
+    int key;
+    Value *value;
+} FrozenItem;
+
+static inline void FrozenItem_copy(FrozenItem *item, AvlTree_Node *node) {
+    item->value = Value_fromNode(node);
+    item->key = item->value->key;
+}
+
+static inline bool FrozenItem_isLess(const FrozenItem *item, const FrozenItem *other) {
+    return item->key < other->key;
+}
+
+AvlTree_instantiateFreeze(AvlTreeTest_frozen, FrozenItem, FrozenItem_copy, FrozenItem_isLess);
+
+typedef struct CountedValue {
+    int key;
+    AvlTreeCounted_Node node;
+} CountedValue;
+
+static inline CountedValue *CountedValue_fromNode(AvlTree_Node *n) {
+    return (CountedValue *) ((uint8_t *) AvlTreeCounted_getNode(n) - offsetof(CountedValue, node));
+}
+
+static inline bool CountedValue_isLess(AvlTree_Node *node, AvlTree_Node *other) {
+    return CountedValue_fromNode(node)->key < CountedValue_fromNode(other)->key;
+}
+
+AvlTreeCounted_instantiateInsert(AvlTreeTest_insertCounted, CountedValue_isLess);
+AvlTreeCounted_instantiateRank(AvlTreeTest_rank, CountedValue_isLess);
+
+typedef struct WeightedValue {
+    int key;
+    int weight;
+    int totalWeight; // sum of weights in the subtree
+    AvlTree_Node node;
+} WeightedValue;
+
+static inline WeightedValue *WeightedValue_fromNode(const AvlTree_Node *n) {
+    return (WeightedValue *) ((uint8_t *) n - offsetof(WeightedValue, node));
+}
+
+static inline bool WeightedValue_isLess(AvlTree_Node *node, AvlTree_Node *other) {
+    return WeightedValue_fromNode(node)->key < WeightedValue_fromNode(other)->key;
+}
+
+static inline int WeightedValue_getTotalWeight(const AvlTree_Node *sentinel, const AvlTree_Node *node) {
+    return (node != sentinel) ? WeightedValue_fromNode(node)->totalWeight : 0;
+}
+
+static inline void WeightedValue_update(const AvlTree_Node *sentinel, AvlTree_Node *node) {
+    WeightedValue *v = WeightedValue_fromNode(node);
+    v->totalWeight = v->weight + WeightedValue_getTotalWeight(sentinel, node->left) + WeightedValue_getTotalWeight(sentinel, node->right);
+}
+
+AvlTree_instantiateAugmented(AvlTreeTest_weighted, WeightedValue_isLess, WeightedValue_update);
 
 static void assertTree(const char *func, int line, AvlTree *tree, Value *root, Value *leftmost, Value *rightmost) {
     ASSERTN(func, line, tree->sentinel.left == (root != NULL ? &root->node : &tree->sentinel));
@@ -54,8 +130,26 @@ static void assertNode(const char *func, int line, AvlTree *tree, Value *value,
     ASSERTN(func, line, value->node.right == (right != NULL ? &right->node : &tree->sentinel));
 }
 
+static size_t assertCounts(const char *func, int line, AvlTree *tree, AvlTree_Node *node) {
+    if (node == &tree->sentinel) return 0;
+    size_t count = assertCounts(func, line, tree, node->left) + assertCounts(func, line, tree, node->right) + 1;
+    ASSERTN(func, line, AvlTreeCounted_getCount(tree, node) == count);
+    return count;
+}
+
+static void assertOrderStatistics(const char *func, int line, AvlTree *tree, CountedValue **sorted, size_t count) {
+    assertCounts(func, line, tree, tree->sentinel.left);
+    ASSERTN(func, line, AvlTreeCounted_getSize(tree) == count);
+    for (size_t i = 0; i < count; i++) {
+        ASSERTN(func, line, AvlTreeCounted_select(tree, i) == &sorted[i]->node.node);
+        ASSERTN(func, line, AvlTreeCounted_getRank(tree, &sorted[i]->node.node) == i);
+    }
+    ASSERTN(func, line, AvlTreeCounted_select(tree, count) == &tree->sentinel);
+}
+
 #define ASSERT_TREE(tree, root, leftmost, rightmost) assertTree(__func__, __LINE__, tree, root, leftmost, rightmost)
 #define ASSERT_NODE(tree, value, parent, left, right, balance) assertNode(__func__, __LINE__, tree, value, parent, left, right, balance)
+#define ASSERT_ORDER_STATISTICS(tree, sorted, count) assertOrderStatistics(__func__, __LINE__, tree, sorted, count)
 
 static void AvlTreeTest_initialize() {
     AvlTree tree;
@@ -363,6 +457,712 @@ static void AvlTreeTest_removeNodeWithDeepChildren() {
     ASSERT_NODE(&tree, &v13, &v15, NULL, NULL, AvlTree_balanced);
 }
 
+static void AvlTreeTest_buildFromSortedEmpty() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    
+    AvlTree_buildFromSorted(&tree, NULL, 0);
+    
+    ASSERT_TREE(&tree, NULL, NULL, NULL);
+}
+
+static void AvlTreeTest_buildFromSortedLeftHeavy() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    Value v1 = { .key = 1 };
+    Value v2 = { .key = 2 };
+    Value v3 = { .key = 3 };
+    Value v4 = { .key = 4 };
+    AvlTree_Node *nodes[] = { &v1.node, &v2.node, &v3.node, &v4.node };
+    
+    AvlTree_buildFromSorted(&tree, nodes, 4);
+    
+    //       3
+    //     2   4
+    //   1
+    ASSERT_TREE(&tree, &v3, &v1, &v4);
+    ASSERT_NODE(&tree, &v3, NULL, &v2, &v4, AvlTree_leftHeavy);
+    ASSERT_NODE(&tree, &v2, &v3, &v1, NULL, AvlTree_leftHeavy);
+    ASSERT_NODE(&tree, &v4, &v3, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v1, &v2, NULL, NULL, AvlTree_balanced);
+}
+
+static void AvlTreeTest_buildFromSortedBalanced() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    Value v1 = { .key = 1 };
+    Value v2 = { .key = 2 };
+    Value v3 = { .key = 3 };
+    Value v4 = { .key = 4 };
+    Value v5 = { .key = 5 };
+    Value v6 = { .key = 6 };
+    AvlTree_Node *nodes[] = { &v1.node, &v2.node, &v3.node, &v4.node, &v5.node, &v6.node };
+    
+    AvlTree_buildFromSorted(&tree, nodes, 6);
+    
+    //       4
+    //    2     6
+    //   1 3   5
+    ASSERT_TREE(&tree, &v4, &v1, &v6);
+    ASSERT_NODE(&tree, &v4, NULL, &v2, &v6, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v2, &v4, &v1, &v3, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v6, &v4, &v5, NULL, AvlTree_leftHeavy);
+    ASSERT_NODE(&tree, &v1, &v2, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v3, &v2, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v5, &v6, NULL, NULL, AvlTree_balanced);
+}
+
+static void AvlTreeTest_buildFromUnsorted() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    Value v11 = { .key = 11 };
+    Value v12 = { .key = 12 };
+    Value v13 = { .key = 13 };
+    Value v14 = { .key = 14 };
+    Value v15 = { .key = 15 };
+    AvlTree_Node *nodes[] = { &v15.node, &v11.node, &v13.node, &v12.node, &v14.node };
+    
+    AvlTreeTest_build(&tree, nodes, 5);
+    
+    //       13
+    //    12    15
+    //  11    14
+    ASSERT_TREE(&tree, &v13, &v11, &v15);
+    ASSERT_NODE(&tree, &v13, NULL, &v12, &v15, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v12, &v13, &v11, NULL, AvlTree_leftHeavy);
+    ASSERT_NODE(&tree, &v15, &v13, &v14, NULL, AvlTree_leftHeavy);
+    ASSERT_NODE(&tree, &v11, &v12, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v14, &v15, NULL, NULL, AvlTree_balanced);
+}
+
+static void AvlTreeTest_removeAfterBuild() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    Value v1 = { .key = 1 };
+    Value v2 = { .key = 2 };
+    Value v3 = { .key = 3 };
+    Value v4 = { .key = 4 };
+    AvlTree_Node *nodes[] = { &v1.node, &v2.node, &v3.node, &v4.node };
+    AvlTree_buildFromSorted(&tree, nodes, 4);
+    //       3
+    //     2   4
+    //   1
+
+    AvlTree_remove(&tree, &v4.node);
+    
+    //     2
+    //   1   3
+    ASSERT_TREE(&tree, &v2, &v1, &v3);
+    ASSERT_NODE(&tree, &v2, NULL, &v1, &v3, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v1, &v2, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v3, &v2, NULL, NULL, AvlTree_balanced);
+}
+
+static void AvlTreeTest_joinSimilarHeights() {
+    AvlTree tree;
+    AvlTree other;
+    AvlTree_initialize(&tree);
+    AvlTree_initialize(&other);
+    Value v1 = { .key = 1 };
+    Value v2 = { .key = 2 };
+    Value v5 = { .key = 5 };
+    Value v10 = { .key = 10 };
+    Value v11 = { .key = 11 };
+    Value v12 = { .key = 12 };
+    AvlTreeTest_insert(&tree, &v1.node);
+    AvlTreeTest_insert(&tree, &v2.node);
+    AvlTreeTest_insert(&other, &v10.node);
+    AvlTreeTest_insert(&other, &v11.node);
+    AvlTreeTest_insert(&other, &v12.node);
+    //  1         11
+    //    2     10  12
+
+    AvlTree_join(&tree, &v5.node, &other);
+
+    //       5
+    //    1     11
+    //      2 10  12
+    ASSERT_TREE(&other, NULL, NULL, NULL);
+    ASSERT_TREE(&tree, &v5, &v1, &v12);
+    ASSERT_NODE(&tree, &v5, NULL, &v1, &v11, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v1, &v5, NULL, &v2, AvlTree_rightHeavy);
+    ASSERT_NODE(&tree, &v11, &v5, &v10, &v12, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v2, &v1, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v10, &v11, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v12, &v11, NULL, NULL, AvlTree_balanced);
+}
+
+static void AvlTreeTest_joinDifferentHeights() {
+    AvlTree tree;
+    AvlTree other;
+    AvlTree_initialize(&tree);
+    AvlTree_initialize(&other);
+    Value v1 = { .key = 1 };
+    Value v5 = { .key = 5 };
+    Value v10 = { .key = 10 };
+    Value v11 = { .key = 11 };
+    Value v12 = { .key = 12 };
+    Value v13 = { .key = 13 };
+    Value v14 = { .key = 14 };
+    Value v15 = { .key = 15 };
+    Value v16 = { .key = 16 };
+    AvlTree_Node *nodes[] = { &v10.node, &v11.node, &v12.node, &v13.node, &v14.node, &v15.node, &v16.node };
+    AvlTreeTest_insert(&tree, &v1.node);
+    AvlTree_buildFromSorted(&other, nodes, 7);
+    //  1          13
+    //         11      15
+    //       10  12  14  16
+
+    AvlTree_join(&tree, &v5.node, &other);
+
+    //            13
+    //       5        15
+    //    1    11   14  16
+    //       10  12
+    ASSERT_TREE(&other, NULL, NULL, NULL);
+    ASSERT_TREE(&tree, &v13, &v1, &v16);
+    ASSERT_NODE(&tree, &v13, NULL, &v5, &v15, AvlTree_leftHeavy);
+    ASSERT_NODE(&tree, &v5, &v13, &v1, &v11, AvlTree_rightHeavy);
+    ASSERT_NODE(&tree, &v15, &v13, &v14, &v16, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v1, &v5, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v11, &v5, &v10, &v12, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v14, &v15, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v16, &v15, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v10, &v11, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&tree, &v12, &v11, NULL, NULL, AvlTree_balanced);
+}
+
+static void AvlTreeTest_splitAtMiddle() {
+    AvlTree tree;
+    AvlTree other;
+    AvlTree_initialize(&tree);
+    AvlTree_initialize(&other);
+    Value v1 = { .key = 1 };
+    Value v2 = { .key = 2 };
+    Value v3 = { .key = 3 };
+    Value v4 = { .key = 4 };
+    Value v5 = { .key = 5 };
+    Value v6 = { .key = 6 };
+    Value v7 = { .key = 7 };
+    AvlTree_Node *nodes[] = { &v1.node, &v2.node, &v3.node, &v4.node, &v5.node, &v6.node, &v7.node };
+    AvlTree_buildFromSorted(&tree, nodes, 7);
+    //       4
+    //    2     6
+    //   1 3   5 7
+
+    AvlTree_split(&tree, &v3.node, &other);
+
+    //      2         6
+    //    1         4   7
+    //             3 5
+    ASSERT_TREE(&tree, &v2, &v1, &v2);
+    ASSERT_NODE(&tree, &v2, NULL, &v1, NULL, AvlTree_leftHeavy);
+    ASSERT_NODE(&tree, &v1, &v2, NULL, NULL, AvlTree_balanced);
+    ASSERT_TREE(&other, &v6, &v3, &v7);
+    ASSERT_NODE(&other, &v6, NULL, &v4, &v7, AvlTree_leftHeavy);
+    ASSERT_NODE(&other, &v4, &v6, &v3, &v5, AvlTree_balanced);
+    ASSERT_NODE(&other, &v7, &v6, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&other, &v3, &v4, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&other, &v5, &v4, NULL, NULL, AvlTree_balanced);
+}
+
+static void AvlTreeTest_splitAtLeftmost() {
+    AvlTree tree;
+    AvlTree other;
+    AvlTree_initialize(&tree);
+    AvlTree_initialize(&other);
+    Value v13 = { .key = 13 };
+    Value v14 = { .key = 14 };
+    Value v15 = { .key = 15 };
+    AvlTreeTest_insert(&tree, &v13.node);
+    AvlTreeTest_insert(&tree, &v14.node);
+    AvlTreeTest_insert(&tree, &v15.node);
+    //    14
+    //  13  15
+
+    AvlTree_split(&tree, &v13.node, &other);
+
+    //            14
+    //          13  15
+    ASSERT_TREE(&tree, NULL, NULL, NULL);
+    ASSERT_TREE(&other, &v14, &v13, &v15);
+    ASSERT_NODE(&other, &v14, NULL, &v13, &v15, AvlTree_balanced);
+    ASSERT_NODE(&other, &v13, &v14, NULL, NULL, AvlTree_balanced);
+    ASSERT_NODE(&other, &v15, &v14, NULL, NULL, AvlTree_balanced);
+}
+
+static void AvlTreeTest_splitByKey() {
+    AvlTree tree;
+    AvlTree other;
+    AvlTree_initialize(&tree);
+    AvlTree_initialize(&other);
+    Value v13 = { .key = 13 };
+    Value v14 = { .key = 14 };
+    Value v15 = { .key = 15 };
+    Value key = { .key = 15 };
+    AvlTreeTest_insert(&tree, &v13.node);
+    AvlTreeTest_insert(&tree, &v14.node);
+    AvlTreeTest_insert(&tree, &v15.node);
+    //    14
+    //  13  15
+
+    AvlTreeTest_split(&tree, &key.node, &other);
+
+    //    14     15
+    //  13
+    ASSERT_TREE(&tree, &v14, &v13, &v14);
+    ASSERT_NODE(&tree, &v14, NULL, &v13, NULL, AvlTree_leftHeavy);
+    ASSERT_NODE(&tree, &v13, &v14, NULL, NULL, AvlTree_balanced);
+    ASSERT_TREE(&other, &v15, &v15, &v15);
+    ASSERT_NODE(&other, &v15, NULL, NULL, NULL, AvlTree_balanced);
+}
+
+static void AvlTreeTest_lookupEmpty() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    Value key = { .key = 13 };
+
+    ASSERT(AvlTreeTest_find(&tree, &key.node) == &tree.sentinel);
+    ASSERT(AvlTreeTest_lowerBound(&tree, &key.node) == &tree.sentinel);
+    ASSERT(AvlTreeTest_upperBound(&tree, &key.node) == &tree.sentinel);
+}
+
+static void AvlTreeTest_lookup() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    Value v10 = { .key = 10 };
+    Value v20a = { .key = 20 };
+    Value v20b = { .key = 20 };
+    Value v30 = { .key = 30 };
+    Value key;
+    AvlTreeTest_insert(&tree, &v20a.node);
+    AvlTreeTest_insert(&tree, &v10.node);
+    AvlTreeTest_insert(&tree, &v30.node);
+    AvlTreeTest_insert(&tree, &v20b.node);
+    //      20a
+    //   10     30
+    //       20b
+
+    key.key = 5;
+    ASSERT(AvlTreeTest_find(&tree, &key.node) == &tree.sentinel);
+    ASSERT(AvlTreeTest_lowerBound(&tree, &key.node) == &v10.node);
+    ASSERT(AvlTreeTest_upperBound(&tree, &key.node) == &v10.node);
+    key.key = 10;
+    ASSERT(AvlTreeTest_find(&tree, &key.node) == &v10.node);
+    ASSERT(AvlTreeTest_lowerBound(&tree, &key.node) == &v10.node);
+    ASSERT(AvlTreeTest_upperBound(&tree, &key.node) == &v20a.node);
+    key.key = 20;
+    ASSERT(AvlTreeTest_find(&tree, &key.node) == &v20a.node);
+    ASSERT(AvlTreeTest_lowerBound(&tree, &key.node) == &v20a.node);
+    ASSERT(AvlTreeTest_upperBound(&tree, &key.node) == &v30.node);
+    key.key = 25;
+    ASSERT(AvlTreeTest_find(&tree, &key.node) == &tree.sentinel);
+    ASSERT(AvlTreeTest_lowerBound(&tree, &key.node) == &v30.node);
+    ASSERT(AvlTreeTest_upperBound(&tree, &key.node) == &v30.node);
+    key.key = 30;
+    ASSERT(AvlTreeTest_find(&tree, &key.node) == &v30.node);
+    ASSERT(AvlTreeTest_lowerBound(&tree, &key.node) == &v30.node);
+    ASSERT(AvlTreeTest_upperBound(&tree, &key.node) == &tree.sentinel);
+    key.key = 35;
+    ASSERT(AvlTreeTest_find(&tree, &key.node) == &tree.sentinel);
+    ASSERT(AvlTreeTest_lowerBound(&tree, &key.node) == &tree.sentinel);
+}
+
+static void AvlTreeTest_nextAndPrev() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    Value values[10];
+    const int keys[] = { 13, 14, 15, 12, 11, 17, 16, 8, 9, 1 };
+    const int sorted[] = { 1, 8, 9, 11, 12, 13, 14, 15, 16, 17 };
+    for (size_t i = 0; i < 10; i++) {
+        values[i].key = keys[i];
+        AvlTreeTest_insert(&tree, &values[i].node);
+    }
+
+    AvlTree_Node *node = tree.leftmost;
+    for (size_t i = 0; i < 10; i++) {
+        ASSERT(Value_fromNode(node)->key == sorted[i]);
+        node = AvlTree_next(&tree, node);
+    }
+    ASSERT(node == &tree.sentinel);
+    node = tree.rightmost;
+    for (size_t i = 10; i-- > 0;) {
+        ASSERT(Value_fromNode(node)->key == sorted[i]);
+        node = AvlTree_prev(&tree, node);
+    }
+    ASSERT(node == &tree.sentinel);
+}
+
+static void AvlTreeTest_visitRange() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    Value values[10];
+    const int keys[] = { 13, 14, 15, 12, 11, 17, 16, 8, 9, 1 };
+    for (size_t i = 0; i < 10; i++) {
+        values[i].key = keys[i];
+        AvlTreeTest_insert(&tree, &values[i].node);
+    }
+    Value lo = { .key = 9 };
+    Value hi = { .key = 15 };
+    VisitedKeys visited = { .count = 0 };
+
+    AvlTreeTest_collectRange(&tree, &lo.node, &hi.node, &visited);
+
+    ASSERT(visited.count == 5);
+    ASSERT(visited.keys[0] == 9);
+    ASSERT(visited.keys[1] == 11);
+    ASSERT(visited.keys[2] == 12);
+    ASSERT(visited.keys[3] == 13);
+    ASSERT(visited.keys[4] == 14);
+
+    lo.key = 2;
+    hi.key = 8;
+    visited.count = 0;
+    AvlTreeTest_collectRange(&tree, &lo.node, &hi.node, &visited);
+    ASSERT(visited.count == 0);
+
+    lo.key = 16;
+    hi.key = 100;
+    AvlTreeTest_collectRange(&tree, &lo.node, &hi.node, &visited);
+    ASSERT(visited.count == 2);
+    ASSERT(visited.keys[0] == 16);
+    ASSERT(visited.keys[1] == 17);
+}
+
+static void AvlTreeTest_removeRangeMiddle() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    Value values[10];
+    const int keys[] = { 13, 14, 15, 12, 11, 17, 16, 8, 9, 1 };
+    for (size_t i = 0; i < 10; i++) {
+        values[i].key = keys[i];
+        AvlTreeTest_insert(&tree, &values[i].node);
+    }
+    Value lo = { .key = 9 };
+    Value hi = { .key = 15 };
+
+    AvlTree_Node *removed = AvlTreeTest_removeRange(&tree, &lo.node, &hi.node);
+
+    const int removedKeys[] = { 9, 11, 12, 13, 14 };
+    for (size_t i = 0; i < 5; i++) {
+        ASSERT(Value_fromNode(removed)->key == removedKeys[i]);
+        removed = removed->right;
+    }
+    ASSERT(removed == NULL);
+    const int remainingKeys[] = { 1, 8, 15, 16, 17 };
+    AvlTree_Node *node = tree.leftmost;
+    for (size_t i = 0; i < 5; i++) {
+        ASSERT(Value_fromNode(node)->key == remainingKeys[i]);
+        node = AvlTree_next(&tree, node);
+    }
+    ASSERT(node == &tree.sentinel);
+    ASSERT(Value_fromNode(tree.leftmost)->key == 1);
+    ASSERT(Value_fromNode(tree.rightmost)->key == 17);
+}
+
+static void AvlTreeTest_removeRangeEnds() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    Value v13 = { .key = 13 };
+    Value v14 = { .key = 14 };
+    Value v15 = { .key = 15 };
+    AvlTreeTest_insert(&tree, &v13.node);
+    AvlTreeTest_insert(&tree, &v14.node);
+    AvlTreeTest_insert(&tree, &v15.node);
+
+    AvlTree_Node *removed = AvlTree_removeRange(&tree, &v15.node, &tree.sentinel);
+
+    ASSERT(removed == &v15.node);
+    ASSERT(removed->right == NULL);
+    ASSERT_TREE(&tree, &v14, &v13, &v14);
+    ASSERT_NODE(&tree, &v14, NULL, &v13, NULL, AvlTree_leftHeavy);
+
+    removed = AvlTree_removeRange(&tree, &v13.node, &v14.node);
+
+    ASSERT(removed == &v13.node);
+    ASSERT(removed->right == NULL);
+    ASSERT_TREE(&tree, &v14, &v14, &v14);
+    ASSERT_NODE(&tree, &v14, NULL, NULL, NULL, AvlTree_balanced);
+
+    removed = AvlTree_removeRange(&tree, &v14.node, &v14.node);
+    ASSERT(removed == NULL);
+
+    removed = AvlTree_removeRange(&tree, &v14.node, &tree.sentinel);
+
+    ASSERT(removed == &v14.node);
+    ASSERT(AvlTree_isEmpty(&tree));
+    ASSERT(tree.leftmost == &tree.sentinel);
+    ASSERT(tree.rightmost == &tree.sentinel);
+}
+
+static int assertTotalWeights(const char *func, int line, AvlTree *tree, AvlTree_Node *node) {
+    if (node == &tree->sentinel) return 0;
+    int totalWeight = assertTotalWeights(func, line, tree, node->left) + assertTotalWeights(func, line, tree, node->right) + WeightedValue_fromNode(node)->weight;
+    ASSERTN(func, line, WeightedValue_fromNode(node)->totalWeight == totalWeight);
+    return totalWeight;
+}
+
+#define ASSERT_TOTAL_WEIGHTS(tree) assertTotalWeights(__func__, __LINE__, tree, (tree)->sentinel.left)
+
+/** Returns the sum of weights of elements with key less than the specified one. */
+static int getWeightBefore(AvlTree *tree, int key) {
+    int result = 0;
+    AvlTree_Node *node = tree->sentinel.left;
+    while (node != &tree->sentinel) {
+        if (key <= WeightedValue_fromNode(node)->key) {
+            node = node->left;
+        } else {
+            result += WeightedValue_getTotalWeight(&tree->sentinel, node->left) + WeightedValue_fromNode(node)->weight;
+            node = node->right;
+        }
+    }
+    return result;
+}
+
+static void AvlTreeTest_countedInsert() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    CountedValue v1  = { .key = 1 };
+    CountedValue v8  = { .key = 8 };
+    CountedValue v9  = { .key = 9 };
+    CountedValue v11 = { .key = 11 };
+    CountedValue v12 = { .key = 12 };
+    CountedValue v13 = { .key = 13 };
+    CountedValue v14 = { .key = 14 };
+    CountedValue v15 = { .key = 15 };
+    CountedValue v16 = { .key = 16 };
+    CountedValue v17 = { .key = 17 };
+    CountedValue *sorted[] = { &v1, &v8, &v9, &v11, &v12, &v13, &v14, &v15, &v16, &v17 };
+
+    AvlTreeTest_insertCounted(&tree, &v13.node.node);
+    AvlTreeTest_insertCounted(&tree, &v14.node.node);
+    AvlTreeTest_insertCounted(&tree, &v15.node.node);
+    AvlTreeTest_insertCounted(&tree, &v12.node.node);
+    AvlTreeTest_insertCounted(&tree, &v11.node.node);
+    AvlTreeTest_insertCounted(&tree, &v17.node.node);
+    AvlTreeTest_insertCounted(&tree, &v16.node.node);
+    AvlTreeTest_insertCounted(&tree, &v8.node.node);
+    AvlTreeTest_insertCounted(&tree, &v9.node.node);
+    AvlTreeTest_insertCounted(&tree, &v1.node.node);
+
+    //               14
+    //        9             16
+    //    8      12       15  17
+    //   1     11  13
+    ASSERT(tree.sentinel.left == &v14.node.node);
+    ASSERT(v14.node.count == 10);
+    ASSERT(v9.node.count == 6);
+    ASSERT(v16.node.count == 3);
+    ASSERT(v8.node.count == 2);
+    ASSERT(v12.node.count == 3);
+    ASSERT_ORDER_STATISTICS(&tree, sorted, 10);
+}
+
+static void AvlTreeTest_countedRemove() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    CountedValue v11 = { .key = 11 };
+    CountedValue v12 = { .key = 12 };
+    CountedValue v13 = { .key = 13 };
+    CountedValue v14 = { .key = 14 };
+    CountedValue v15 = { .key = 15 };
+    AvlTreeTest_insertCounted(&tree, &v15.node.node);
+    AvlTreeTest_insertCounted(&tree, &v14.node.node);
+    AvlTreeTest_insertCounted(&tree, &v13.node.node);
+    AvlTreeTest_insertCounted(&tree, &v12.node.node);
+    AvlTreeTest_insertCounted(&tree, &v11.node.node);
+    //           14
+    //     12         15
+    //   11  13
+
+    AvlTreeCounted_remove(&tree, &v14.node.node);
+
+    //           12
+    //     11         15
+    //              13
+    CountedValue *sorted[] = { &v11, &v12, &v13, &v15 };
+    ASSERT(tree.sentinel.left == &v12.node.node);
+    ASSERT(v12.node.count == 4);
+    ASSERT(v15.node.count == 2);
+    ASSERT_ORDER_STATISTICS(&tree, sorted, 4);
+
+    AvlTreeCounted_remove(&tree, &v11.node.node);
+
+    //     13
+    //  12    15
+    ASSERT(tree.sentinel.left == &v13.node.node);
+    ASSERT_ORDER_STATISTICS(&tree, sorted + 1, 3);
+}
+
+static void AvlTreeTest_countedRank() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    CountedValue v10 = { .key = 10 };
+    CountedValue v20 = { .key = 20 };
+    CountedValue v30 = { .key = 30 };
+    CountedValue key = { .key = 0 };
+    AvlTreeTest_insertCounted(&tree, &v20.node.node);
+    AvlTreeTest_insertCounted(&tree, &v10.node.node);
+    AvlTreeTest_insertCounted(&tree, &v30.node.node);
+
+    ASSERT(AvlTreeTest_rank(&tree, &key.node.node) == 0);
+    key.key = 10;
+    ASSERT(AvlTreeTest_rank(&tree, &key.node.node) == 0);
+    key.key = 11;
+    ASSERT(AvlTreeTest_rank(&tree, &key.node.node) == 1);
+    key.key = 30;
+    ASSERT(AvlTreeTest_rank(&tree, &key.node.node) == 2);
+    key.key = 31;
+    ASSERT(AvlTreeTest_rank(&tree, &key.node.node) == 3);
+}
+
+static void AvlTreeTest_countedRandomOperations() {
+    enum { count = 200 };
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    CountedValue values[count];
+    CountedValue *sorted[count];
+    size_t sortedCount = 0;
+    // Keys are a permutation of 0..count-1, since 7 and count are coprime
+    for (size_t i = 0; i < count; i++) {
+        values[i].key = (i * 7) % count;
+        AvlTreeTest_insertCounted(&tree, &values[i].node.node);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (i % 3 == 0) AvlTreeCounted_remove(&tree, &values[i].node.node);
+    }
+    for (size_t k = 0; k < count; k++) {
+        for (size_t i = 0; i < count; i++) {
+            if (values[i].key == k && i % 3 != 0) sorted[sortedCount++] = &values[i];
+        }
+    }
+    ASSERT_ORDER_STATISTICS(&tree, sorted, sortedCount);
+}
+
+static void AvlTreeTest_augmentedInsertRemove() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    WeightedValue v1 = { .key = 1, .weight = 10 };
+    WeightedValue v2 = { .key = 2, .weight = 20 };
+    WeightedValue v3 = { .key = 3, .weight = 30 };
+    WeightedValue v4 = { .key = 4, .weight = 40 };
+
+    AvlTreeTest_weighted_insert(&tree, &v1.node);
+    ASSERT(v1.totalWeight == 10);
+    AvlTreeTest_weighted_insert(&tree, &v2.node);
+    AvlTreeTest_weighted_insert(&tree, &v3.node);
+
+    //     2
+    //  1     3
+    ASSERT(tree.sentinel.left == &v2.node);
+    ASSERT(v2.totalWeight == 60);
+    ASSERT(v1.totalWeight == 10);
+    ASSERT(v3.totalWeight == 30);
+
+    AvlTreeTest_weighted_insert(&tree, &v4.node);
+    ASSERT(v2.totalWeight == 100);
+    ASSERT(v3.totalWeight == 70);
+    ASSERT(getWeightBefore(&tree, 3) == 30);
+
+    AvlTreeTest_weighted_remove(&tree, &v1.node);
+
+    //     3
+    //  2     4
+    ASSERT(tree.sentinel.left == &v3.node);
+    ASSERT(v3.totalWeight == 90);
+    ASSERT(v2.totalWeight == 20);
+    ASSERT(getWeightBefore(&tree, 4) == 50);
+}
+
+static void AvlTreeTest_augmentedRandomOperations() {
+    enum { count = 200 };
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    WeightedValue values[count];
+    for (size_t i = 0; i < count; i++) {
+        values[i].key = (i * 7) % count;
+        values[i].weight = i % 13;
+        AvlTreeTest_weighted_insert(&tree, &values[i].node);
+        ASSERT_TOTAL_WEIGHTS(&tree);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (i % 3 == 0) {
+            AvlTreeTest_weighted_remove(&tree, &values[i].node);
+            ASSERT_TOTAL_WEIGHTS(&tree);
+        }
+    }
+    int expected = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i % 3 != 0 && values[i].key < 100) expected += values[i].weight;
+    }
+    ASSERT(getWeightBefore(&tree, 100) == expected);
+}
+
+static void AvlTreeTest_frozenLayout() {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    Value values[10];
+    for (size_t i = 0; i < 10; i++) {
+        values[i].key = i;
+        AvlTreeTest_insert(&tree, &values[i].node);
+    }
+    AvlTreeFrozen frozen;
+    AvlTreeFrozen_initialize(&frozen, &tree);
+
+    //  top tree:                 1
+    //                      2           3
+    //  bottom trees:    4     5     6     7
+    //                  8 9  10
+    // stored as 1 2 3 | 4 8 9 | 5 10 - | 6 - - | 7 - -
+    const size_t expected[] = { 0, 1, 2, 3, 6, 9, 12, 4, 5, 7 };
+    ASSERT(frozen.count == 10);
+    ASSERT(frozen.slotCount == 15);
+    for (size_t i = 1; i <= 10; i++) {
+        ASSERT(AvlTreeFrozen_getSlot(&frozen, i) == expected[i - 1]);
+    }
+    const size_t inOrder[] = { 8, 4, 9, 2, 10, 5, 1, 6, 3, 7 };
+    size_t index = AvlTreeFrozen_first(&frozen);
+    for (size_t i = 0; i < 10; i++) {
+        ASSERT(index == inOrder[i]);
+        index = AvlTreeFrozen_next(&frozen, index);
+    }
+    ASSERT(index == 0);
+}
+
+static void AvlTreeTest_frozenLookup() {
+    enum { maxCount = 70 };
+    Value values[maxCount];
+    FrozenItem items[2 * maxCount];
+    for (size_t count = 0; count <= maxCount; count++) {
+        AvlTree tree;
+        AvlTree_initialize(&tree);
+        for (size_t i = 0; i < count; i++) {
+            values[i].key = 2 * ((i % 2 == 0) ? i / 2 : count - 1 - i / 2);
+            AvlTreeTest_insert(&tree, &values[i].node);
+        }
+        AvlTreeFrozen frozen;
+        AvlTreeFrozen_initialize(&frozen, &tree);
+        ASSERT(frozen.slotCount < 2 * count + 1);
+        AvlTreeTest_frozen_freeze(&frozen, &tree, items);
+        for (int k = -1; k <= (int) (2 * count); k++) {
+            FrozenItem key = { .key = k };
+            const FrozenItem *found = AvlTreeTest_frozen_find(&frozen, items, &key);
+            const FrozenItem *lower = AvlTreeTest_frozen_lowerBound(&frozen, items, &key);
+            AvlTree_Node *expected = AvlTreeTest_lowerBound(&tree, &(Value) { .key = k }.node);
+            if (expected == &tree.sentinel) {
+                ASSERT(lower == NULL);
+            } else {
+                ASSERT(lower != NULL && lower->value == Value_fromNode(expected));
+            }
+            if (k >= 0 && k % 2 == 0 && k < (int) (2 * count)) {
+                ASSERT(found != NULL && found->key == k && found->value->key == k);
+            } else {
+                ASSERT(found == NULL);
+            }
+        }
+    }
+}
+
 void AvlTreeTest_run() {
     RUN_TEST(AvlTreeTest_initialize);
     RUN_TEST(AvlTreeTest_insertOne);
@@ -378,4 +1178,28 @@ void AvlTreeTest_run() {
     RUN_TEST(AvlTreeTest_removeNodeWithRightChildOnly);
     RUN_TEST(AvlTreeTest_removeNodeWithBothChildren);
     RUN_TEST(AvlTreeTest_removeNodeWithDeepChildren);
+    RUN_TEST(AvlTreeTest_buildFromSortedEmpty);
+    RUN_TEST(AvlTreeTest_buildFromSortedLeftHeavy);
+    RUN_TEST(AvlTreeTest_buildFromSortedBalanced);
+    RUN_TEST(AvlTreeTest_buildFromUnsorted);
+    RUN_TEST(AvlTreeTest_removeAfterBuild);
+    RUN_TEST(AvlTreeTest_joinSimilarHeights);
+    RUN_TEST(AvlTreeTest_joinDifferentHeights);
+    RUN_TEST(AvlTreeTest_splitAtMiddle);
+    RUN_TEST(AvlTreeTest_splitAtLeftmost);
+    RUN_TEST(AvlTreeTest_splitByKey);
+    RUN_TEST(AvlTreeTest_countedInsert);
+    RUN_TEST(AvlTreeTest_countedRemove);
+    RUN_TEST(AvlTreeTest_countedRank);
+    RUN_TEST(AvlTreeTest_countedRandomOperations);
+    RUN_TEST(AvlTreeTest_augmentedInsertRemove);
+    RUN_TEST(AvlTreeTest_augmentedRandomOperations);
+    RUN_TEST(AvlTreeTest_lookupEmpty);
+    RUN_TEST(AvlTreeTest_lookup);
+    RUN_TEST(AvlTreeTest_nextAndPrev);
+    RUN_TEST(AvlTreeTest_visitRange);
+    RUN_TEST(AvlTreeTest_removeRangeMiddle);
+    RUN_TEST(AvlTreeTest_removeRangeEnds);
+    RUN_TEST(AvlTreeTest_frozenLayout);
+    RUN_TEST(AvlTreeTest_frozenLookup);
 }
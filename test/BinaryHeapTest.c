@@ -41,7 +41,7 @@ BinaryHeap_header(TestHeap);
 typedef struct Value {
     uint64_t key;
     TestHeap_Node *node;
-    char dummy[64 - sizeof(TestHeap_Node) - sizeof(uin64_t)];
+    char dummy[64 - sizeof(TestHeap_Node) - sizeof(uint64_t)];
 } Value;
 
 static inline Value *Value_fromNode(TestHeap_Node **nodePtr) {
@@ -152,6 +152,38 @@ static void testConsistency(size_t nodeCount) {
         TestHeap_poll(&heap);
     }
     assert(TestHeap_isEmpty(&heap));
+    // Test bulk construction
+    TestHeap_Node **nodes = malloc(nodeCount * sizeof(TestHeap_Node *));
+    for (size_t i = 0; i < nodeCount; ++i) {
+        nodes[i] = values[i].node;
+    }
+    TestHeap_buildFromArray(&heap, nodes, nodeCount);
+    TestHeap_check(&heap);
+    seenValuesSize = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        Value *value = Value_fromNode(TestHeap_poll(&heap)->value);
+        TestHeap_check(&heap);
+        assert(!isPresent(seenValues, seenValuesSize, value));
+        seenValues[seenValuesSize] = value;
+        seenValuesSize++;
+        assert(i == 0 || seenValues[i - 1]->key <= seenValues[i]->key);
+    }
+    assert(TestHeap_isEmpty(&heap));
+    // Test batched insertion
+    for (size_t i = 0, batch = 1; i < nodeCount; i += batch, batch = batch % 100 + 1) {
+        TestHeap_insertMany(&heap, &nodes[i], (batch < nodeCount - i) ? batch : nodeCount - i);
+        TestHeap_check(&heap);
+    }
+    seenValuesSize = 0;
+    while (!TestHeap_isEmpty(&heap)) {
+        Value *value = Value_fromNode(TestHeap_poll(&heap)->value);
+        assert(!isPresent(seenValues, seenValuesSize, value));
+        seenValues[seenValuesSize] = value;
+        seenValuesSize++;
+        assert(seenValuesSize == 1 || seenValues[seenValuesSize - 2]->key <= value->key);
+    }
+    assert(seenValuesSize == nodeCount);
+    free(nodes);
     free(seenValues);
     free(vn.nodes);
     free(vn.values);
@@ -278,6 +310,127 @@ static void testFullCyclePerformance(size_t nodeCount, size_t roundCount) {
     free(vn.values);
 }
 
+static void testBuildPerformance(size_t nodeCount, size_t roundCount) {
+    ValueNodes vn = createValues(nodeCount);
+    TestHeap_Node **nodes = malloc(nodeCount * sizeof(TestHeap_Node *));
+    for (size_t i = 0; i < nodeCount; i++) {
+        nodes[i] = &vn.nodes[i];
+    }
+    TestHeap heap;
+    uint64_t insertTicks = 0;
+    uint64_t buildTicks = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Repeated insertion
+        TestHeap_initialize(&heap);
+        uint64_t tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            TestHeap_insert(&heap, nodes[i]);
+        }
+        uint64_t te = tscStopwatchEnd();
+        insertTicks += te - tb;
+        // Bulk construction
+        TestHeap_initialize(&heap);
+        tb = tscStopwatchBegin();
+        TestHeap_buildFromArray(&heap, nodes, nodeCount);
+        te = tscStopwatchEnd();
+        buildTicks += te - tb;
+    }
+    double divisor = (double) roundCount * nodeCount;
+    printf("%zu,%g,%g\n", nodeCount, insertTicks / divisor, buildTicks / divisor);
+    free(nodes);
+    free(vn.nodes);
+    free(vn.values);
+}
+
+static void testBatchPerformance(size_t nodeCount, size_t roundCount) {
+    ValueNodes vn = createValues(nodeCount);
+    TestHeap heap;
+    TestHeap_initialize(&heap);
+    for (size_t i = 0; i < nodeCount; i++) {
+        TestHeap_insert(&heap, &vn.nodes[i]);
+    }
+    const size_t batchSize = (nodeCount < 64) ? nodeCount : 64;
+    TestHeap_Node *batch[64];
+    uint64_t singleTicks = 0;
+    uint64_t batchTicks = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Single insertions
+        for (size_t i = 0; i < batchSize; i++) {
+            batch[i] = TestHeap_poll(&heap);
+            randomizeKey(Value_fromNode(batch[i]->value));
+        }
+        uint64_t tb = tscStopwatchBegin();
+        for (size_t i = 0; i < batchSize; i++) {
+            TestHeap_insert(&heap, batch[i]);
+        }
+        uint64_t te = tscStopwatchEnd();
+        singleTicks += te - tb;
+        // Batched insertion
+        for (size_t i = 0; i < batchSize; i++) {
+            batch[i] = TestHeap_poll(&heap);
+            randomizeKey(Value_fromNode(batch[i]->value));
+        }
+        tb = tscStopwatchBegin();
+        TestHeap_insertMany(&heap, batch, batchSize);
+        te = tscStopwatchEnd();
+        batchTicks += te - tb;
+    }
+    double divisor = (double) roundCount * batchSize;
+    printf("%zu,%g,%g\n", nodeCount, singleTicks / divisor, batchTicks / divisor);
+    free(vn.nodes);
+    free(vn.values);
+}
+
+static void burstBuildPerformance(size_t roundCount) {
+    testBuildPerformance(1, roundCount);
+    testBuildPerformance(3, roundCount);
+    testBuildPerformance(5, roundCount);
+    testBuildPerformance(10, roundCount);
+    testBuildPerformance(30, roundCount);
+    testBuildPerformance(50, roundCount);
+    testBuildPerformance(100, roundCount);
+    testBuildPerformance(300, roundCount);
+    testBuildPerformance(500, roundCount);
+    testBuildPerformance(1000, roundCount);
+    testBuildPerformance(3000, roundCount);
+    testBuildPerformance(5000, roundCount);
+    testBuildPerformance(10000, roundCount);
+    if (roundCount < 100) {
+        testBuildPerformance(30000, roundCount);
+        testBuildPerformance(50000, roundCount);
+        testBuildPerformance(100000, roundCount);
+        testBuildPerformance(300000, roundCount);
+        testBuildPerformance(1000000, roundCount);
+        testBuildPerformance(3000000, roundCount);
+        testBuildPerformance(5000000, roundCount);
+        testBuildPerformance(10000000, roundCount);
+    }
+}
+
+static void burstBatchPerformance(size_t roundCount) {
+    testBatchPerformance(1, roundCount);
+    testBatchPerformance(3, roundCount);
+    testBatchPerformance(5, roundCount);
+    testBatchPerformance(10, roundCount);
+    testBatchPerformance(30, roundCount);
+    testBatchPerformance(50, roundCount);
+    testBatchPerformance(100, roundCount);
+    testBatchPerformance(300, roundCount);
+    testBatchPerformance(500, roundCount);
+    testBatchPerformance(1000, roundCount);
+    testBatchPerformance(3000, roundCount);
+    testBatchPerformance(5000, roundCount);
+    testBatchPerformance(10000, roundCount);
+    testBatchPerformance(30000, roundCount);
+    testBatchPerformance(50000, roundCount);
+    testBatchPerformance(100000, roundCount);
+    testBatchPerformance(300000, roundCount);
+    testBatchPerformance(1000000, roundCount);
+    testBatchPerformance(3000000, roundCount);
+    testBatchPerformance(5000000, roundCount);
+    testBatchPerformance(10000000, roundCount);
+}
+
 static void burstRandomRemovalPerformance(size_t roundCount) {
     testRandomRemovalPerformance(1, roundCount);
     testRandomRemovalPerformance(3, roundCount);
@@ -395,5 +548,11 @@ int main() {
     burstPollAndInsertPerformance(1000000);
     printf("Full cycle benchmark\n");
     burstFullCyclePerformance(1000);
+    printf("Bulk construction benchmark\n");
+    printf("Node count,Insert,Build\n");
+    burstBuildPerformance(10);
+    printf("Batch insertion benchmark (64 inserts after 64 untimed polls)\n");
+    printf("Node count,Single,Batch\n");
+    burstBatchPerformance(10000);
     #endif
 }
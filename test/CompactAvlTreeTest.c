@@ -0,0 +1,255 @@
+/*
+Test code for the AVL tree container with 32-bit index links.
+Copyright 2012-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "AvlTree.h"
+#include "CompactAvlTree.h"
+#include "tscStopwatch.h"
+
+typedef struct CompactValue CompactValue;
+CompactAvlTree_header(TestCompactTree, CompactValue)
+
+struct CompactValue {
+    uint64_t key;
+    TestCompactTree_Node node;
+};
+
+static inline bool CompactValue_isLess(const CompactValue *a, const CompactValue *b) {
+    return a->key < b->key;
+}
+
+CompactAvlTree_implementation(TestCompactTree, CompactValue, node, CompactValue_isLess)
+
+/** Element with pointer links, with the same key, for comparison. */
+typedef struct Value {
+    uint64_t key;
+    AvlTree_Node node;
+} Value;
+
+static inline Value *Value_fromNode(AvlTree_Node *n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, node));
+}
+
+static inline bool Value_isLess(AvlTree_Node *node, AvlTree_Node *other) {
+    return Value_fromNode(node)->key < Value_fromNode(other)->key;
+}
+
+AvlTree_instantiateInsert(TestAvlTree_insert, Value_isLess);
+AvlTree_instantiateFind(TestAvlTree_find, Value_isLess);
+
+static uint64_t randomKey() {
+    return ((uint64_t) lrand48() << 32) | lrand48();
+}
+
+/** Creates count + 1 elements with random keys, the first one being the sentinel. */
+static CompactValue *createCompactValues(size_t count) {
+    CompactValue *values = (CompactValue *) malloc((count + 1) * sizeof(CompactValue));
+    memset(values, 0, (count + 1) * sizeof(CompactValue));
+    for (size_t i = 1; i <= count; ++i) {
+        values[i].key = randomKey();
+    }
+    return values;
+}
+
+/** Creates a random permutation of indices from 1 to count, to visit elements in random order. */
+static uint32_t *createPermutation(size_t count) {
+    uint32_t *indices = (uint32_t *) malloc(count * sizeof(uint32_t));
+    for (size_t i = 0; i < count; ++i) {
+        indices[i] = i + 1;
+    }
+    for (size_t i = count - 1; i > 0; --i) {
+        size_t j = lrand48() % (i + 1);
+        uint32_t t = indices[i];
+        indices[i] = indices[j];
+        indices[j] = t;
+    }
+    return indices;
+}
+
+#ifndef NDEBUG
+/** Checks links, ordering and balance factors of a subtree, returning its height. */
+static int checkSubtree(const TestCompactTree *tree, uint32_t index, uint32_t parent) {
+    if (index == 0) return 0;
+    const CompactValue *value = &tree->elements[index];
+    assert(value->node.parent >> 2 == parent);
+    if (value->node.left != 0) assert(!CompactValue_isLess(value, &tree->elements[value->node.left]));
+    if (value->node.right != 0) assert(!CompactValue_isLess(&tree->elements[value->node.right], value));
+    int leftHeight = checkSubtree(tree, value->node.left, index);
+    int rightHeight = checkSubtree(tree, value->node.right, index);
+    switch (value->node.parent & 3) {
+        case TestCompactTree_balanced: assert(leftHeight == rightHeight); break;
+        case TestCompactTree_leftHeavy: assert(leftHeight == rightHeight + 1); break;
+        case TestCompactTree_rightHeavy: assert(rightHeight == leftHeight + 1); break;
+        default: assert(false);
+    }
+    return ((leftHeight > rightHeight) ? leftHeight : rightHeight) + 1;
+}
+
+static void checkTree(const TestCompactTree *tree) {
+    uint32_t root = TestCompactTree_getRoot(tree);
+    checkSubtree(tree, root, 0);
+    if (root != 0) {
+        assert(tree->leftmost == TestCompactTree_findMin(tree, root));
+        assert(tree->rightmost == TestCompactTree_findMax(tree, root));
+    } else {
+        assert(tree->leftmost == 0);
+        assert(tree->rightmost == 0);
+    }
+}
+
+static void testConsistency(size_t count) {
+    CompactValue *values = createCompactValues(count);
+    uint32_t *indices = createPermutation(count);
+    if (count > 2) values[2].key = values[1].key; // duplicate key
+    TestCompactTree tree;
+    TestCompactTree_initialize(&tree, values);
+    for (size_t i = 0; i < count; ++i) {
+        TestCompactTree_insert(&tree, indices[i]);
+        if (count < 100 || i % 100 == 0) checkTree(&tree);
+    }
+    checkTree(&tree);
+    for (size_t i = 1; i <= count; ++i) {
+        uint32_t found = TestCompactTree_find(&tree, &values[i]);
+        assert(found != 0 && values[found].key == values[i].key);
+        CompactValue key = { .key = values[i].key + 1 };
+        uint32_t lower = TestCompactTree_lowerBound(&tree, &key);
+        assert(lower == 0 || values[lower].key >= key.key);
+    }
+    // Remove half of the elements in random order, then all the others by minimum
+    for (size_t i = 0; i < count / 2; ++i) {
+        TestCompactTree_remove(&tree, indices[i]);
+        if (count < 100 || i % 100 == 0) checkTree(&tree);
+        assert(TestCompactTree_find(&tree, &values[indices[i]]) == 0 || values[indices[i]].key == values[1].key);
+    }
+    checkTree(&tree);
+    uint64_t previousKey = 0;
+    for (size_t i = count / 2; i < count; ++i) {
+        uint32_t min = tree.leftmost;
+        assert(min != 0 && values[min].key >= previousKey);
+        previousKey = values[min].key;
+        TestCompactTree_remove(&tree, min);
+    }
+    assert(TestCompactTree_isEmpty(&tree));
+    free(indices);
+    free(values);
+}
+#endif
+
+static volatile uintptr_t benchmarkSink;
+
+/**
+ * Measures insertion, successful lookup and removal of all elements in random
+ * order, in ticks per operation, using pointer links and index links.
+ */
+static void testPerformance(size_t count) {
+    uint32_t *indices = createPermutation(count);
+    CompactValue *compactValues = createCompactValues(count);
+    Value *values = (Value *) malloc((count + 1) * sizeof(Value));
+    for (size_t i = 0; i <= count; ++i) {
+        values[i].key = compactValues[i].key;
+    }
+    uintptr_t sink = 0;
+    // Pointer links
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        TestAvlTree_insert(&tree, &values[indices[i]].node);
+    }
+    uint64_t te = tscStopwatchEnd();
+    double insertTicks = (double) (te - tb) / count;
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        sink += (uintptr_t) TestAvlTree_find(&tree, &values[indices[count - 1 - i]].node);
+    }
+    te = tscStopwatchEnd();
+    double findTicks = (double) (te - tb) / count;
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        AvlTree_remove(&tree, &values[indices[i]].node);
+    }
+    te = tscStopwatchEnd();
+    double removeTicks = (double) (te - tb) / count;
+    // Index links
+    TestCompactTree compactTree;
+    TestCompactTree_initialize(&compactTree, compactValues);
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        TestCompactTree_insert(&compactTree, indices[i]);
+    }
+    te = tscStopwatchEnd();
+    double compactInsertTicks = (double) (te - tb) / count;
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        sink += TestCompactTree_find(&compactTree, &compactValues[indices[count - 1 - i]]);
+    }
+    te = tscStopwatchEnd();
+    double compactFindTicks = (double) (te - tb) / count;
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        TestCompactTree_remove(&compactTree, indices[i]);
+    }
+    te = tscStopwatchEnd();
+    double compactRemoveTicks = (double) (te - tb) / count;
+    benchmarkSink = sink;
+    printf("%zu,%g,%g,%g,%g,%g,%g\n", count, insertTicks, compactInsertTicks, findTicks, compactFindTicks, removeTicks, compactRemoveTicks);
+    free(values);
+    free(compactValues);
+    free(indices);
+}
+
+int main() {
+    printf("Element size: pointer links %zu, index links %zu\n", sizeof(Value), sizeof(CompactValue));
+    srand48(time(NULL));
+    #ifndef NDEBUG
+    for (size_t i = 0; i < 10; ++i) {
+        printf("Round %zu\n", i);
+        testConsistency(1);
+        testConsistency(2);
+        testConsistency(3);
+        testConsistency(10);
+        testConsistency(5000);
+    }
+    #else
+    printf("Random order benchmark\n");
+    printf("Node count,Insert,Compact insert,Find,Compact find,Remove,Compact remove\n");
+    testPerformance(1000);
+    testPerformance(10000);
+    testPerformance(100000);
+    testPerformance(1000000);
+    testPerformance(3000000);
+    testPerformance(5000000);
+    testPerformance(10000000);
+    #endif
+    return 0;
+}
@@ -0,0 +1,456 @@
+/*
+Test code for the key-cached intrusive d-ary min-heap container.
+Copyright 2012-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <math.h>
+#include "DaryHeap.h"
+#include "tscStopwatch.h"
+
+/** Arity of the heap under test, either 4 or 8, override on the command line to compare. */
+#ifndef DARYHEAP_ARITY
+#define DARYHEAP_ARITY 4
+#endif
+
+#if DARYHEAP_ARITY == 4
+#define findMinChild DaryHeap_findMin4x64
+#elif DARYHEAP_ARITY == 8
+#define findMinChild DaryHeap_findMin8x64
+#else
+#error "DARYHEAP_ARITY must be 4 or 8"
+#endif
+
+KeyedDaryHeap_header(TestHeap, uint64_t, DARYHEAP_ARITY);
+
+typedef struct Value {
+    uint64_t key;
+    TestHeap_Node node;
+    char dummy[64 - sizeof(TestHeap_Node) - sizeof(uint64_t)];
+} Value;
+
+static inline Value *Value_fromNode(TestHeap_Node *node) {
+    return (Value *) ((uint8_t *) node - offsetof(Value, node));
+}
+
+KeyedDaryHeap_implementation(TestHeap, uint64_t, DARYHEAP_ARITY, findMinChild);
+
+static uint64_t nextKey = 0;
+
+static void randomizeKey(Value *value) {
+    value->key = ((uint64_t) lrand48() << 32) | lrand48();
+    //value->key = nextKey++;
+}
+
+static Value *createValues(size_t nodeCount) {
+    Value *values = malloc(nodeCount * sizeof(Value));
+    memset(values, 0, nodeCount * sizeof(Value));
+    srand48(time(NULL));
+    for (size_t i = 0; i < nodeCount; ++i) {
+        randomizeKey(&values[i]);
+    }
+    values[lrand48() % nodeCount].key = 0;
+    values[lrand48() % nodeCount].key = 1;
+    values[lrand48() % nodeCount].key = UINT64_MAX - 1;
+    values[lrand48() % nodeCount].key = UINT64_MAX;
+    return values;
+}
+
+#ifndef NDEBUG
+/** Checks the SIMD minimum child selection against a plain loop on random keys with many ties. */
+static void testFindMinConsistency(size_t roundCount) {
+    uint32_t keys32[8];
+    uint64_t keys64[8];
+    for (size_t r = 0; r < roundCount; ++r) {
+        for (size_t i = 0; i < 8; ++i) {
+            keys32[i] = (lrand48() & 1) ? UINT32_MAX - lrand48() % 4 : lrand48() % 4;
+            keys64[i] = (lrand48() & 1) ? UINT64_MAX - lrand48() % 4 : lrand48() % 4;
+        }
+        unsigned least4x32 = 0, least8x32 = 0, least4x64 = 0, least8x64 = 0;
+        for (unsigned i = 1; i < 8; ++i) {
+            if (i < 4 && keys32[i] < keys32[least4x32]) least4x32 = i;
+            if (keys32[i] < keys32[least8x32]) least8x32 = i;
+            if (i < 4 && keys64[i] < keys64[least4x64]) least4x64 = i;
+            if (keys64[i] < keys64[least8x64]) least8x64 = i;
+        }
+        assert(DaryHeap_findMin4x32(keys32) == least4x32);
+        assert(DaryHeap_findMin8x32(keys32) == least8x32);
+        assert(DaryHeap_findMin4x64(keys64) == least4x64);
+        assert(DaryHeap_findMin8x64(keys64) == least8x64);
+    }
+}
+
+static bool isPresent(Value **arr, size_t size, Value *node) {
+    for (size_t i = 0; i < size; ++i) {
+        if (arr[i] == node) return true;
+    }
+    return false;
+}
+
+static void testConsistency(size_t nodeCount) {
+    Value **seenValues = malloc(nodeCount * sizeof(Value *));
+    size_t seenValuesSize;
+    Value *values = createValues(nodeCount);
+    TestHeap heap;
+    uint64_t *keys = malloc(TestHeap_getSlotCount(nodeCount) * sizeof(uint64_t));
+    TestHeap_Node **nodes = malloc(TestHeap_getSlotCount(nodeCount) * sizeof(TestHeap_Node *));
+    TestHeap_initialize(&heap, keys, nodes, nodeCount);
+    // Test minimum element removal
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestHeap_insert(&heap, &values[i].node, values[i].key);
+        TestHeap_check(&heap);
+    }
+    seenValuesSize = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        assert(!TestHeap_isEmpty(&heap));
+        Value *value = Value_fromNode(TestHeap_poll(&heap));
+        TestHeap_check(&heap);
+        assert(!isPresent(seenValues, seenValuesSize, value));
+        seenValues[seenValuesSize] = value;
+        seenValuesSize++;
+        printf("Polled %zu: %016" PRIX64 "\n", i, value->key);
+        assert(i == 0 || seenValues[i - 1]->key <= seenValues[i]->key);
+    }
+    assert(TestHeap_isEmpty(&heap));
+    // Test random removal
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestHeap_insert(&heap, &values[i].node, values[i].key);
+        TestHeap_check(&heap);
+    }
+    seenValuesSize = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        assert(!TestHeap_isEmpty(&heap));
+        TestHeap_remove(&heap, &values[i].node);
+        TestHeap_check(&heap);
+        assert(!isPresent(seenValues, seenValuesSize, &values[i]));
+        seenValues[seenValuesSize] = &values[i];
+        seenValuesSize++;
+        printf("Removed %zu: %016" PRIX64 "\n", i, values[i].key);
+    }
+    assert(TestHeap_isEmpty(&heap));
+    // Test combined poll and insert
+    for (size_t i = 0; i < nodeCount / 2; ++i) {
+        TestHeap_insert(&heap, &values[i].node, values[i].key);
+        TestHeap_check(&heap);
+    }
+    seenValuesSize = 0;
+    for (size_t i = 0; i < nodeCount / 2; ++i) {
+        assert(!TestHeap_isEmpty(&heap));
+        Value *value = Value_fromNode(TestHeap_pollAndInsert(&heap, &values[i + nodeCount / 2].node, values[i + nodeCount / 2].key));
+        TestHeap_check(&heap);
+        assert(!isPresent(seenValues, seenValuesSize, &values[i]));
+        seenValues[seenValuesSize] = &values[i];
+        seenValuesSize++;
+        printf("Removed %zu: %016" PRIX64 "\tInserted %016" PRIX64 "\n", i, value->key, values[i].key);
+    }
+    for (size_t i = 0; i < nodeCount / 2; ++i) {
+        TestHeap_poll(&heap);
+    }
+    assert(TestHeap_isEmpty(&heap));
+    // Test key updates
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestHeap_insert(&heap, &values[i].node, values[i].key);
+    }
+    for (size_t i = 0; i < nodeCount; ++i) {
+        randomizeKey(&values[i]);
+        TestHeap_update(&heap, &values[i].node, values[i].key);
+        TestHeap_check(&heap);
+    }
+    seenValuesSize = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        Value *value = Value_fromNode(TestHeap_poll(&heap));
+        seenValues[seenValuesSize] = value;
+        seenValuesSize++;
+        assert(i == 0 || seenValues[i - 1]->key <= seenValues[i]->key);
+    }
+    assert(TestHeap_isEmpty(&heap));
+    free(seenValues);
+    free(nodes);
+    free(keys);
+    free(values);
+}
+#endif
+
+static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    TestHeap heap;
+    uint64_t *keys = malloc(TestHeap_getSlotCount(nodeCount) * sizeof(uint64_t));
+    TestHeap_Node **nodes = malloc(TestHeap_getSlotCount(nodeCount) * sizeof(TestHeap_Node *));
+    TestHeap_initialize(&heap, keys, nodes, nodeCount);
+    for (size_t i = 0; i < nodeCount - 1; ++i) {
+        TestHeap_insert(&heap, &values[i].node, values[i].key);
+    }
+    double insertMean = 0;
+    double removeMean = 0;
+    double insertVar = 0;
+    double removeVar = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Insert
+        size_t i = nodeCount - 1;
+        randomizeKey(&values[i]);
+        uint64_t tb = tscStopwatchBegin();
+        TestHeap_insert(&heap, &values[i].node, values[i].key);
+        uint64_t te = tscStopwatchEnd();
+        double delta = (double) (te - tb) - insertMean;
+        insertMean += delta / (double) (r + 1);
+        double delta2 = (double) (te - tb) - insertMean;
+        insertVar += delta * delta2;
+        // Remove node just inserted
+        tb = tscStopwatchBegin();
+        TestHeap_remove(&heap, &values[i].node);
+        te = tscStopwatchEnd();
+        delta = (double) (te - tb) - removeMean;
+        removeMean += delta / (double) (r + 1);
+        delta2 = (double) (te - tb) - removeMean;
+        removeVar += delta * delta2;
+    }
+    printf("%zu,%g,%g,%g,%g\n", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    free(nodes);
+    free(keys);
+    free(values);
+}
+
+static void testMinimumRemovalPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    TestHeap heap;
+    uint64_t *keys = malloc(TestHeap_getSlotCount(nodeCount) * sizeof(uint64_t));
+    TestHeap_Node **nodes = malloc(TestHeap_getSlotCount(nodeCount) * sizeof(TestHeap_Node *));
+    TestHeap_initialize(&heap, keys, nodes, nodeCount);
+    for (size_t i = 0; i < nodeCount - 1; ++i) {
+        TestHeap_insert(&heap, &values[i].node, values[i].key);
+    }
+    Value *value = &values[nodeCount - 1];
+    double insertMean = 0;
+    double removeMean = 0;
+    double insertVar = 0;
+    double removeVar = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Insert
+        randomizeKey(value);
+        uint64_t tb = tscStopwatchBegin();
+        TestHeap_insert(&heap, &value->node, value->key);
+        uint64_t te = tscStopwatchEnd();
+        double delta = (double) (te - tb) - insertMean;
+        insertMean += delta / (double) (r + 1);
+        double delta2 = (double) (te - tb) - insertMean;
+        insertVar += delta * delta2;
+        // Remove minimum
+        tb = tscStopwatchBegin();
+        value = Value_fromNode(TestHeap_poll(&heap));
+        te = tscStopwatchEnd();
+        delta = (double) (te - tb) - removeMean;
+        removeMean += delta / (double) (r + 1);
+        delta2 = (double) (te - tb) - removeMean;
+        removeVar += delta * delta2;
+    }
+    printf("%zu,%g,%g,%g,%g\n", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    free(nodes);
+    free(keys);
+    free(values);
+}
+
+static void testPollAndInsertPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    TestHeap heap;
+    uint64_t *keys = malloc(TestHeap_getSlotCount(nodeCount) * sizeof(uint64_t));
+    TestHeap_Node **nodes = malloc(TestHeap_getSlotCount(nodeCount) * sizeof(TestHeap_Node *));
+    TestHeap_initialize(&heap, keys, nodes, nodeCount);
+    for (size_t i = 0; i < nodeCount - 1; ++i) {
+        TestHeap_insert(&heap, &values[i].node, values[i].key);
+    }
+    Value *value = &values[nodeCount - 1];
+    double insertMean = 0;
+    double insertVar = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Insert
+        randomizeKey(value);
+        uint64_t tb = tscStopwatchBegin();
+        value = Value_fromNode(TestHeap_pollAndInsert(&heap, &value->node, value->key));
+        uint64_t te = tscStopwatchEnd();
+        double delta = (double) (te - tb) - insertMean;
+        insertMean += delta / (double) (r + 1);
+        double delta2 = (double) (te - tb) - insertMean;
+        insertVar += delta * delta2;
+    }
+    printf("%zu,%g,%g\n", nodeCount, insertMean, sqrt(insertVar / (roundCount - 1)));
+    free(nodes);
+    free(keys);
+    free(values);
+}
+
+static void testFullCyclePerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    TestHeap heap;
+    uint64_t *keys = malloc(TestHeap_getSlotCount(nodeCount) * sizeof(uint64_t));
+    TestHeap_Node **nodes = malloc(TestHeap_getSlotCount(nodeCount) * sizeof(TestHeap_Node *));
+    TestHeap_initialize(&heap, keys, nodes, nodeCount);
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t r = 0; r < roundCount; ++r) {
+        for (size_t i = 0; i < nodeCount; i++) {
+            TestHeap_insert(&heap, &values[i].node, values[i].key);
+        }
+        for (size_t i = 0; i < nodeCount; i++) {
+            TestHeap_poll(&heap);
+        }
+    }
+    uint64_t te = tscStopwatchEnd();
+    printf("%zu,%g\n", nodeCount, (double) (te - tb) / roundCount / nodeCount);
+    free(nodes);
+    free(keys);
+    free(values);
+}
+
+static void burstRandomRemovalPerformance(size_t roundCount) {
+    testRandomRemovalPerformance(1, roundCount);
+    testRandomRemovalPerformance(3, roundCount);
+    testRandomRemovalPerformance(5, roundCount);
+    testRandomRemovalPerformance(10, roundCount);
+    testRandomRemovalPerformance(30, roundCount);
+    testRandomRemovalPerformance(50, roundCount);
+    testRandomRemovalPerformance(100, roundCount);
+    testRandomRemovalPerformance(300, roundCount);
+    testRandomRemovalPerformance(500, roundCount);
+    testRandomRemovalPerformance(1000, roundCount);
+    testRandomRemovalPerformance(3000, roundCount);
+    testRandomRemovalPerformance(5000, roundCount);
+    testRandomRemovalPerformance(10000, roundCount);
+    testRandomRemovalPerformance(30000, roundCount);
+    testRandomRemovalPerformance(50000, roundCount);
+    testRandomRemovalPerformance(100000, roundCount);
+    testRandomRemovalPerformance(300000, roundCount);
+    testRandomRemovalPerformance(1000000, roundCount);
+    testRandomRemovalPerformance(3000000, roundCount);
+    testRandomRemovalPerformance(5000000, roundCount);
+    testRandomRemovalPerformance(10000000, roundCount);
+}
+
+static void burstMinimumRemovalPerformance(size_t roundCount) {
+    testMinimumRemovalPerformance(1, roundCount);
+    testMinimumRemovalPerformance(3, roundCount);
+    testMinimumRemovalPerformance(5, roundCount);
+    testMinimumRemovalPerformance(10, roundCount);
+    testMinimumRemovalPerformance(30, roundCount);
+    testMinimumRemovalPerformance(50, roundCount);
+    testMinimumRemovalPerformance(100, roundCount);
+    testMinimumRemovalPerformance(300, roundCount);
+    testMinimumRemovalPerformance(500, roundCount);
+    testMinimumRemovalPerformance(1000, roundCount);
+    testMinimumRemovalPerformance(3000, roundCount);
+    testMinimumRemovalPerformance(5000, roundCount);
+    testMinimumRemovalPerformance(10000, roundCount);
+    testMinimumRemovalPerformance(30000, roundCount);
+    testMinimumRemovalPerformance(50000, roundCount);
+    testMinimumRemovalPerformance(100000, roundCount);
+    testMinimumRemovalPerformance(300000, roundCount);
+    testMinimumRemovalPerformance(1000000, roundCount);
+    testMinimumRemovalPerformance(3000000, roundCount);
+    testMinimumRemovalPerformance(5000000, roundCount);
+    testMinimumRemovalPerformance(10000000, roundCount);
+}
+
+static void burstPollAndInsertPerformance(size_t roundCount) {
+    testPollAndInsertPerformance(2, roundCount);
+    testPollAndInsertPerformance(3, roundCount);
+    testPollAndInsertPerformance(5, roundCount);
+    testPollAndInsertPerformance(10, roundCount);
+    testPollAndInsertPerformance(30, roundCount);
+    testPollAndInsertPerformance(50, roundCount);
+    testPollAndInsertPerformance(100, roundCount);
+    testPollAndInsertPerformance(300, roundCount);
+    testPollAndInsertPerformance(500, roundCount);
+    testPollAndInsertPerformance(1000, roundCount);
+    testPollAndInsertPerformance(3000, roundCount);
+    testPollAndInsertPerformance(5000, roundCount);
+    testPollAndInsertPerformance(10000, roundCount);
+    testPollAndInsertPerformance(30000, roundCount);
+    testPollAndInsertPerformance(50000, roundCount);
+    testPollAndInsertPerformance(100000, roundCount);
+    testPollAndInsertPerformance(300000, roundCount);
+    testPollAndInsertPerformance(1000000, roundCount);
+    testPollAndInsertPerformance(3000000, roundCount);
+    testPollAndInsertPerformance(5000000, roundCount);
+    testPollAndInsertPerformance(10000000, roundCount);
+}
+
+static void burstFullCyclePerformance(size_t roundCount) {
+    testFullCyclePerformance(1, roundCount);
+    testFullCyclePerformance(3, roundCount);
+    testFullCyclePerformance(5, roundCount);
+    testFullCyclePerformance(10, roundCount);
+    testFullCyclePerformance(30, roundCount);
+    testFullCyclePerformance(50, roundCount);
+    testFullCyclePerformance(100, roundCount);
+    testFullCyclePerformance(300, roundCount);
+    testFullCyclePerformance(500, roundCount);
+    testFullCyclePerformance(1000, roundCount);
+    testFullCyclePerformance(3000, roundCount);
+    testFullCyclePerformance(5000, roundCount);
+    testFullCyclePerformance(10000, roundCount);
+    if (roundCount < 100) {
+        testFullCyclePerformance(30000, roundCount);
+        testFullCyclePerformance(50000, roundCount);
+        testFullCyclePerformance(100000, roundCount);
+        testFullCyclePerformance(300000, roundCount);
+        testFullCyclePerformance(1000000, roundCount);
+        testFullCyclePerformance(3000000, roundCount);
+        testFullCyclePerformance(5000000, roundCount);
+        testFullCyclePerformance(10000000, roundCount);
+    }
+}
+
+int main() {
+    printf("Value size: %zu\n", sizeof(Value));
+    printf("Arity: %d\n", DARYHEAP_ARITY);
+    #if !defined(DARYHEAP_NO_SIMD) && defined(__AVX2__)
+    printf("Using AVX2\n");
+    #elif !defined(DARYHEAP_NO_SIMD) && defined(__SSE4_1__)
+    printf("Using SSE4.1\n");
+    #endif
+    #ifndef NDEBUG
+    testFindMinConsistency(100000);
+    for (size_t i = 0; i < 10; ++i) {
+        printf("Round %zu\n", i);
+        testConsistency(5000);
+    }
+    #else
+    printf("Random removal benchmark\n");
+    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev\n");
+    burstRandomRemovalPerformance(1000000);
+    printf("Minimum removal benchmark\n");
+    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev\n");
+    burstMinimumRemovalPerformance(1000000);
+    printf("Poll and insert benchmark\n");
+    printf("Node count,Ins. mean,Ins. stddev\n");
+    burstPollAndInsertPerformance(1000000);
+    printf("Full cycle benchmark\n");
+    burstFullCyclePerformance(1000);
+    #endif
+}
@@ -121,6 +121,25 @@ static void testConsistency(size_t nodeCount) {
         printf("Removed %zu: %016" PRIX64 "\n", i, values[i].key);
     }
     assert(TestHeap_isEmpty(&heap));
+    TestHeap_Node **nodes = malloc(nodeCount * sizeof(TestHeap_Node *));
+    for (size_t i = 0; i < nodeCount; ++i) {
+        nodes[i] = &values[i].node;
+    }
+    // Test batched insertion
+    for (size_t i = 0, batch = 1; i < nodeCount; i += batch, batch = batch % 100 + 1) {
+        TestHeap_insertMany(&heap, &nodes[i], (batch < nodeCount - i) ? batch : nodeCount - i);
+        TestHeap_check(&heap);
+    }
+    seenValuesSize = 0;
+    while (!TestHeap_isEmpty(&heap)) {
+        Value *value = Value_fromNode(TestHeap_poll(&heap));
+        assert(!isPresent(seenValues, seenValuesSize, value));
+        seenValues[seenValuesSize] = value;
+        seenValuesSize++;
+        assert(seenValuesSize == 1 || seenValues[seenValuesSize - 2]->key <= value->key);
+    }
+    assert(seenValuesSize == nodeCount);
+    free(nodes);
     free(seenValues);
     free(values);
 }
@@ -214,6 +233,68 @@ static void testFullCyclePerformance(size_t nodeCount, size_t roundCount) {
     free(values);
 }
 
+static void testBatchPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    TestHeap heap;
+    TestHeap_initialize(&heap);
+    for (size_t i = 0; i < nodeCount; i++) {
+        TestHeap_insert(&heap, &values[i].node);
+    }
+    const size_t batchSize = (nodeCount < 64) ? nodeCount : 64;
+    TestHeap_Node *batch[64];
+    uint64_t singleTicks = 0;
+    uint64_t batchTicks = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Single insertions
+        for (size_t i = 0; i < batchSize; i++) {
+            batch[i] = TestHeap_poll(&heap);
+            randomizeKey(Value_fromNode(batch[i]));
+        }
+        uint64_t tb = tscStopwatchBegin();
+        for (size_t i = 0; i < batchSize; i++) {
+            TestHeap_insert(&heap, batch[i]);
+        }
+        uint64_t te = tscStopwatchEnd();
+        singleTicks += te - tb;
+        // Batched insertion
+        for (size_t i = 0; i < batchSize; i++) {
+            batch[i] = TestHeap_poll(&heap);
+            randomizeKey(Value_fromNode(batch[i]));
+        }
+        tb = tscStopwatchBegin();
+        TestHeap_insertMany(&heap, batch, batchSize);
+        te = tscStopwatchEnd();
+        batchTicks += te - tb;
+    }
+    double divisor = (double) roundCount * batchSize;
+    printf("%zu,%g,%g\n", nodeCount, singleTicks / divisor, batchTicks / divisor);
+    free(values);
+}
+
+static void burstBatchPerformance(size_t roundCount) {
+    testBatchPerformance(1, roundCount);
+    testBatchPerformance(3, roundCount);
+    testBatchPerformance(5, roundCount);
+    testBatchPerformance(10, roundCount);
+    testBatchPerformance(30, roundCount);
+    testBatchPerformance(50, roundCount);
+    testBatchPerformance(100, roundCount);
+    testBatchPerformance(300, roundCount);
+    testBatchPerformance(500, roundCount);
+    testBatchPerformance(1000, roundCount);
+    testBatchPerformance(3000, roundCount);
+    testBatchPerformance(5000, roundCount);
+    testBatchPerformance(10000, roundCount);
+    testBatchPerformance(30000, roundCount);
+    testBatchPerformance(50000, roundCount);
+    testBatchPerformance(100000, roundCount);
+    testBatchPerformance(300000, roundCount);
+    testBatchPerformance(1000000, roundCount);
+    testBatchPerformance(3000000, roundCount);
+    testBatchPerformance(5000000, roundCount);
+    testBatchPerformance(10000000, roundCount);
+}
+
 static void burstRandomRemovalPerformance(size_t roundCount) {
     testRandomRemovalPerformance(1, roundCount);
     testRandomRemovalPerformance(3, roundCount);
@@ -304,5 +385,8 @@ int main() {
     burstMinimumRemovalPerformance(1000000);
     printf("Full cycle benchmark\n");
     burstFullCyclePerformance(1000);
+    printf("Batch insertion benchmark (64 inserts after 64 untimed polls)\n");
+    printf("Node count,Single,Batch\n");
+    burstBatchPerformance(10000);
     #endif
 }
@@ -36,7 +36,12 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "LimitedPriorityQueue.h"
 #include "tscStopwatch.h"
 
-LimitedPriorityQueue_header(TestQueue, 256);
+/* Queues with up to 64, 4096 and 262144 priorities have 1, 2 and 3 levels of bitmaps */
+#ifndef LIMITEDPRIORITYQUEUE_PRIORITY_COUNT
+#define LIMITEDPRIORITYQUEUE_PRIORITY_COUNT 256
+#endif
+
+LimitedPriorityQueue_header(TestQueue, LIMITEDPRIORITYQUEUE_PRIORITY_COUNT);
 
 typedef struct Value {
     TestQueue_Node node;
@@ -52,10 +57,10 @@ static inline int Value_getKey(TestQueue_Node *node) {
     return Value_fromNode(node)->key;
 }
 
-LimitedPriorityQueue_implementation(TestQueue, 256, unsigned, Value_getKey);
+LimitedPriorityQueue_implementation(TestQueue, LIMITEDPRIORITYQUEUE_PRIORITY_COUNT, unsigned, Value_getKey);
 
 static void randomizeKey(Value *value) {
-    value->key = (unsigned) lrand48() & 255;
+    value->key = (unsigned) lrand48() % LIMITEDPRIORITYQUEUE_PRIORITY_COUNT;
 }
 
 static Value *createValues(size_t nodeCount) {
@@ -67,8 +72,8 @@ static Value *createValues(size_t nodeCount) {
     }
     nodes[lrand48() % nodeCount].key = 0;
     nodes[lrand48() % nodeCount].key = 1;
-    nodes[lrand48() % nodeCount].key = 254;
-    nodes[lrand48() % nodeCount].key = 255;
+    nodes[lrand48() % nodeCount].key = LIMITEDPRIORITYQUEUE_PRIORITY_COUNT - 2;
+    nodes[lrand48() % nodeCount].key = LIMITEDPRIORITYQUEUE_PRIORITY_COUNT - 1;
     return nodes;
 }
 
@@ -84,48 +89,54 @@ static void testConsistency(size_t nodeCount) {
     Value **seenValues = malloc(nodeCount * sizeof(Value *));
     size_t seenValuesSize;
     Value *values = createValues(nodeCount);
-    TestQueue queue;
-    TestQueue_initialize(&queue);
+    TestQueue *queue = malloc(sizeof(TestQueue));
+    TestQueue_initialize(queue);
     // Test minimum element removal
     for (size_t i = 0; i < nodeCount; ++i) {
-        TestQueue_insert(&queue, &values[i].node);
+        TestQueue_insert(queue, &values[i].node);
+        if (i % 100 == 0) TestQueue_check(queue);
     }
+    TestQueue_check(queue);
     seenValuesSize = 0;
     for (size_t i = 0; i < nodeCount; ++i) {
-        assert(!TestQueue_isEmpty(&queue));
-        Value *value = Value_fromNode(TestQueue_poll(&queue));
+        assert(!TestQueue_isEmpty(queue));
+        Value *value = Value_fromNode(TestQueue_poll(queue));
+        if (i % 100 == 0) TestQueue_check(queue);
         assert(!isPresent(seenValues, seenValuesSize, value));
         seenValues[seenValuesSize] = value;
         seenValuesSize++;
         printf("Polled %zu: %d\n", i, value->key);
         assert(i == 0 || seenValues[i - 1]->key  <= seenValues[i]->key);
     }
-    assert(TestQueue_isEmpty(&queue));
+    assert(TestQueue_isEmpty(queue));
     // Test random removal
     for (size_t i = 0; i < nodeCount; ++i) {
-        TestQueue_insert(&queue, &values[i].node);
+        TestQueue_insert(queue, &values[i].node);
     }
     seenValuesSize = 0;
     for (size_t i = 0; i < nodeCount; ++i) {
-        assert(!TestQueue_isEmpty(&queue));
-        TestQueue_remove(&queue, &values[i].node);
+        assert(!TestQueue_isEmpty(queue));
+        TestQueue_remove(queue, &values[i].node);
+        if (i % 100 == 0) TestQueue_check(queue);
         assert(!isPresent(seenValues, seenValuesSize, &values[i]));
         seenValues[seenValuesSize] = &values[i];
         seenValuesSize++;
         printf("Removed %zu: %d\n", i, values[i].key);
     }
-    assert(TestQueue_isEmpty(&queue));
+    assert(TestQueue_isEmpty(queue));
+    TestQueue_check(queue);
     free(seenValues);
+    free(queue);
     free(values);
 }
 #endif
 
 static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
     Value *values = createValues(nodeCount);
-    TestQueue queue;
-    TestQueue_initialize(&queue);
+    TestQueue *queue = malloc(sizeof(TestQueue));
+    TestQueue_initialize(queue);
     for (size_t i = 0; i < nodeCount - 1; ++i) {
-        TestQueue_insert(&queue, &values[i].node);
+        TestQueue_insert(queue, &values[i].node);
     }
     double insertMean = 0;
     double removeMean = 0;
@@ -136,7 +147,7 @@ static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
         size_t i = nodeCount - 1;
         randomizeKey(&values[i]);
         uint64_t tb = tscStopwatchBegin();
-        TestQueue_insert(&queue, &values[i].node);
+        TestQueue_insert(queue, &values[i].node);
         uint64_t te = tscStopwatchEnd();
         double delta = (double) (te - tb) - insertMean;
         insertMean += delta / (double) (r + 1);
@@ -144,7 +155,7 @@ static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
         insertVar += delta * delta2;
         // Remove node just inserted
         tb = tscStopwatchBegin();
-        TestQueue_remove(&queue, &values[i].node);
+        TestQueue_remove(queue, &values[i].node);
         te = tscStopwatchEnd();
         delta = (double) (te - tb) - removeMean;
         removeMean += delta / (double) (r + 1);
@@ -152,15 +163,16 @@ static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
         removeVar += delta * delta2;
     }
     printf("%zu,%g,%g,%g,%g\n", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    free(queue);
     free(values);
 }
 
 static void testMinimumRemovalPerformance(size_t nodeCount, size_t roundCount) {
     Value *values = createValues(nodeCount);
-    TestQueue queue;
-    TestQueue_initialize(&queue);
+    TestQueue *queue = malloc(sizeof(TestQueue));
+    TestQueue_initialize(queue);
     for (size_t i = 0; i < nodeCount - 1; ++i) {
-        TestQueue_insert(&queue, &values[i].node);
+        TestQueue_insert(queue, &values[i].node);
     }
     Value *value = &values[nodeCount - 1];
     double insertMean = 0;
@@ -171,7 +183,7 @@ static void testMinimumRemovalPerformance(size_t nodeCount, size_t roundCount) {
         // Insert
         randomizeKey(value);
         uint64_t tb = tscStopwatchBegin();
-        TestQueue_insert(&queue, &value->node);
+        TestQueue_insert(queue, &value->node);
         uint64_t te = tscStopwatchEnd();
         double delta = (double) (te - tb) - insertMean;
         insertMean += delta / (double) (r + 1);
@@ -179,7 +191,7 @@ static void testMinimumRemovalPerformance(size_t nodeCount, size_t roundCount) {
         insertVar += delta * delta2;
         // Remove minimum
         tb = tscStopwatchBegin();
-        value = Value_fromNode(TestQueue_poll(&queue));
+        value = Value_fromNode(TestQueue_poll(queue));
         te = tscStopwatchEnd();
         delta = (double) (te - tb) - removeMean;
         removeMean += delta / (double) (r + 1);
@@ -187,24 +199,26 @@ static void testMinimumRemovalPerformance(size_t nodeCount, size_t roundCount) {
         removeVar += delta * delta2;
     }
     printf("%zu,%g,%g,%g,%g\n", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    free(queue);
     free(values);
 }
 
 static void testFullCyclePerformance(size_t nodeCount, size_t roundCount) {
     Value *values = createValues(nodeCount);
-    TestQueue queue;
-    TestQueue_initialize(&queue);
+    TestQueue *queue = malloc(sizeof(TestQueue));
+    TestQueue_initialize(queue);
     uint64_t tb = tscStopwatchBegin();
     for (size_t r = 0; r < roundCount; ++r) {
         for (size_t i = 0; i < nodeCount; i++) {
-            TestQueue_insert(&queue, &values[i].node);
+            TestQueue_insert(queue, &values[i].node);
         }
         for (size_t i = 0; i < nodeCount; i++) {
-            TestQueue_poll(&queue);
+            TestQueue_poll(queue);
         }
     }
     uint64_t te = tscStopwatchEnd();
     printf("%zu,%g\n", nodeCount, (double) (te - tb) / roundCount / nodeCount);
+    free(queue);
     free(values);
 }
 
@@ -284,6 +298,7 @@ static void burstFullCyclePerformance(size_t roundCount) {
 
 int main() {
     printf("Value size: %zu\n", sizeof(Value));
+    printf("Priority count: %d, bitmap levels: %d, queue size: %zu\n", LIMITEDPRIORITYQUEUE_PRIORITY_COUNT, TestQueue_levelCount, sizeof(TestQueue));
     #ifndef NDEBUG
     for (size_t i = 0; i < 10; ++i) {
         printf("Round %zu\n", i);
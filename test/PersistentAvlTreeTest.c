@@ -0,0 +1,333 @@
+/*
+Test bench for persistent AVL tree container.
+Copyright 2015-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "AvlTree.h"
+#include "PersistentAvlTree.h"
+#include "tscStopwatch.h"
+
+/** Element of the persistent tree: a key and a pointer to the timer it refers to. */
+typedef struct Entry {
+    uint64_t key;
+    void *timer;
+} Entry;
+
+static inline bool Entry_isLess(const Entry *a, const Entry *b) {
+    return a->key < b->key;
+}
+
+PersistentAvlTree_header(TestPersistentTree, Entry)
+PersistentAvlTree_implementation(TestPersistentTree, Entry, Entry_isLess)
+
+/** Element of the intrusive tree, with the same key, for comparison. */
+typedef struct Value {
+    uint64_t key;
+    AvlTree_Node node;
+} Value;
+
+static inline Value *Value_fromNode(AvlTree_Node *n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, node));
+}
+
+static inline bool Value_isLess(AvlTree_Node *node, AvlTree_Node *other) {
+    return Value_fromNode(node)->key < Value_fromNode(other)->key;
+}
+
+AvlTree_instantiateInsert(TestAvlTree_insert, Value_isLess);
+
+static uint64_t randomKey() {
+    return ((uint64_t) lrand48() << 32) | lrand48();
+}
+
+static uint64_t *createKeys(size_t count) {
+    uint64_t *keys = (uint64_t *) malloc(count * sizeof(uint64_t));
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = randomKey();
+    }
+    return keys;
+}
+
+#ifndef NDEBUG
+static int compareKeys(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+/** Checks ordering and heights of a subtree, counting its nodes, returning its height. */
+static uint32_t checkSubtree(const TestPersistentTree_Node *node, size_t *count) {
+    if (node == NULL) return 0;
+    assert(node->refCount > 0);
+    if (node->left != NULL) assert(!Entry_isLess(&node->element, &node->left->element));
+    if (node->right != NULL) assert(!Entry_isLess(&node->right->element, &node->element));
+    uint32_t leftHeight = checkSubtree(node->left, count);
+    uint32_t rightHeight = checkSubtree(node->right, count);
+    assert(leftHeight <= rightHeight + 1 && rightHeight <= leftHeight + 1);
+    uint32_t height = ((leftHeight > rightHeight) ? leftHeight : rightHeight) + 1;
+    assert(node->height == height);
+    ++*count;
+    return height;
+}
+
+/** Checks that a version contains exactly the specified sorted keys. */
+static void checkVersion(const TestPersistentTree *tree, const uint64_t *sortedKeys, size_t count) {
+    size_t nodeCount = 0;
+    checkSubtree(tree->root, &nodeCount);
+    assert(nodeCount == count);
+    for (size_t i = 0; i < count; ++i) {
+        Entry key = { .key = sortedKeys[i] };
+        const Entry *found = TestPersistentTree_find(tree, &key);
+        assert(found != NULL && found->key == key.key);
+        assert(found->timer == (void *) (uintptr_t) key.key);
+        if (key.key == UINT64_MAX) continue;
+        key.key++;
+        const Entry *lower = TestPersistentTree_lowerBound(tree, &key);
+        size_t next = i + 1;
+        while (next < count && sortedKeys[next] < key.key) next++;
+        if (next < count) {
+            assert(lower != NULL && lower->key == sortedKeys[next]);
+        } else {
+            assert(lower == NULL);
+        }
+    }
+}
+
+/**
+ * Inserts and removes random keys taking a snapshot every few updates,
+ * checking that snapshots never change, and that all nodes go back to the
+ * pool when all versions are cleared.
+ */
+static void testConsistency(size_t count) {
+    enum { snapshotCount = 8 };
+    size_t poolSize = 4 * count + 64 * snapshotCount;
+    TestPersistentTree_Node *nodes = malloc(poolSize * sizeof(TestPersistentTree_Node));
+    TestPersistentTree_Pool pool;
+    TestPersistentTree_Pool_initialize(&pool, nodes, poolSize);
+    TestPersistentTree tree;
+    TestPersistentTree_initialize(&tree, &pool);
+    uint64_t *keys = createKeys(count);
+    if (count > 2) keys[2] = keys[1]; // duplicate key
+    TestPersistentTree snapshots[snapshotCount];
+    uint64_t *snapshotKeys[snapshotCount];
+    size_t snapshotSizes[snapshotCount];
+    size_t taken = 0;
+    size_t interval = (count + snapshotCount - 1) / snapshotCount;
+    uint64_t *sorted = malloc(count * sizeof(uint64_t));
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Entry entry = { .key = keys[i], .timer = (void *) (uintptr_t) keys[i] };
+        bool inserted = TestPersistentTree_insert(&tree, &entry);
+        assert(inserted);
+        sorted[size++] = keys[i];
+        if (i % interval == 0 && taken < snapshotCount / 2) {
+            TestPersistentTree_snapshot(&tree, &snapshots[taken]);
+            snapshotKeys[taken] = malloc(size * sizeof(uint64_t));
+            memcpy(snapshotKeys[taken], sorted, size * sizeof(uint64_t));
+            qsort(snapshotKeys[taken], size, sizeof(uint64_t), compareKeys);
+            snapshotSizes[taken++] = size;
+        }
+    }
+    qsort(sorted, size, sizeof(uint64_t), compareKeys);
+    checkVersion(&tree, sorted, size);
+    // Remove half of the keys in insertion order, still taking snapshots
+    for (size_t i = 0; i < count / 2; ++i) {
+        Entry key = { .key = keys[i] };
+        bool removed = TestPersistentTree_remove(&tree, &key);
+        assert(removed);
+        uint64_t *k = bsearch(&key.key, sorted, size, sizeof(uint64_t), compareKeys);
+        assert(k != NULL);
+        memmove(k, k + 1, (sorted + size - k - 1) * sizeof(uint64_t));
+        size--;
+        if (i % interval == 0 && taken < snapshotCount) {
+            TestPersistentTree_snapshot(&tree, &snapshots[taken]);
+            snapshotKeys[taken] = malloc(size * sizeof(uint64_t));
+            memcpy(snapshotKeys[taken], sorted, size * sizeof(uint64_t));
+            snapshotSizes[taken++] = size;
+        }
+        if (count < 100 || i % 100 == 0) checkVersion(&tree, sorted, size);
+    }
+    checkVersion(&tree, sorted, size);
+    Entry missing = { .key = 0 };
+    if (TestPersistentTree_find(&tree, &missing) == NULL) assert(!TestPersistentTree_remove(&tree, &missing));
+    for (size_t i = 0; i < taken; ++i) {
+        checkVersion(&snapshots[i], snapshotKeys[i], snapshotSizes[i]);
+    }
+    // A snapshot can be updated independently of the tree
+    if (taken > 0 && snapshotSizes[0] > 0) {
+        Entry key = { .key = snapshotKeys[0][0] };
+        bool removed = TestPersistentTree_remove(&snapshots[0], &key);
+        assert(removed);
+        checkVersion(&snapshots[0], snapshotKeys[0] + 1, snapshotSizes[0] - 1);
+        checkVersion(&tree, sorted, size);
+    }
+    for (size_t i = 0; i < taken; ++i) {
+        TestPersistentTree_clear(&snapshots[i]);
+        free(snapshotKeys[i]);
+        checkVersion(&tree, sorted, size);
+    }
+    TestPersistentTree_clear(&tree);
+    assert(TestPersistentTree_isEmpty(&tree));
+    assert(pool.freeCount == poolSize);
+    free(sorted);
+    free(keys);
+    free(nodes);
+}
+
+/** Checks that updates fail without changes when the pool may run out of nodes. */
+static void testPoolExhaustion() {
+    enum { poolSize = 16 };
+    TestPersistentTree_Node nodes[poolSize];
+    TestPersistentTree_Pool pool;
+    TestPersistentTree_Pool_initialize(&pool, nodes, poolSize);
+    TestPersistentTree tree;
+    TestPersistentTree_initialize(&tree, &pool);
+    size_t size = 0;
+    for (uint64_t key = 0; key < poolSize; ++key) {
+        Entry entry = { .key = key };
+        if (!TestPersistentTree_insert(&tree, &entry)) break;
+        size++;
+    }
+    assert(size > 0 && size < poolSize);
+    assert(pool.freeCount == poolSize - size);
+    TestPersistentTree_clear(&tree);
+    assert(pool.freeCount == poolSize);
+}
+#endif
+
+static volatile uintptr_t benchmarkSink;
+
+/**
+ * Measures insertion and removal of all keys in random order, in ticks per
+ * operation, on an intrusive tree, on a persistent tree without snapshots,
+ * and on a persistent tree snapshotted before each update, thus copying
+ * the whole path every time. Snapshots are released after each update,
+ * as a reader would do soon after.
+ */
+static void testPerformance(size_t count) {
+    uint64_t *keys = createKeys(count);
+    Value *values = (Value *) malloc(count * sizeof(Value));
+    for (size_t i = 0; i < count; ++i) {
+        values[i].key = keys[i];
+    }
+    size_t poolSize = 2 * count + 256;
+    TestPersistentTree_Node *nodes = malloc(poolSize * sizeof(TestPersistentTree_Node));
+    TestPersistentTree_Pool pool;
+    TestPersistentTree_Pool_initialize(&pool, nodes, poolSize);
+    uintptr_t sink = 0;
+    // Intrusive tree
+    AvlTree avlTree;
+    AvlTree_initialize(&avlTree);
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        TestAvlTree_insert(&avlTree, &values[i].node);
+    }
+    uint64_t te = tscStopwatchEnd();
+    double insertTicks = (double) (te - tb) / count;
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        AvlTree_remove(&avlTree, &values[i].node);
+    }
+    te = tscStopwatchEnd();
+    double removeTicks = (double) (te - tb) / count;
+    // Persistent tree without snapshots
+    TestPersistentTree tree;
+    TestPersistentTree_initialize(&tree, &pool);
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        Entry entry = { .key = keys[i], .timer = &values[i] };
+        sink += TestPersistentTree_insert(&tree, &entry);
+    }
+    te = tscStopwatchEnd();
+    double persistentInsertTicks = (double) (te - tb) / count;
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        Entry key = { .key = keys[i] };
+        sink += TestPersistentTree_remove(&tree, &key);
+    }
+    te = tscStopwatchEnd();
+    double persistentRemoveTicks = (double) (te - tb) / count;
+    // Persistent tree with a snapshot for each update
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        TestPersistentTree snapshot;
+        TestPersistentTree_snapshot(&tree, &snapshot);
+        Entry entry = { .key = keys[i], .timer = &values[i] };
+        sink += TestPersistentTree_insert(&tree, &entry);
+        TestPersistentTree_clear(&snapshot);
+    }
+    te = tscStopwatchEnd();
+    double snapshotInsertTicks = (double) (te - tb) / count;
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < count; ++i) {
+        TestPersistentTree snapshot;
+        TestPersistentTree_snapshot(&tree, &snapshot);
+        Entry key = { .key = keys[i] };
+        sink += TestPersistentTree_remove(&tree, &key);
+        TestPersistentTree_clear(&snapshot);
+    }
+    te = tscStopwatchEnd();
+    double snapshotRemoveTicks = (double) (te - tb) / count;
+    benchmarkSink = sink;
+    printf("%zu,%g,%g,%g,%g,%g,%g\n", count, insertTicks, persistentInsertTicks, snapshotInsertTicks,
+            removeTicks, persistentRemoveTicks, snapshotRemoveTicks);
+    free(nodes);
+    free(values);
+    free(keys);
+}
+
+int main() {
+    printf("Node size: intrusive %zu, persistent %zu\n", sizeof(AvlTree_Node), sizeof(TestPersistentTree_Node));
+    srand48(time(NULL));
+    #ifndef NDEBUG
+    for (size_t i = 0; i < 10; ++i) {
+        printf("Round %zu\n", i);
+        testConsistency(1);
+        testConsistency(2);
+        testConsistency(3);
+        testConsistency(10);
+        testConsistency(5000);
+        testPoolExhaustion();
+    }
+    #else
+    printf("Random order benchmark\n");
+    printf("Node count,Insert,Persistent insert,Snapshot insert,Remove,Persistent remove,Snapshot remove\n");
+    testPerformance(1000);
+    testPerformance(10000);
+    testPerformance(100000);
+    testPerformance(1000000);
+    testPerformance(3000000);
+    testPerformance(5000000);
+    testPerformance(10000000);
+    #endif
+    return 0;
+}
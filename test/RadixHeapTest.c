@@ -0,0 +1,320 @@
+/*
+Test code for the intrusive monotone radix heap container.
+Copyright 2012-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <math.h>
+#include "RadixHeap.h"
+#include "BinaryHeap.h"
+#include "AvlTree.h"
+#include "NaryTrie.h"
+#include "tscStopwatch.h"
+
+/* Keys of inserted elements exceed the last removed one by up to this amount */
+#define KEY_RANGE (UINT64_C(1) << 24)
+
+RadixHeap_header(TestHeap, uint64_t);
+BinaryHeap_header(TestBinaryHeap);
+Trie_header(TestTrie, 1, uint64_t);
+
+/* The same element is used for all containers, each benchmark touching its own node only */
+typedef struct Value {
+    uint64_t key;
+    TestHeap_Node node;
+    TestBinaryHeap_Node *binaryHeapNode;
+    AvlTree_Node avlTreeNode;
+    TestTrie_Node trieNode;
+} Value;
+
+static inline Value *Value_fromNode(TestHeap_Node *n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, node));
+}
+
+static inline uint64_t Value_getKey(TestHeap_Node *node) {
+    return Value_fromNode(node)->key;
+}
+
+static inline Value *Value_fromBinaryHeapNode(TestBinaryHeap_Node **n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, binaryHeapNode));
+}
+
+static inline bool Value_isLessInBinaryHeap(TestBinaryHeap_Node **value, TestBinaryHeap_Node **other) {
+    return Value_fromBinaryHeapNode(value)->key < Value_fromBinaryHeapNode(other)->key;
+}
+
+static inline Value *Value_fromAvlTreeNode(AvlTree_Node *n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, avlTreeNode));
+}
+
+static inline bool Value_isLessInAvlTree(AvlTree_Node *node, AvlTree_Node *other) {
+    return Value_fromAvlTreeNode(node)->key < Value_fromAvlTreeNode(other)->key;
+}
+
+static inline Value *Value_fromTrieNode(TestTrie_Node *n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, trieNode));
+}
+
+static inline uint64_t Value_getTrieKey(TestTrie_Node *node) {
+    return Value_fromTrieNode(node)->key;
+}
+
+RadixHeap_implementation(TestHeap, uint64_t, Value_getKey);
+BinaryHeap_implementation(TestBinaryHeap, Value_isLessInBinaryHeap);
+AvlTree_instantiateInsert(TestAvlTree_insert, Value_isLessInAvlTree);
+Trie_implementation(TestTrie, 1, uint64_t, Value_getTrieKey);
+
+static uint64_t randomIncrement() {
+    return (((uint64_t) lrand48() << 32) | lrand48()) % KEY_RANGE;
+}
+
+static Value *createValues(size_t nodeCount, TestBinaryHeap_Node **binaryHeapNodes) {
+    Value *values = (Value *) malloc(nodeCount * sizeof(Value));
+    memset(values, 0, nodeCount * sizeof(Value));
+    *binaryHeapNodes = malloc(nodeCount * sizeof(TestBinaryHeap_Node));
+    srand48(time(NULL));
+    for (size_t i = 0; i < nodeCount; ++i) {
+        values[i].key = randomIncrement();
+        values[i].binaryHeapNode = &(*binaryHeapNodes)[i];
+        (*binaryHeapNodes)[i].value = &values[i].binaryHeapNode;
+    }
+    values[lrand48() % nodeCount].key = 0;
+    values[lrand48() % nodeCount].key = KEY_RANGE - 1;
+    return values;
+}
+
+#ifndef NDEBUG
+static bool isPresent(Value **arr, size_t size, Value *node) {
+    for (size_t i = 0; i < size; ++i) {
+        if (arr[i] == node) return true;
+    }
+    return false;
+}
+
+static void testConsistency(size_t nodeCount) {
+    Value **seenValues = malloc(nodeCount * sizeof(Value *));
+    size_t seenValuesSize;
+    TestBinaryHeap_Node *binaryHeapNodes;
+    Value *values = createValues(nodeCount, &binaryHeapNodes);
+    TestHeap heap;
+    TestHeap_initialize(&heap);
+    // Test minimum element removal
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestHeap_insert(&heap, &values[i].node);
+        TestHeap_check(&heap);
+    }
+    seenValuesSize = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        assert(!TestHeap_isEmpty(&heap));
+        Value *value = Value_fromNode(TestHeap_poll(&heap));
+        TestHeap_check(&heap);
+        assert(!isPresent(seenValues, seenValuesSize, value));
+        seenValues[seenValuesSize] = value;
+        seenValuesSize++;
+        printf("Polled %zu: %016" PRIX64 "\n", i, value->key);
+        assert(i == 0 || seenValues[i - 1]->key <= seenValues[i]->key);
+        assert(value->key == TestHeap_getLast(&heap));
+    }
+    assert(TestHeap_isEmpty(&heap));
+    // Test random removal
+    for (size_t i = 0; i < nodeCount; ++i) {
+        values[i].key = TestHeap_getLast(&heap) + randomIncrement();
+        TestHeap_insert(&heap, &values[i].node);
+        TestHeap_check(&heap);
+    }
+    seenValuesSize = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        assert(!TestHeap_isEmpty(&heap));
+        if (i % 3 == 0) TestHeap_peek(&heap);
+        TestHeap_remove(&heap, &values[i].node);
+        TestHeap_check(&heap);
+        assert(!isPresent(seenValues, seenValuesSize, &values[i]));
+        seenValues[seenValuesSize] = &values[i];
+        seenValuesSize++;
+        printf("Removed %zu: %016" PRIX64 "\n", i, values[i].key);
+    }
+    assert(TestHeap_isEmpty(&heap));
+    // Test interleaved monotone insertion and removal
+    for (size_t i = 0; i < nodeCount; ++i) {
+        values[i].key = TestHeap_getLast(&heap) + randomIncrement();
+        TestHeap_insert(&heap, &values[i].node);
+    }
+    uint64_t lastKey = TestHeap_getLast(&heap);
+    for (size_t i = 0; i < 2 * nodeCount; ++i) {
+        Value *value = Value_fromNode(TestHeap_poll(&heap));
+        TestHeap_check(&heap);
+        assert(value->key >= lastKey);
+        lastKey = value->key;
+        value->key += (i % 2 == 0) ? 0 : randomIncrement();
+        TestHeap_insert(&heap, &value->node);
+        TestHeap_check(&heap);
+    }
+    free(seenValues);
+    free(binaryHeapNodes);
+    free(values);
+}
+#endif
+
+/*
+ * The monotone benchmark uses the "hold" model, typical of timers and
+ * event-driven simulations: the minimum is polled and reinserted with its
+ * key increased by a random amount, thus keys never go below the last polled.
+ */
+
+static double testRadixHeapPerformance(Value *values, size_t nodeCount, size_t roundCount) {
+    TestHeap heap;
+    TestHeap_initialize(&heap);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestHeap_insert(&heap, &values[i].node);
+    }
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t r = 0; r < roundCount; ++r) {
+        Value *value = Value_fromNode(TestHeap_poll(&heap));
+        value->key += randomIncrement();
+        TestHeap_insert(&heap, &value->node);
+    }
+    uint64_t te = tscStopwatchEnd();
+    return (double) (te - tb) / roundCount;
+}
+
+static double testBinaryHeapPerformance(Value *values, size_t nodeCount, size_t roundCount) {
+    TestBinaryHeap heap;
+    TestBinaryHeap_initialize(&heap);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestBinaryHeap_insert(&heap, values[i].binaryHeapNode);
+    }
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t r = 0; r < roundCount; ++r) {
+        TestBinaryHeap_Node *node = TestBinaryHeap_poll(&heap);
+        Value_fromBinaryHeapNode(node->value)->key += randomIncrement();
+        TestBinaryHeap_insert(&heap, node);
+    }
+    uint64_t te = tscStopwatchEnd();
+    return (double) (te - tb) / roundCount;
+}
+
+static double testAvlTreePerformance(Value *values, size_t nodeCount, size_t roundCount) {
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestAvlTree_insert(&tree, &values[i].avlTreeNode);
+    }
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t r = 0; r < roundCount; ++r) {
+        Value *value = Value_fromAvlTreeNode(tree.leftmost);
+        AvlTree_remove(&tree, &value->avlTreeNode);
+        value->key += randomIncrement();
+        TestAvlTree_insert(&tree, &value->avlTreeNode);
+    }
+    uint64_t te = tscStopwatchEnd();
+    return (double) (te - tb) / roundCount;
+}
+
+static double testTriePerformance(Value *values, size_t nodeCount, size_t roundCount) {
+    TestTrie trie;
+    TestTrie_initialize(&trie, 64);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestTrie_insert(&trie, &values[i].trieNode, false);
+    }
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t r = 0; r < roundCount; ++r) {
+        Value *value = Value_fromTrieNode(TestTrie_findMin(&trie));
+        TestTrie_remove(&trie, &value->trieNode);
+        value->key += randomIncrement();
+        TestTrie_insert(&trie, &value->trieNode, false);
+    }
+    uint64_t te = tscStopwatchEnd();
+    return (double) (te - tb) / roundCount;
+}
+
+static void testMonotonePerformance(size_t nodeCount, size_t roundCount) {
+    TestBinaryHeap_Node *binaryHeapNodes;
+    Value *values = createValues(nodeCount, &binaryHeapNodes);
+    uint64_t *initialKeys = malloc(nodeCount * sizeof(uint64_t));
+    for (size_t i = 0; i < nodeCount; ++i) {
+        initialKeys[i] = values[i].key;
+    }
+    double radixHeapTicks = testRadixHeapPerformance(values, nodeCount, roundCount);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        values[i].key = initialKeys[i];
+    }
+    double binaryHeapTicks = testBinaryHeapPerformance(values, nodeCount, roundCount);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        values[i].key = initialKeys[i];
+    }
+    double avlTreeTicks = testAvlTreePerformance(values, nodeCount, roundCount);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        values[i].key = initialKeys[i];
+    }
+    double trieTicks = testTriePerformance(values, nodeCount, roundCount);
+    printf("%zu,%g,%g,%g,%g\n", nodeCount, radixHeapTicks, binaryHeapTicks, avlTreeTicks, trieTicks);
+    free(initialKeys);
+    free(binaryHeapNodes);
+    free(values);
+}
+
+static void burstMonotonePerformance(size_t roundCount) {
+    testMonotonePerformance(1, roundCount);
+    testMonotonePerformance(3, roundCount);
+    testMonotonePerformance(5, roundCount);
+    testMonotonePerformance(10, roundCount);
+    testMonotonePerformance(30, roundCount);
+    testMonotonePerformance(50, roundCount);
+    testMonotonePerformance(100, roundCount);
+    testMonotonePerformance(300, roundCount);
+    testMonotonePerformance(500, roundCount);
+    testMonotonePerformance(1000, roundCount);
+    testMonotonePerformance(3000, roundCount);
+    testMonotonePerformance(5000, roundCount);
+    testMonotonePerformance(10000, roundCount);
+    testMonotonePerformance(30000, roundCount);
+    testMonotonePerformance(50000, roundCount);
+    testMonotonePerformance(100000, roundCount);
+    testMonotonePerformance(300000, roundCount);
+    testMonotonePerformance(1000000, roundCount);
+    testMonotonePerformance(3000000, roundCount);
+    testMonotonePerformance(5000000, roundCount);
+    testMonotonePerformance(10000000, roundCount);
+}
+
+int main() {
+    printf("Value size: %zu\n", sizeof(Value));
+    #ifndef NDEBUG
+    for (size_t i = 0; i < 10; ++i) {
+        printf("Round %zu\n", i);
+        testConsistency(5000);
+    }
+    #else
+    printf("Monotone hold benchmark (poll and reinsert with a greater key)\n");
+    printf("Node count,RadixHeap,BinaryHeap,AvlTree,NaryTrie\n");
+    burstMonotonePerformance(1000000);
+    #endif
+}
@@ -51,6 +51,108 @@ static inline bool Value_isLess(RedBlackTree_Node *node, RedBlackTree_Node *othe
 }
 
 RedBlackTree_instantiateInsert(TestTree_insert, Value_isLess);
+RedBlackTree_instantiateFind(TestTree_find, Value_isLess);
+RedBlackTree_instantiateLowerBound(TestTree_lowerBound, Value_isLess);
+RedBlackTree_instantiateUpperBound(TestTree_upperBound, Value_isLess);
+
+static void sumKeys(RedBlackTree_Node *node, void *context) {
+    *(uint64_t *) context += Value_fromNode(node)->key;
+}
+
+RedBlackTree_instantiateVisitRange(TestTree_sumRange, Value_isLess, sumKeys);
+RedBlackTree_instantiateBuild(TestTree_build, Value_isLess);
+RedBlackTree_instantiateSplit(TestTree_split, Value_isLess);
+
+#ifndef NDEBUG
+typedef struct WeightedValue {
+    uint64_t key;
+    uint64_t weight;
+    uint64_t totalWeight; // sum of weights in the subtree
+    RedBlackTree_Node node;
+} WeightedValue;
+
+static inline WeightedValue *WeightedValue_fromNode(const RedBlackTree_Node *n) {
+    return (WeightedValue *) ((uint8_t *) n - offsetof(WeightedValue, node));
+}
+
+static inline bool WeightedValue_isLess(RedBlackTree_Node *node, RedBlackTree_Node *other) {
+    return WeightedValue_fromNode(node)->key < WeightedValue_fromNode(other)->key;
+}
+
+static inline uint64_t WeightedValue_getTotalWeight(const RedBlackTree_Node *node) {
+    return (node != NULL) ? WeightedValue_fromNode(node)->totalWeight : 0;
+}
+
+static inline void WeightedValue_update(RedBlackTree_Node *node) {
+    WeightedValue *v = WeightedValue_fromNode(node);
+    v->totalWeight = v->weight + WeightedValue_getTotalWeight(node->left) + WeightedValue_getTotalWeight(node->right);
+}
+
+RedBlackTree_instantiateAugmented(WeightedTree, WeightedValue_isLess, WeightedValue_update);
+#endif
+
+typedef struct IntervalValue {
+    uint64_t begin;
+    uint64_t end;
+    uint64_t maxEnd; // maximum end in the subtree
+    RedBlackTree_Node node;
+} IntervalValue;
+
+static inline IntervalValue *IntervalValue_fromNode(const RedBlackTree_Node *n) {
+    return (IntervalValue *) ((uint8_t *) n - offsetof(IntervalValue, node));
+}
+
+static inline uint64_t IntervalValue_getBegin(const RedBlackTree_Node *node) {
+    return IntervalValue_fromNode(node)->begin;
+}
+
+static inline uint64_t IntervalValue_getEnd(const RedBlackTree_Node *node) {
+    return IntervalValue_fromNode(node)->end;
+}
+
+static inline uint64_t IntervalValue_getMaxEnd(const RedBlackTree_Node *node) {
+    return IntervalValue_fromNode(node)->maxEnd;
+}
+
+static inline void IntervalValue_setMaxEnd(RedBlackTree_Node *node, uint64_t maxEnd) {
+    IntervalValue_fromNode(node)->maxEnd = maxEnd;
+}
+
+/** Counts found intervals and sums their addresses, to compare results cheaply. */
+typedef struct IntervalResult {
+    size_t count;
+    uintptr_t sum;
+} IntervalResult;
+
+static void collectInterval(RedBlackTree_Node *node, void *context) {
+    IntervalResult *result = (IntervalResult *) context;
+    result->count++;
+    result->sum += (uintptr_t) node;
+}
+
+RedBlackTree_instantiateIntervalTree(IntervalTree, uint64_t, IntervalValue_getBegin, IntervalValue_getEnd, IntervalValue_getMaxEnd, IntervalValue_setMaxEnd);
+RedBlackTree_instantiateStabbingQuery(IntervalTree_stab, IntervalTree, collectInterval);
+RedBlackTree_instantiateOverlapQuery(IntervalTree_overlap, IntervalTree, collectInterval);
+
+/** Interval endpoints are in [0, 2^40), with lengths averaging 2^40 / nodeCount, so that about one interval covers each point. */
+static const uint64_t intervalUniverse = (uint64_t) 1 << 40;
+
+static IntervalValue *createIntervals(size_t nodeCount) {
+    IntervalValue *intervals = (IntervalValue *) malloc(nodeCount * sizeof(IntervalValue));
+    uint64_t maxLength = 2 * intervalUniverse / nodeCount;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        intervals[i].begin = (((uint64_t) lrand48() << 31) | lrand48()) % intervalUniverse;
+        intervals[i].end = intervals[i].begin + 1 + (((uint64_t) lrand48() << 31) | lrand48()) % maxLength;
+    }
+    return intervals;
+}
+
+/** Reference implementation scanning all intervals. */
+static void scanOverlap(const IntervalValue *intervals, size_t nodeCount, uint64_t lo, uint64_t hi, IntervalResult *result) {
+    for (size_t i = 0; i < nodeCount; ++i) {
+        if (intervals[i].begin < hi && lo < intervals[i].end) collectInterval((RedBlackTree_Node *) &intervals[i].node, result);
+    }
+}
 
 static uint64_t nextKey = 0;
 
@@ -74,6 +176,12 @@ static Value *createValues(size_t nodeCount) {
 }
 
 #ifndef NDEBUG
+static int compareValuePointers(const void *a, const void *b) {
+    uint64_t x = (*(const Value **) a)->key;
+    uint64_t y = (*(const Value **) b)->key;
+    return (x > y) - (x < y);
+}
+
 static bool isPresent(Value **arr, size_t size, Value *node) {
     for (size_t i = 0; i < size; ++i) {
         if (arr[i] == node) return true;
@@ -120,8 +228,286 @@ static void testConsistency(size_t nodeCount) {
     free(seenNodes);
     free(nodes);
 }
+
+/** Checks links, ordering and colors of a subtree, returning its black height. */
+static int checkSubtree(RedBlackTree_Node *node, RedBlackTree_Node *parent) {
+    if (node == NULL) return 0;
+    assert(RedBlackTree_getParent(node) == parent);
+    if (node->left != NULL) assert(!Value_isLess(node, node->left));
+    if (node->right != NULL) assert(!Value_isLess(node->right, node));
+    if (RedBlackTree_isRed(node)) {
+        assert(parent != NULL && RedBlackTree_isBlack(parent));
+    }
+    int leftBlackHeight = checkSubtree(node->left, node);
+    int rightBlackHeight = checkSubtree(node->right, node);
+    assert(leftBlackHeight == rightBlackHeight);
+    return leftBlackHeight + (RedBlackTree_isBlack(node) ? 1 : 0);
+}
+
+static void checkTree(RedBlackTree *tree) {
+    checkSubtree(tree->root, NULL);
+    if (!RedBlackTree_isEmpty(tree)) {
+        assert(RedBlackTree_isBlack(tree->root));
+        assert(tree->leftmost == RedBlackTree_findMin(tree->root));
+        assert(tree->rightmost == RedBlackTree_findMax(tree->root));
+    } else {
+        assert(tree->leftmost == NULL);
+        assert(tree->rightmost == NULL);
+    }
+}
+
+static void testBuildConsistency(size_t nodeCount) {
+    Value *values = createValues(nodeCount);
+    RedBlackTree_Node **nodes = malloc(nodeCount * sizeof(RedBlackTree_Node *));
+    for (size_t i = 0; i < nodeCount; i++) {
+        nodes[i] = &values[i].node;
+    }
+    RedBlackTree tree;
+    RedBlackTree_initialize(&tree);
+    TestTree_build(&tree, nodes, nodeCount);
+    checkTree(&tree);
+    size_t count = 0;
+    for (RedBlackTree_Node *n = tree.leftmost; n != NULL; n = RedBlackTree_next(n)) {
+        assert(n == nodes[count]);
+        count++;
+    }
+    assert(count == nodeCount);
+    // Removal and insertion must keep working on a built tree
+    for (size_t i = 0; i < nodeCount; i += 2) {
+        RedBlackTree_remove(&tree, &values[i].node);
+        checkTree(&tree);
+    }
+    for (size_t i = 0; i < nodeCount; i += 2) {
+        TestTree_insert(&tree, &values[i].node);
+    }
+    checkTree(&tree);
+    free(nodes);
+    free(values);
+}
+
+static void testSplitJoinConsistency(size_t nodeCount) {
+    Value *values = createValues(nodeCount);
+    RedBlackTree tree;
+    RedBlackTree other;
+    RedBlackTree_initialize(&tree);
+    RedBlackTree_initialize(&other);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestTree_insert(&tree, &values[i].node);
+    }
+    checkTree(&tree);
+    for (size_t r = 0; r < 100; ++r) {
+        // Split by a random key and rejoin using the minimum of the right part as pivot
+        Value key;
+        randomizeKey(&key);
+        TestTree_split(&tree, &key.node, &other);
+        checkTree(&tree);
+        checkTree(&other);
+        if (!RedBlackTree_isEmpty(&tree)) assert(Value_isLess(tree.rightmost, &key.node));
+        if (!RedBlackTree_isEmpty(&other)) {
+            assert(!Value_isLess(other.leftmost, &key.node));
+            RedBlackTree_Node *pivot = other.leftmost;
+            RedBlackTree_remove(&other, pivot);
+            RedBlackTree_join(&tree, pivot, &other);
+        }
+        checkTree(&tree);
+        assert(RedBlackTree_isEmpty(&other));
+        // Split by a random node and rejoin
+        RedBlackTree_Node *node = &values[lrand48() % nodeCount].node;
+        RedBlackTree_split(&tree, node, &other);
+        checkTree(&tree);
+        checkTree(&other);
+        assert(other.leftmost == node);
+        RedBlackTree_remove(&other, node);
+        RedBlackTree_join(&tree, node, &other);
+        checkTree(&tree);
+        assert(RedBlackTree_isEmpty(&other));
+    }
+    size_t count = 0;
+    while (!RedBlackTree_isEmpty(&tree)) {
+        RedBlackTree_remove(&tree, tree.leftmost);
+        count++;
+    }
+    assert(count == nodeCount);
+    free(values);
+}
+
+static uint64_t checkTotalWeights(const RedBlackTree_Node *node) {
+    if (node == NULL) return 0;
+    uint64_t totalWeight = checkTotalWeights(node->left) + checkTotalWeights(node->right) + WeightedValue_fromNode(node)->weight;
+    assert(WeightedValue_fromNode(node)->totalWeight == totalWeight);
+    return totalWeight;
+}
+
+static void testAugmentedConsistency(size_t nodeCount) {
+    WeightedValue *nodes = malloc(nodeCount * sizeof(WeightedValue));
+    uint64_t totalWeight = 0;
+    RedBlackTree tree;
+    RedBlackTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        nodes[i].key = lrand48() % nodeCount;
+        nodes[i].weight = lrand48() % 1000;
+        totalWeight += nodes[i].weight;
+        WeightedTree_insert(&tree, &nodes[i].node);
+        assert(checkTotalWeights(tree.root) == totalWeight);
+    }
+    for (size_t i = 0; i < nodeCount; ++i) {
+        WeightedTree_remove(&tree, &nodes[i].node);
+        totalWeight -= nodes[i].weight;
+        assert(checkTotalWeights(tree.root) == totalWeight);
+    }
+    assert(RedBlackTree_isEmpty(&tree));
+    free(nodes);
+}
+static uint64_t checkMaxEnds(const RedBlackTree_Node *node) {
+    if (node == NULL) return 0;
+    uint64_t maxEnd = IntervalValue_fromNode(node)->end;
+    uint64_t leftMaxEnd = checkMaxEnds(node->left);
+    uint64_t rightMaxEnd = checkMaxEnds(node->right);
+    if (maxEnd < leftMaxEnd) maxEnd = leftMaxEnd;
+    if (maxEnd < rightMaxEnd) maxEnd = rightMaxEnd;
+    assert(IntervalValue_fromNode(node)->maxEnd == maxEnd);
+    return maxEnd;
+}
+
+static void checkIntervalQueries(RedBlackTree *tree, const IntervalValue *intervals, size_t nodeCount) {
+    for (size_t q = 0; q < 100; ++q) {
+        uint64_t lo = (((uint64_t) lrand48() << 31) | lrand48()) % intervalUniverse;
+        uint64_t hi = lo + 1 + lrand48() % (2 * intervalUniverse / (nodeCount + 1));
+        IntervalResult expected = { 0, 0 };
+        IntervalResult actual = { 0, 0 };
+        scanOverlap(intervals, nodeCount, lo, hi, &expected);
+        IntervalTree_overlap(tree, lo, hi, &actual);
+        assert(actual.count == expected.count && actual.sum == expected.sum);
+        expected = (IntervalResult) { 0, 0 };
+        actual = (IntervalResult) { 0, 0 };
+        scanOverlap(intervals, nodeCount, lo, lo + 1, &expected);
+        IntervalTree_stab(tree, lo, &actual);
+        assert(actual.count == expected.count && actual.sum == expected.sum);
+    }
+}
+
+static void testIntervalConsistency(size_t nodeCount) {
+    IntervalValue *intervals = createIntervals(nodeCount);
+    RedBlackTree tree;
+    RedBlackTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        IntervalTree_insert(&tree, &intervals[i].node);
+        if (nodeCount < 100 || i % 100 == 0) checkMaxEnds(tree.root);
+    }
+    checkMaxEnds(tree.root);
+    checkIntervalQueries(&tree, intervals, nodeCount);
+    // Remove the first half, leaving the second half to query
+    for (size_t i = 0; i < nodeCount / 2; ++i) {
+        IntervalTree_remove(&tree, &intervals[i].node);
+        if (nodeCount < 100 || i % 100 == 0) checkMaxEnds(tree.root);
+    }
+    checkMaxEnds(tree.root);
+    checkIntervalQueries(&tree, intervals + nodeCount / 2, nodeCount - nodeCount / 2);
+    free(intervals);
+}
+
+static void testLookupConsistency(size_t nodeCount) {
+    Value *values = createValues(nodeCount);
+    Value **sorted = malloc(nodeCount * sizeof(Value *));
+    RedBlackTree tree;
+    RedBlackTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestTree_insert(&tree, &values[i].node);
+        sorted[i] = &values[i];
+    }
+    qsort(sorted, nodeCount, sizeof(Value *), compareValuePointers);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        Value key = { .key = sorted[i]->key };
+        assert(Value_fromNode(TestTree_find(&tree, &key.node))->key == key.key);
+        assert(Value_fromNode(TestTree_lowerBound(&tree, &key.node))->key == key.key);
+        RedBlackTree_Node *upper = TestTree_upperBound(&tree, &key.node);
+        assert(upper == NULL || Value_fromNode(upper)->key > key.key);
+        if (key.key == UINT64_MAX) continue;
+        key.key++;
+        RedBlackTree_Node *lower = TestTree_lowerBound(&tree, &key.node);
+        if (i + 1 < nodeCount && sorted[i + 1]->key == key.key) {
+            assert(lower == &sorted[i + 1]->node);
+        } else {
+            assert(TestTree_find(&tree, &key.node) == NULL);
+            assert(lower == (i + 1 < nodeCount ? &sorted[i + 1]->node : NULL));
+        }
+    }
+    free(sorted);
+    free(values);
+}
+static void testIterationConsistency(size_t nodeCount) {
+    Value *values = createValues(nodeCount);
+    Value **sorted = malloc(nodeCount * sizeof(Value *));
+    RedBlackTree tree;
+    RedBlackTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestTree_insert(&tree, &values[i].node);
+        sorted[i] = &values[i];
+    }
+    qsort(sorted, nodeCount, sizeof(Value *), compareValuePointers);
+    // Full scans in both directions
+    RedBlackTree_Node *node = tree.leftmost;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        assert(Value_fromNode(node)->key == sorted[i]->key);
+        node = RedBlackTree_next(node);
+    }
+    assert(node == NULL);
+    node = tree.rightmost;
+    for (size_t i = nodeCount; i-- > 0;) {
+        assert(Value_fromNode(node)->key == sorted[i]->key);
+        node = RedBlackTree_prev(node);
+    }
+    assert(node == NULL);
+    // Range visits between the keys of random positions
+    for (size_t r = 0; r < 100; ++r) {
+        size_t first = lrand48() % nodeCount;
+        size_t last = first + lrand48() % (nodeCount - first);
+        Value lo = { .key = sorted[first]->key };
+        Value hi = { .key = sorted[last]->key };
+        uint64_t expected = 0;
+        for (size_t i = 0; i < nodeCount; ++i) {
+            if (sorted[i]->key >= lo.key && sorted[i]->key < hi.key) expected += sorted[i]->key;
+        }
+        uint64_t sum = 0;
+        TestTree_sumRange(&tree, &lo.node, &hi.node, &sum);
+        assert(sum == expected);
+    }
+    free(sorted);
+    free(values);
+}
+
 #endif
 
+/**
+ * Header and row suffix with the counters of a tree per operation, printed
+ * only if REDBLACKTREE_STATS is defined: nodes visited descending per insertion,
+ * rotations per insertion or removal, rebalancing steps per insertion
+ * and per removal.
+ */
+#ifdef REDBLACKTREE_STATS
+#define STATS_HEADER ",Descent,Rotations,Ins. rebalance,Rem. rebalance"
+#else
+#define STATS_HEADER ""
+#endif
+
+static void resetStats(RedBlackTree *tree) {
+    #ifdef REDBLACKTREE_STATS
+    tree->stats = (RedBlackTree_Stats) { 0 };
+    #endif
+}
+
+static void printStats(const RedBlackTree *tree) {
+    #ifdef REDBLACKTREE_STATS
+    const RedBlackTree_Stats *stats = &tree->stats;
+    printf(",%g,%g,%g,%g",
+            (double) stats->descentSteps / stats->insertions,
+            (double) stats->rotations / (stats->insertions + stats->removals),
+            (double) stats->insertRebalanceSteps / stats->insertions,
+            (double) stats->removeRebalanceSteps / stats->removals);
+    #endif
+    printf("\n");
+}
+
 static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
     Value *nodes = createValues(nodeCount);
     RedBlackTree tree;
@@ -129,6 +515,7 @@ static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
     for (size_t i = 0; i < nodeCount - 1; ++i) {
         TestTree_insert(&tree, &nodes[i].node);
     }
+    resetStats(&tree);
     double insertMean = 0;
     double removeMean = 0;
     double insertVar = 0;
@@ -153,7 +540,8 @@ static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
         delta2 = (double) (te - tb) - removeMean;
         removeVar += delta * delta2;
     }
-    printf("%zu,%g,%g,%g,%g\n", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    printf("%zu,%g,%g,%g,%g", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    printStats(&tree);
     free(nodes);
 }
 
@@ -165,6 +553,7 @@ static void testMinimumRemovalPerformance(size_t nodeCount, size_t roundCount) {
         TestTree_insert(&tree, &nodes[i].node);
     }
     Value *node = &nodes[nodeCount - 1];
+    resetStats(&tree);
     double insertMean = 0;
     double removeMean = 0;
     double insertVar = 0;
@@ -189,7 +578,8 @@ static void testMinimumRemovalPerformance(size_t nodeCount, size_t roundCount) {
         delta2 = (double) (te - tb) - removeMean;
         removeVar += delta * delta2;
     }
-    printf("%zu,%g,%g,%g,%g\n", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    printf("%zu,%g,%g,%g,%g", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)));
+    printStats(&tree);
     free(nodes);
 }
 
@@ -212,6 +602,214 @@ static void testFullCyclePerformance(size_t nodeCount, size_t roundCount) {
     free(nodes);
 }
 
+static volatile uintptr_t benchmarkSink;
+
+static void testLookupPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    Value *probes = createValues(nodeCount);
+    for (size_t i = 0; i < nodeCount; i++) {
+        randomizeKey(&probes[i]); // createValues reseeds with the same time
+    }
+    RedBlackTree tree;
+    RedBlackTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; i++) {
+        TestTree_insert(&tree, &values[i].node);
+    }
+    uintptr_t sink = 0;
+    uint64_t findTicks = 0;
+    uint64_t lowerBoundTicks = 0;
+    uint64_t upperBoundTicks = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Successful lookups of keys in the tree, in random order
+        uint64_t tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            sink += (uintptr_t) TestTree_find(&tree, &values[i].node);
+        }
+        uint64_t te = tscStopwatchEnd();
+        findTicks += te - tb;
+        // Bounds of random keys, most likely not in the tree
+        tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            sink += (uintptr_t) TestTree_lowerBound(&tree, &probes[i].node);
+        }
+        te = tscStopwatchEnd();
+        lowerBoundTicks += te - tb;
+        tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            sink += (uintptr_t) TestTree_upperBound(&tree, &probes[i].node);
+        }
+        te = tscStopwatchEnd();
+        upperBoundTicks += te - tb;
+    }
+    benchmarkSink = sink;
+    double divisor = (double) roundCount * nodeCount;
+    printf("%zu,%g,%g,%g\n", nodeCount, findTicks / divisor, lowerBoundTicks / divisor, upperBoundTicks / divisor);
+    free(probes);
+    free(values);
+}
+
+static void testScanPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    RedBlackTree tree;
+    RedBlackTree_initialize(&tree);
+    uint64_t sum = 0;
+    uint64_t scanTicks = 0;
+    uint64_t removalTicks = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        for (size_t i = 0; i < nodeCount; i++) {
+            TestTree_insert(&tree, &values[i].node);
+        }
+        // In-order scan leaving the tree untouched
+        uint64_t tb = tscStopwatchBegin();
+        for (RedBlackTree_Node *node = tree.leftmost; node != NULL; node = RedBlackTree_next(node)) {
+            sum += Value_fromNode(node)->key;
+        }
+        uint64_t te = tscStopwatchEnd();
+        scanTicks += te - tb;
+        // In-order drain by repeated removal of the leftmost node
+        tb = tscStopwatchBegin();
+        while (!RedBlackTree_isEmpty(&tree)) {
+            Value *value = Value_fromNode(tree.leftmost);
+            sum += value->key;
+            RedBlackTree_remove(&tree, &value->node);
+        }
+        te = tscStopwatchEnd();
+        removalTicks += te - tb;
+    }
+    benchmarkSink = sum;
+    double divisor = (double) roundCount * nodeCount;
+    printf("%zu,%g,%g\n", nodeCount, scanTicks / divisor, removalTicks / divisor);
+    free(values);
+}
+
+/**
+ * Measures insertion of intervals in random order, stabbing and overlap
+ * queries at random points and windows, in ticks per operation, and overlap
+ * queries performed by a linear scan, as done without an interval tree.
+ */
+static void testBuildPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    RedBlackTree_Node **unsorted = malloc(nodeCount * sizeof(RedBlackTree_Node *));
+    RedBlackTree_Node **nodes = malloc(nodeCount * sizeof(RedBlackTree_Node *));
+    for (size_t i = 0; i < nodeCount; i++) {
+        unsorted[i] = &values[i].node;
+    }
+    RedBlackTree tree;
+    uint64_t insertTicks = 0;
+    uint64_t sortAndBuildTicks = 0;
+    uint64_t buildTicks = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Repeated insertion
+        RedBlackTree_initialize(&tree);
+        uint64_t tb = tscStopwatchBegin();
+        for (size_t i = 0; i < nodeCount; i++) {
+            TestTree_insert(&tree, unsorted[i]);
+        }
+        uint64_t te = tscStopwatchEnd();
+        insertTicks += te - tb;
+        // Bulk construction from unsorted nodes
+        memcpy(nodes, unsorted, nodeCount * sizeof(RedBlackTree_Node *));
+        RedBlackTree_initialize(&tree);
+        tb = tscStopwatchBegin();
+        TestTree_build(&tree, nodes, nodeCount);
+        te = tscStopwatchEnd();
+        sortAndBuildTicks += te - tb;
+        // Bulk construction from nodes already sorted by the previous step
+        RedBlackTree_initialize(&tree);
+        tb = tscStopwatchBegin();
+        RedBlackTree_buildFromSorted(&tree, nodes, nodeCount);
+        te = tscStopwatchEnd();
+        buildTicks += te - tb;
+    }
+    double divisor = (double) roundCount * nodeCount;
+    printf("%zu,%g,%g,%g\n", nodeCount, insertTicks / divisor, sortAndBuildTicks / divisor, buildTicks / divisor);
+    free(nodes);
+    free(unsorted);
+    free(values);
+}
+
+static void testIntervalPerformance(size_t nodeCount, size_t queryCount) {
+    IntervalValue *intervals = createIntervals(nodeCount);
+    uint64_t *points = malloc(queryCount * sizeof(uint64_t));
+    for (size_t i = 0; i < queryCount; ++i) {
+        points[i] = (((uint64_t) lrand48() << 31) | lrand48()) % intervalUniverse;
+    }
+    uint64_t windowLength = intervalUniverse / nodeCount;
+    RedBlackTree tree;
+    RedBlackTree_initialize(&tree);
+    IntervalResult result = { 0, 0 };
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t i = 0; i < nodeCount; ++i) {
+        IntervalTree_insert(&tree, &intervals[i].node);
+    }
+    uint64_t te = tscStopwatchEnd();
+    double insertTicks = (double) (te - tb) / nodeCount;
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < queryCount; ++i) {
+        IntervalTree_stab(&tree, points[i], &result);
+    }
+    te = tscStopwatchEnd();
+    double stabTicks = (double) (te - tb) / queryCount;
+    double stabResults = (double) result.count / queryCount;
+    result.count = 0;
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < queryCount; ++i) {
+        IntervalTree_overlap(&tree, points[i], points[i] + windowLength, &result);
+    }
+    te = tscStopwatchEnd();
+    double overlapTicks = (double) (te - tb) / queryCount;
+    double overlapResults = (double) result.count / queryCount;
+    size_t scanCount = 100;
+    tb = tscStopwatchBegin();
+    for (size_t i = 0; i < scanCount; ++i) {
+        scanOverlap(intervals, nodeCount, points[i], points[i] + windowLength, &result);
+    }
+    te = tscStopwatchEnd();
+    double scanTicks = (double) (te - tb) / scanCount;
+    benchmarkSink = result.sum;
+    printf("%zu,%g,%g,%g,%g,%g,%g\n", nodeCount, insertTicks, stabTicks, stabResults, overlapTicks, overlapResults, scanTicks);
+    free(points);
+    free(intervals);
+}
+
+static void burstIntervalPerformance(size_t queryCount) {
+    testIntervalPerformance(10000, queryCount);
+    testIntervalPerformance(30000, queryCount);
+    testIntervalPerformance(50000, queryCount);
+    testIntervalPerformance(100000, queryCount);
+    testIntervalPerformance(300000, queryCount);
+    testIntervalPerformance(1000000, queryCount);
+    testIntervalPerformance(3000000, queryCount);
+    testIntervalPerformance(5000000, queryCount);
+    testIntervalPerformance(10000000, queryCount);
+}
+
+static void burstBuildPerformance(size_t roundCount) {
+    testBuildPerformance(1, roundCount);
+    testBuildPerformance(3, roundCount);
+    testBuildPerformance(5, roundCount);
+    testBuildPerformance(10, roundCount);
+    testBuildPerformance(30, roundCount);
+    testBuildPerformance(50, roundCount);
+    testBuildPerformance(100, roundCount);
+    testBuildPerformance(300, roundCount);
+    testBuildPerformance(500, roundCount);
+    testBuildPerformance(1000, roundCount);
+    testBuildPerformance(3000, roundCount);
+    testBuildPerformance(5000, roundCount);
+    testBuildPerformance(10000, roundCount);
+    if (roundCount < 100) {
+        testBuildPerformance(30000, roundCount);
+        testBuildPerformance(50000, roundCount);
+        testBuildPerformance(100000, roundCount);
+        testBuildPerformance(300000, roundCount);
+        testBuildPerformance(1000000, roundCount);
+        testBuildPerformance(3000000, roundCount);
+        testBuildPerformance(5000000, roundCount);
+        testBuildPerformance(10000000, roundCount);
+    }
+}
+
 static void burstRandomRemovalPerformance(size_t roundCount) {
     testRandomRemovalPerformance(1, roundCount);
     testRandomRemovalPerformance(3, roundCount);
@@ -286,21 +884,108 @@ static void burstFullCyclePerformance(size_t roundCount) {
     }
 }
 
+static void burstLookupPerformance(size_t roundCount) {
+    testLookupPerformance(1, roundCount);
+    testLookupPerformance(3, roundCount);
+    testLookupPerformance(5, roundCount);
+    testLookupPerformance(10, roundCount);
+    testLookupPerformance(30, roundCount);
+    testLookupPerformance(50, roundCount);
+    testLookupPerformance(100, roundCount);
+    testLookupPerformance(300, roundCount);
+    testLookupPerformance(500, roundCount);
+    testLookupPerformance(1000, roundCount);
+    testLookupPerformance(3000, roundCount);
+    testLookupPerformance(5000, roundCount);
+    testLookupPerformance(10000, roundCount);
+    if (roundCount < 100) {
+        testLookupPerformance(30000, roundCount);
+        testLookupPerformance(50000, roundCount);
+        testLookupPerformance(100000, roundCount);
+        testLookupPerformance(300000, roundCount);
+        testLookupPerformance(1000000, roundCount);
+        testLookupPerformance(3000000, roundCount);
+        testLookupPerformance(5000000, roundCount);
+        testLookupPerformance(10000000, roundCount);
+    }
+}
+
+static void burstScanPerformance(size_t roundCount) {
+    testScanPerformance(1, roundCount);
+    testScanPerformance(3, roundCount);
+    testScanPerformance(5, roundCount);
+    testScanPerformance(10, roundCount);
+    testScanPerformance(30, roundCount);
+    testScanPerformance(50, roundCount);
+    testScanPerformance(100, roundCount);
+    testScanPerformance(300, roundCount);
+    testScanPerformance(500, roundCount);
+    testScanPerformance(1000, roundCount);
+    testScanPerformance(3000, roundCount);
+    testScanPerformance(5000, roundCount);
+    testScanPerformance(10000, roundCount);
+    if (roundCount < 100) {
+        testScanPerformance(30000, roundCount);
+        testScanPerformance(50000, roundCount);
+        testScanPerformance(100000, roundCount);
+        testScanPerformance(300000, roundCount);
+        testScanPerformance(1000000, roundCount);
+        testScanPerformance(3000000, roundCount);
+        testScanPerformance(5000000, roundCount);
+        testScanPerformance(10000000, roundCount);
+    }
+}
+
 int main() {
     printf("Value size: %zu\n", sizeof(Value));
+    #ifdef REDBLACKTREE_PREFETCH
+    printf("Prefetching enabled\n");
+    #endif
     #ifndef NDEBUG
     for (size_t i = 0; i < 10; ++i) {
         printf("Round %zu\n", i);
         testConsistency(5000);
+        testBuildConsistency(1);
+        testBuildConsistency(2);
+        testBuildConsistency(3);
+        testBuildConsistency(10);
+        testBuildConsistency(1000);
+        testSplitJoinConsistency(1);
+        testSplitJoinConsistency(2);
+        testSplitJoinConsistency(3);
+        testSplitJoinConsistency(10);
+        testSplitJoinConsistency(1000);
+        testLookupConsistency(1);
+        testLookupConsistency(10);
+        testLookupConsistency(5000);
+        testIterationConsistency(1);
+        testIterationConsistency(10);
+        testIterationConsistency(5000);
     }
+    testAugmentedConsistency(1000);
+    testIntervalConsistency(1);
+    testIntervalConsistency(10);
+    testIntervalConsistency(5000);
     #else
     printf("Random removal benchmark\n");
-    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev\n");
+    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev" STATS_HEADER "\n");
     burstRandomRemovalPerformance(1000000);
     printf("Minimum removal benchmark\n");
-    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev\n");
+    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev" STATS_HEADER "\n");
     burstMinimumRemovalPerformance(1000000);
     printf("Full cycle benchmark\n");
     burstFullCyclePerformance(1000);
+    printf("Bulk construction benchmark\n");
+    printf("Node count,Insert,Sort and build,Build sorted\n");
+    burstBuildPerformance(10);
+    printf("Lookup benchmark\n");
+    printf("Node count,Find,Lower bound,Upper bound\n");
+    burstLookupPerformance(10);
+    printf("In-order scan benchmark\n");
+    printf("Node count,Scan,Leftmost removal\n");
+    burstScanPerformance(10);
+    printf("Interval benchmark\n");
+    printf("Node count,Insert,Stab,Stab results,Overlap,Overlap results,Linear overlap\n");
+    burstIntervalPerformance(1000000);
     #endif
 }
@@ -0,0 +1,312 @@
+/*
+Test bench for trees with optimistic concurrent readers using a sequence lock.
+Copyright 2012-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <pthread.h>
+#include "SeqLock.h"
+#include "AvlTree.h"
+#include "RedBlackTree.h"
+
+/** Element that can be added to both kinds of tree, with a payload checked by readers. */
+typedef struct Value {
+    uint64_t key;
+    uint64_t payload;
+    AvlTree_Node avlNode;
+    RedBlackTree_Node redBlackNode;
+} Value;
+
+static inline uint64_t payloadOf(uint64_t key) {
+    return key * 3 + 1;
+}
+
+static inline Value *Value_fromAvlNode(AvlTree_Node *n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, avlNode));
+}
+
+static inline bool Value_isLessAvl(AvlTree_Node *node, AvlTree_Node *other) {
+    return Value_fromAvlNode(node)->key < Value_fromAvlNode(other)->key;
+}
+
+static inline void Value_readAvl(AvlTree_Node *node, void *context) {
+    *(uint64_t *) context = Value_fromAvlNode(node)->payload;
+}
+
+static inline Value *Value_fromRedBlackNode(RedBlackTree_Node *n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, redBlackNode));
+}
+
+static inline bool Value_isLessRedBlack(RedBlackTree_Node *node, RedBlackTree_Node *other) {
+    return Value_fromRedBlackNode(node)->key < Value_fromRedBlackNode(other)->key;
+}
+
+static inline void Value_readRedBlack(RedBlackTree_Node *node, void *context) {
+    *(uint64_t *) context = Value_fromRedBlackNode(node)->payload;
+}
+
+AvlTree_instantiateInsert(TestAvlTree_insert, Value_isLessAvl);
+AvlTree_instantiateFind(TestAvlTree_find, Value_isLessAvl);
+AvlTree_instantiateOptimisticFind(TestAvlTree_optimisticFind, Value_isLessAvl, Value_readAvl);
+RedBlackTree_instantiateInsert(TestRedBlackTree_insert, Value_isLessRedBlack);
+RedBlackTree_instantiateFind(TestRedBlackTree_find, Value_isLessRedBlack);
+RedBlackTree_instantiateOptimisticFind(TestRedBlackTree_optimisticFind, Value_isLessRedBlack, Value_readRedBlack);
+
+typedef enum Protection {
+    seqLockProtection,
+    rwLockProtection,
+    mutexProtection
+} Protection;
+
+static const char *const protectionNames[] = { "SeqLock", "RW lock", "Mutex" };
+
+/**
+ * Shared state of a test: even keys from 0 are always in the tree, while
+ * the writer keeps inserting and removing churn elements with odd keys.
+ */
+typedef struct Bench {
+    bool isAvl;
+    Protection protection;
+    SeqLock seqLock;
+    pthread_rwlock_t rwLock;
+    pthread_mutex_t mutex;
+    AvlTree avlTree;
+    RedBlackTree redBlackTree;
+    Value *values;
+    size_t valueCount;
+    Value *churn;
+    size_t churnCount;
+    size_t lookupCount;
+    pthread_barrier_t barrier;
+    volatile bool stop;
+    size_t updateCount;
+    volatile bool failed;
+} Bench;
+
+static void lockForWrite(Bench *b) {
+    switch (b->protection) {
+        case seqLockProtection: SeqLock_writeBegin(&b->seqLock); break;
+        case rwLockProtection: pthread_rwlock_wrlock(&b->rwLock); break;
+        case mutexProtection: pthread_mutex_lock(&b->mutex); break;
+    }
+}
+
+static void unlockForWrite(Bench *b) {
+    switch (b->protection) {
+        case seqLockProtection: SeqLock_writeEnd(&b->seqLock); break;
+        case rwLockProtection: pthread_rwlock_unlock(&b->rwLock); break;
+        case mutexProtection: pthread_mutex_unlock(&b->mutex); break;
+    }
+}
+
+static void insert(Bench *b, Value *v) {
+    if (b->isAvl) {
+        TestAvlTree_insert(&b->avlTree, &v->avlNode);
+    } else {
+        TestRedBlackTree_insert(&b->redBlackTree, &v->redBlackNode);
+    }
+}
+
+static void removeValue(Bench *b, Value *v) {
+    if (b->isAvl) {
+        AvlTree_remove(&b->avlTree, &v->avlNode);
+    } else {
+        RedBlackTree_remove(&b->redBlackTree, &v->redBlackNode);
+    }
+}
+
+/** Looks up a key with the protection of the bench, returning whether found and its payload. */
+static bool lookup(Bench *b, uint64_t key, uint64_t *payload) {
+    Value k = { .key = key };
+    bool found = false;
+    if (b->protection == seqLockProtection) {
+        if (b->isAvl) return TestAvlTree_optimisticFind(&b->seqLock, &b->avlTree, &k.avlNode, payload);
+        return TestRedBlackTree_optimisticFind(&b->seqLock, &b->redBlackTree, &k.redBlackNode, payload);
+    }
+    if (b->protection == rwLockProtection) {
+        pthread_rwlock_rdlock(&b->rwLock);
+    } else {
+        pthread_mutex_lock(&b->mutex);
+    }
+    if (b->isAvl) {
+        AvlTree_Node *n = TestAvlTree_find(&b->avlTree, &k.avlNode);
+        if (n != &b->avlTree.sentinel) {
+            *payload = Value_fromAvlNode(n)->payload;
+            found = true;
+        }
+    } else {
+        RedBlackTree_Node *n = TestRedBlackTree_find(&b->redBlackTree, &k.redBlackNode);
+        if (n != NULL) {
+            *payload = Value_fromRedBlackNode(n)->payload;
+            found = true;
+        }
+    }
+    if (b->protection == rwLockProtection) {
+        pthread_rwlock_unlock(&b->rwLock);
+    } else {
+        pthread_mutex_unlock(&b->mutex);
+    }
+    return found;
+}
+
+/** Reader thread: looks up random stable keys and random keys never inserted. */
+static void *readerThread(void *context) {
+    Bench *b = (Bench *) context;
+    unsigned short seed[3] = { (unsigned short) (uintptr_t) &seed, 1, 2 };
+    pthread_barrier_wait(&b->barrier);
+    for (size_t i = 0; i < b->lookupCount; ++i) {
+        uint64_t payload = 0;
+        size_t index = nrand48(seed) % b->valueCount;
+        uint64_t key = b->values[index].key;
+        if (!lookup(b, key, &payload) || payload != payloadOf(key)) b->failed = true;
+        if (i % 16 == 0 && lookup(b, 2 * b->valueCount + 2 * (nrand48(seed) % b->valueCount), &payload)) b->failed = true;
+    }
+    pthread_barrier_wait(&b->barrier);
+    return NULL;
+}
+
+/**
+ * Writer thread: removes and inserts back churn elements until readers are
+ * done, spinning a little after each update as a scheduler would do work.
+ */
+static void *writerThread(void *context) {
+    Bench *b = (Bench *) context;
+    size_t updateCount = 0;
+    for (size_t i = 0; !b->stop; i = (i + 1) % b->churnCount) {
+        lockForWrite(b);
+        removeValue(b, &b->churn[i]);
+        unlockForWrite(b);
+        lockForWrite(b);
+        insert(b, &b->churn[i]);
+        unlockForWrite(b);
+        updateCount += 2;
+        for (int j = 0; j < 200; ++j) SeqLock_cpuRelax();
+    }
+    b->updateCount = updateCount;
+    return NULL;
+}
+
+/**
+ * Runs readerCount reader threads concurrently with a writer thread on a tree
+ * of nodeCount stable elements, returning the aggregate count of lookups per
+ * microsecond, and setting b->failed if any lookup returned a wrong result.
+ */
+static double runBench(Bench *b, size_t nodeCount, size_t readerCount, size_t lookupCount) {
+    b->valueCount = nodeCount;
+    b->churnCount = nodeCount / 8 + 1;
+    b->lookupCount = lookupCount;
+    b->values = malloc(nodeCount * sizeof(Value));
+    b->churn = malloc(b->churnCount * sizeof(Value));
+    b->stop = false;
+    b->failed = false;
+    SeqLock_initialize(&b->seqLock);
+    pthread_rwlock_init(&b->rwLock, NULL);
+    pthread_mutex_init(&b->mutex, NULL);
+    AvlTree_initialize(&b->avlTree);
+    RedBlackTree_initialize(&b->redBlackTree);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        b->values[i].key = 2 * i;
+        b->values[i].payload = payloadOf(2 * i);
+        insert(b, &b->values[i]);
+    }
+    for (size_t i = 0; i < b->churnCount; ++i) {
+        b->churn[i].key = 2 * ((i * 7919) % nodeCount) + 1;
+        b->churn[i].payload = payloadOf(b->churn[i].key);
+        insert(b, &b->churn[i]);
+    }
+    pthread_barrier_init(&b->barrier, NULL, readerCount + 1);
+    pthread_t writer;
+    pthread_t readers[readerCount];
+    for (size_t i = 0; i < readerCount; ++i) {
+        pthread_create(&readers[i], NULL, readerThread, b);
+    }
+    pthread_create(&writer, NULL, writerThread, b);
+    struct timespec begin, end;
+    pthread_barrier_wait(&b->barrier);
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    pthread_barrier_wait(&b->barrier);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    b->stop = true;
+    pthread_join(writer, NULL);
+    for (size_t i = 0; i < readerCount; ++i) {
+        pthread_join(readers[i], NULL);
+    }
+    pthread_barrier_destroy(&b->barrier);
+    pthread_mutex_destroy(&b->mutex);
+    pthread_rwlock_destroy(&b->rwLock);
+    free(b->churn);
+    free(b->values);
+    double microseconds = (end.tv_sec - begin.tv_sec) * 1e6 + (end.tv_nsec - begin.tv_nsec) / 1e3;
+    return readerCount * (lookupCount + lookupCount / 16) / microseconds;
+}
+
+#ifndef NDEBUG
+static void testConsistency(bool isAvl, size_t nodeCount, size_t readerCount) {
+    Bench b = { .isAvl = isAvl, .protection = seqLockProtection };
+    runBench(&b, nodeCount, readerCount, 200000);
+    assert(!b.failed);
+    assert(b.updateCount > 0);
+}
+#endif
+
+static void testPerformance(bool isAvl, size_t nodeCount) {
+    const size_t readerCounts[] = { 1, 2, 4, 8 };
+    for (size_t p = seqLockProtection; p <= mutexProtection; ++p) {
+        printf("%s,%s,%zu", isAvl ? "AvlTree" : "RedBlackTree", protectionNames[p], nodeCount);
+        for (size_t i = 0; i < sizeof(readerCounts) / sizeof(readerCounts[0]); ++i) {
+            Bench b = { .isAvl = isAvl, .protection = (Protection) p };
+            double throughput = runBench(&b, nodeCount, readerCounts[i], 200000);
+            printf(",%g", throughput);
+            if (b.failed) printf(" (FAILED)");
+        }
+        printf("\n");
+    }
+}
+
+int main() {
+    #ifndef NDEBUG
+    for (size_t i = 0; i < 3; ++i) {
+        printf("Round %zu\n", i);
+        testConsistency(true, 10, 2);
+        testConsistency(true, 5000, 4);
+        testConsistency(false, 10, 2);
+        testConsistency(false, 5000, 4);
+    }
+    #else
+    printf("Read scaling benchmark with a concurrent writer, lookups per microsecond\n");
+    printf("Tree,Protection,Node count,1 reader,2 readers,4 readers,8 readers\n");
+    testPerformance(true, 1000);
+    testPerformance(true, 1000000);
+    testPerformance(false, 1000);
+    testPerformance(false, 1000000);
+    #endif
+    return 0;
+}
@@ -0,0 +1,367 @@
+/*
+Test code for the limited priority queue with sparse storage.
+Copyright 2012-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <math.h>
+#include "LimitedPriorityQueue.h"
+#include "tscStopwatch.h"
+
+#ifndef SPARSELIMITEDPRIORITYQUEUE_PRIORITY_COUNT
+#define SPARSELIMITEDPRIORITYQUEUE_PRIORITY_COUNT 65536
+#endif
+
+SparseLimitedPriorityQueue_header(TestQueue, SPARSELIMITEDPRIORITYQUEUE_PRIORITY_COUNT);
+/* Only to compare sizes with the queue having a sentinel for each priority */
+LimitedPriorityQueue_header(DenseQueue, SPARSELIMITEDPRIORITYQUEUE_PRIORITY_COUNT);
+
+typedef struct Value {
+    TestQueue_Node node;
+    unsigned key;
+    char dummy[64 - sizeof(TestQueue_Node) - sizeof(unsigned)];
+} Value;
+
+static inline Value *Value_fromNode(TestQueue_Node *n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, node));
+}
+
+static inline unsigned Value_getKey(TestQueue_Node *node) {
+    return Value_fromNode(node)->key;
+}
+
+SparseLimitedPriorityQueue_implementation(TestQueue, SPARSELIMITEDPRIORITYQUEUE_PRIORITY_COUNT, unsigned, Value_getKey);
+
+static void randomizeKey(Value *value) {
+    value->key = (unsigned) lrand48() % SPARSELIMITEDPRIORITYQUEUE_PRIORITY_COUNT;
+}
+
+static Value *createValues(size_t nodeCount) {
+    Value *nodes = (Value *) malloc(nodeCount * sizeof(Value));
+    memset(nodes, 0, nodeCount * sizeof(Value));
+    srand48(time(NULL));
+    for (size_t i = 0; i < nodeCount; ++i) {
+        randomizeKey(&nodes[i]);
+    }
+    nodes[lrand48() % nodeCount].key = 0;
+    nodes[lrand48() % nodeCount].key = 1;
+    nodes[lrand48() % nodeCount].key = SPARSELIMITEDPRIORITYQUEUE_PRIORITY_COUNT - 2;
+    nodes[lrand48() % nodeCount].key = SPARSELIMITEDPRIORITYQUEUE_PRIORITY_COUNT - 1;
+    return nodes;
+}
+
+/* Sizes hash tables to at least twice the count of distinct priorities, as a caller would */
+static size_t getCapacity(size_t headCount) {
+    size_t capacity = 2;
+    while (capacity < 2 * headCount) capacity *= 2;
+    return capacity;
+}
+
+static TestQueue *createQueue(size_t nodeCount) {
+    size_t maxHeadCount = (nodeCount < SPARSELIMITEDPRIORITYQUEUE_PRIORITY_COUNT) ? nodeCount : SPARSELIMITEDPRIORITYQUEUE_PRIORITY_COUNT;
+    size_t capacity = getCapacity(maxHeadCount);
+    TestQueue *queue = malloc(sizeof(TestQueue));
+    TestQueue_initialize(queue, malloc(capacity * sizeof(TestQueue_Node *)), capacity);
+    return queue;
+}
+
+static void destroyQueue(TestQueue *queue) {
+    free(queue->heads);
+    free(queue);
+}
+
+/* Bytes used by a queue, including its hash table */
+static size_t getQueueSize(const TestQueue *queue) {
+    return sizeof(TestQueue) + TestQueue_getCapacity(queue) * sizeof(TestQueue_Node *);
+}
+
+#ifndef NDEBUG
+static bool isPresent(Value **arr, size_t size, Value *node) {
+    for (size_t i = 0; i < size; ++i) {
+        if (arr[i] == node) return true;
+    }
+    return false;
+}
+
+/* Grows the hash table as needed before inserting a value with a new priority */
+static void growIfNeeded(TestQueue *queue) {
+    if (2 * (TestQueue_getHeadCount(queue) + 1) > TestQueue_getCapacity(queue)) {
+        TestQueue_Node **oldHeads = queue->heads;
+        size_t capacity = 2 * TestQueue_getCapacity(queue);
+        TestQueue_rehash(queue, malloc(capacity * sizeof(TestQueue_Node *)), capacity);
+        free(oldHeads);
+        TestQueue_check(queue);
+    }
+}
+
+static void testConsistency(size_t nodeCount) {
+    Value **seenValues = malloc(nodeCount * sizeof(Value *));
+    size_t seenValuesSize;
+    Value *values = createValues(nodeCount);
+    TestQueue *queue = createQueue(1);
+    // Test minimum element removal, first come first among equal priorities
+    for (size_t i = 0; i < nodeCount; ++i) {
+        growIfNeeded(queue);
+        TestQueue_insert(queue, &values[i].node);
+        if (i % 100 == 0) TestQueue_check(queue);
+    }
+    TestQueue_check(queue);
+    seenValuesSize = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        assert(!TestQueue_isEmpty(queue));
+        Value *value = Value_fromNode(TestQueue_poll(queue));
+        if (i % 100 == 0) TestQueue_check(queue);
+        assert(!isPresent(seenValues, seenValuesSize, value));
+        seenValues[seenValuesSize] = value;
+        seenValuesSize++;
+        printf("Polled %zu: %u\n", i, value->key);
+        assert(i == 0 || seenValues[i - 1]->key < seenValues[i]->key
+                || (seenValues[i - 1]->key == seenValues[i]->key && seenValues[i - 1] < seenValues[i]));
+    }
+    assert(TestQueue_isEmpty(queue));
+    // Test insertion in front, last come first among equal priorities
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestQueue_insertFront(queue, &values[i].node);
+        if (i % 100 == 0) TestQueue_check(queue);
+    }
+    TestQueue_check(queue);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        seenValues[i] = Value_fromNode(TestQueue_poll(queue));
+        if (i % 100 == 0) TestQueue_check(queue);
+        assert(i == 0 || seenValues[i - 1]->key < seenValues[i]->key
+                || (seenValues[i - 1]->key == seenValues[i]->key && seenValues[i - 1] > seenValues[i]));
+    }
+    assert(TestQueue_isEmpty(queue));
+    // Test random removal
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestQueue_insert(queue, &values[i].node);
+    }
+    seenValuesSize = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        assert(!TestQueue_isEmpty(queue));
+        TestQueue_remove(queue, &values[i].node);
+        if (i % 100 == 0) TestQueue_check(queue);
+        assert(!isPresent(seenValues, seenValuesSize, &values[i]));
+        seenValues[seenValuesSize] = &values[i];
+        seenValuesSize++;
+        printf("Removed %zu: %u\n", i, values[i].key);
+    }
+    assert(TestQueue_isEmpty(queue));
+    TestQueue_check(queue);
+    free(seenValues);
+    destroyQueue(queue);
+    free(values);
+}
+#endif
+
+static void testRandomRemovalPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    TestQueue *queue = createQueue(nodeCount);
+    for (size_t i = 0; i < nodeCount - 1; ++i) {
+        TestQueue_insert(queue, &values[i].node);
+    }
+    double insertMean = 0;
+    double removeMean = 0;
+    double insertVar = 0;
+    double removeVar = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Insert
+        size_t i = nodeCount - 1;
+        randomizeKey(&values[i]);
+        uint64_t tb = tscStopwatchBegin();
+        TestQueue_insert(queue, &values[i].node);
+        uint64_t te = tscStopwatchEnd();
+        double delta = (double) (te - tb) - insertMean;
+        insertMean += delta / (double) (r + 1);
+        double delta2 = (double) (te - tb) - insertMean;
+        insertVar += delta * delta2;
+        // Remove node just inserted
+        tb = tscStopwatchBegin();
+        TestQueue_remove(queue, &values[i].node);
+        te = tscStopwatchEnd();
+        delta = (double) (te - tb) - removeMean;
+        removeMean += delta / (double) (r + 1);
+        delta2 = (double) (te - tb) - removeMean;
+        removeVar += delta * delta2;
+    }
+    printf("%zu,%g,%g,%g,%g,%zu\n", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)), getQueueSize(queue));
+    destroyQueue(queue);
+    free(values);
+}
+
+static void testMinimumRemovalPerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    TestQueue *queue = createQueue(nodeCount);
+    for (size_t i = 0; i < nodeCount - 1; ++i) {
+        TestQueue_insert(queue, &values[i].node);
+    }
+    Value *value = &values[nodeCount - 1];
+    double insertMean = 0;
+    double removeMean = 0;
+    double insertVar = 0;
+    double removeVar = 0;
+    for (size_t r = 0; r < roundCount; ++r) {
+        // Insert
+        randomizeKey(value);
+        uint64_t tb = tscStopwatchBegin();
+        TestQueue_insert(queue, &value->node);
+        uint64_t te = tscStopwatchEnd();
+        double delta = (double) (te - tb) - insertMean;
+        insertMean += delta / (double) (r + 1);
+        double delta2 = (double) (te - tb) - insertMean;
+        insertVar += delta * delta2;
+        // Remove minimum
+        tb = tscStopwatchBegin();
+        value = Value_fromNode(TestQueue_poll(queue));
+        te = tscStopwatchEnd();
+        delta = (double) (te - tb) - removeMean;
+        removeMean += delta / (double) (r + 1);
+        delta2 = (double) (te - tb) - removeMean;
+        removeVar += delta * delta2;
+    }
+    printf("%zu,%g,%g,%g,%g,%zu\n", nodeCount, insertMean, removeMean, sqrt(insertVar / (roundCount - 1)), sqrt(removeVar / (roundCount - 1)), getQueueSize(queue));
+    destroyQueue(queue);
+    free(values);
+}
+
+static void testFullCyclePerformance(size_t nodeCount, size_t roundCount) {
+    Value *values = createValues(nodeCount);
+    TestQueue *queue = createQueue(nodeCount);
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t r = 0; r < roundCount; ++r) {
+        for (size_t i = 0; i < nodeCount; i++) {
+            TestQueue_insert(queue, &values[i].node);
+        }
+        for (size_t i = 0; i < nodeCount; i++) {
+            TestQueue_poll(queue);
+        }
+    }
+    uint64_t te = tscStopwatchEnd();
+    printf("%zu,%g,%zu\n", nodeCount, (double) (te - tb) / roundCount / nodeCount, getQueueSize(queue));
+    destroyQueue(queue);
+    free(values);
+}
+
+static void burstRandomRemovalPerformance(size_t roundCount) {
+    testRandomRemovalPerformance(1, roundCount);
+    testRandomRemovalPerformance(3, roundCount);
+    testRandomRemovalPerformance(5, roundCount);
+    testRandomRemovalPerformance(10, roundCount);
+    testRandomRemovalPerformance(30, roundCount);
+    testRandomRemovalPerformance(50, roundCount);
+    testRandomRemovalPerformance(100, roundCount);
+    testRandomRemovalPerformance(300, roundCount);
+    testRandomRemovalPerformance(500, roundCount);
+    testRandomRemovalPerformance(1000, roundCount);
+    testRandomRemovalPerformance(3000, roundCount);
+    testRandomRemovalPerformance(5000, roundCount);
+    testRandomRemovalPerformance(10000, roundCount);
+    testRandomRemovalPerformance(30000, roundCount);
+    testRandomRemovalPerformance(50000, roundCount);
+    testRandomRemovalPerformance(100000, roundCount);
+    testRandomRemovalPerformance(300000, roundCount);
+    testRandomRemovalPerformance(1000000, roundCount);
+    testRandomRemovalPerformance(3000000, roundCount);
+    testRandomRemovalPerformance(5000000, roundCount);
+    testRandomRemovalPerformance(10000000, roundCount);
+}
+
+static void burstMinimumRemovalPerformance(size_t roundCount) {
+    testMinimumRemovalPerformance(1, roundCount);
+    testMinimumRemovalPerformance(3, roundCount);
+    testMinimumRemovalPerformance(5, roundCount);
+    testMinimumRemovalPerformance(10, roundCount);
+    testMinimumRemovalPerformance(30, roundCount);
+    testMinimumRemovalPerformance(50, roundCount);
+    testMinimumRemovalPerformance(100, roundCount);
+    testMinimumRemovalPerformance(300, roundCount);
+    testMinimumRemovalPerformance(500, roundCount);
+    testMinimumRemovalPerformance(1000, roundCount);
+    testMinimumRemovalPerformance(3000, roundCount);
+    testMinimumRemovalPerformance(5000, roundCount);
+    testMinimumRemovalPerformance(10000, roundCount);
+    testMinimumRemovalPerformance(30000, roundCount);
+    testMinimumRemovalPerformance(50000, roundCount);
+    testMinimumRemovalPerformance(100000, roundCount);
+    testMinimumRemovalPerformance(300000, roundCount);
+    testMinimumRemovalPerformance(1000000, roundCount);
+    testMinimumRemovalPerformance(3000000, roundCount);
+    testMinimumRemovalPerformance(5000000, roundCount);
+    testMinimumRemovalPerformance(10000000, roundCount);
+}
+
+static void burstFullCyclePerformance(size_t roundCount) {
+    testFullCyclePerformance(1, roundCount);
+    testFullCyclePerformance(3, roundCount);
+    testFullCyclePerformance(5, roundCount);
+    testFullCyclePerformance(10, roundCount);
+    testFullCyclePerformance(30, roundCount);
+    testFullCyclePerformance(50, roundCount);
+    testFullCyclePerformance(100, roundCount);
+    testFullCyclePerformance(300, roundCount);
+    testFullCyclePerformance(500, roundCount);
+    testFullCyclePerformance(1000, roundCount);
+    testFullCyclePerformance(3000, roundCount);
+    testFullCyclePerformance(5000, roundCount);
+    testFullCyclePerformance(10000, roundCount);
+    if (roundCount < 100) {
+        testFullCyclePerformance(30000, roundCount);
+        testFullCyclePerformance(50000, roundCount);
+        testFullCyclePerformance(100000, roundCount);
+        testFullCyclePerformance(300000, roundCount);
+        testFullCyclePerformance(1000000, roundCount);
+        testFullCyclePerformance(3000000, roundCount);
+        testFullCyclePerformance(5000000, roundCount);
+        testFullCyclePerformance(10000000, roundCount);
+    }
+}
+
+int main() {
+    printf("Value size: %zu\n", sizeof(Value));
+    printf("Priority count: %d, bitmap levels: %d, queue size without hash table: %zu, dense queue size: %zu\n",
+            SPARSELIMITEDPRIORITYQUEUE_PRIORITY_COUNT, TestQueue_levelCount, sizeof(TestQueue), sizeof(DenseQueue));
+    #ifndef NDEBUG
+    for (size_t i = 0; i < 10; ++i) {
+        printf("Round %zu\n", i);
+        testConsistency(5000);
+    }
+    #else
+    printf("Random removal benchmark\n");
+    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev,Bytes\n");
+    burstRandomRemovalPerformance(1000000);
+    printf("Minimum removal benchmark\n");
+    printf("Node count,Ins. mean,Rem. mean,Ins. stddev,Rem. stddev,Bytes\n");
+    burstMinimumRemovalPerformance(1000000);
+    printf("Full cycle benchmark\n");
+    printf("Node count,Mean,Bytes\n");
+    burstFullCyclePerformance(1000);
+    #endif
+}
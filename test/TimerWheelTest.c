@@ -0,0 +1,398 @@
+/*
+Test code for the intrusive hierarchical timing wheel container.
+Copyright 2012-2020 Salvatore ISAJA. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+this list of conditions and the following disclaimer in the documentation
+and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED THE COPYRIGHT HOLDER ``AS IS'' AND ANY EXPRESS
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <math.h>
+#include "TimerWheel.h"
+#include "BinaryHeap.h"
+#include "PairingHeap.h"
+#include "AvlTree.h"
+#include "tscStopwatch.h"
+
+/* Five levels of 64 slots cover 2^30 ticks, farther timers go to the overflow list */
+#ifndef TIMERWHEEL_LEVEL_COUNT
+#define TIMERWHEEL_LEVEL_COUNT 5
+#endif
+
+TimerWheel_header(TestWheel, TIMERWHEEL_LEVEL_COUNT);
+BinaryHeap_header(TestBinaryHeap);
+PairingHeap_header(TestPairingHeap);
+
+/* The same element is used for all containers, each benchmark touching its own node only */
+typedef struct Value {
+    uint64_t key;
+    uint64_t due; // key, or the time of arming if the key was already past
+    TestWheel_Node timer;
+    TestBinaryHeap_Node *binaryHeapNode;
+    TestPairingHeap_Node pairingHeapNode;
+    AvlTree_Node avlTreeNode;
+    bool armed;
+} Value;
+
+static inline Value *Value_fromTimer(TestWheel_Node *n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, timer));
+}
+
+static inline Value *Value_fromBinaryHeapNode(TestBinaryHeap_Node **n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, binaryHeapNode));
+}
+
+static inline bool Value_isLessInBinaryHeap(TestBinaryHeap_Node **value, TestBinaryHeap_Node **other) {
+    return Value_fromBinaryHeapNode(value)->key < Value_fromBinaryHeapNode(other)->key;
+}
+
+static inline Value *Value_fromPairingHeapNode(TestPairingHeap_Node *n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, pairingHeapNode));
+}
+
+static inline bool Value_isLessInPairingHeap(TestPairingHeap_Node *node, TestPairingHeap_Node *other) {
+    return Value_fromPairingHeapNode(node)->key < Value_fromPairingHeapNode(other)->key;
+}
+
+static inline Value *Value_fromAvlTreeNode(AvlTree_Node *n) {
+    return (Value *) ((uint8_t *) n - offsetof(Value, avlTreeNode));
+}
+
+static inline bool Value_isLessInAvlTree(AvlTree_Node *node, AvlTree_Node *other) {
+    return Value_fromAvlTreeNode(node)->key < Value_fromAvlTreeNode(other)->key;
+}
+
+TimerWheel_implementation(TestWheel, TIMERWHEEL_LEVEL_COUNT);
+BinaryHeap_implementation(TestBinaryHeap, Value_isLessInBinaryHeap);
+PairingHeap_implementation(TestPairingHeap, Value_isLessInPairingHeap);
+AvlTree_instantiateInsert(TestAvlTree_insert, Value_isLessInAvlTree);
+
+static uint64_t random64() {
+    return ((uint64_t) lrand48() << 32) | lrand48();
+}
+
+static Value *createValues(size_t nodeCount, TestBinaryHeap_Node **binaryHeapNodes) {
+    Value *values = (Value *) malloc(nodeCount * sizeof(Value));
+    memset(values, 0, nodeCount * sizeof(Value));
+    *binaryHeapNodes = malloc(nodeCount * sizeof(TestBinaryHeap_Node));
+    for (size_t i = 0; i < nodeCount; ++i) {
+        values[i].binaryHeapNode = &(*binaryHeapNodes)[i];
+        (*binaryHeapNodes)[i].value = &values[i].binaryHeapNode;
+    }
+    return values;
+}
+
+#ifndef NDEBUG
+/* Timeouts span from the current tick to well beyond the overflow list */
+static uint64_t randomTimeout() {
+    switch (lrand48() % 4) {
+        case 0: return lrand48() % 64;
+        case 1: return lrand48() % 4096;
+        case 2: return random64() % (UINT64_C(1) << 30);
+        default: return random64() % (UINT64_C(1) << 36);
+    }
+}
+
+/* Expiries are sometimes already past, thus due at the current time */
+static uint64_t randomExpiry(TestWheel *wheel) {
+    uint64_t now = TestWheel_getTime(wheel);
+    if (lrand48() % 8 == 0) return now - lrand48() % 4096;
+    return now + randomTimeout();
+}
+
+/* Advances mostly by a few ticks, sometimes across the farthest slots */
+static uint64_t randomStep() {
+    switch (lrand48() % 8) {
+        case 0: return 0;
+        case 1: return random64() % (UINT64_C(1) << 36);
+        case 2: return random64() % (UINT64_C(1) << 24);
+        case 3: return lrand48() % 4096;
+        default: return lrand48() % 64;
+    }
+}
+
+static void checkAdvance(TestWheel *wheel, Value *values, size_t nodeCount, uint64_t time) {
+    TestWheel_Node expired;
+    TestWheel_initializeList(&expired);
+    TestWheel_advance(wheel, time, &expired);
+    TestWheel_check(wheel);
+    assert(TestWheel_getTime(wheel) == time);
+    size_t expiredCount = 0;
+    uint64_t lastDue = 0;
+    for (TestWheel_Node *x = expired.next; x != &expired; x = x->next) {
+        Value *value = Value_fromTimer(x);
+        assert(value->armed);
+        assert(value->key <= time);
+        assert(value->due <= time);
+        assert(value->due >= lastDue);
+        lastDue = value->due;
+        value->armed = false;
+        expiredCount++;
+    }
+    for (size_t i = 0; i < nodeCount; ++i) {
+        assert(!values[i].armed || values[i].key > time);
+    }
+    printf("Advanced to %016" PRIX64 ", %zu expired\n", time, expiredCount);
+}
+
+static void arm(TestWheel *wheel, Value *value, uint64_t expiry) {
+    value->key = expiry;
+    value->due = (expiry > TestWheel_getTime(wheel)) ? expiry : TestWheel_getTime(wheel);
+    value->armed = true;
+    TestWheel_arm(wheel, &value->timer, expiry);
+}
+
+static void testConsistency(size_t nodeCount) {
+    TestBinaryHeap_Node *binaryHeapNodes;
+    Value *values = createValues(nodeCount, &binaryHeapNodes);
+    srand48(time(NULL));
+    TestWheel wheel;
+    TestWheel_initialize(&wheel, random64() >> 2);
+    assert(TestWheel_isEmpty(&wheel));
+    // Test that timers armed in the past expire after those already due now
+    uint64_t now = TestWheel_getTime(&wheel);
+    arm(&wheel, &values[0], now);
+    arm(&wheel, &values[1], now - 5);
+    arm(&wheel, &values[2], now - 10);
+    TestWheel_Node expired;
+    TestWheel_initializeList(&expired);
+    TestWheel_advance(&wheel, now, &expired);
+    assert(expired.next == &values[0].timer);
+    assert(expired.next->next == &values[1].timer);
+    assert(expired.next->next->next == &values[2].timer);
+    assert(expired.prev == &values[2].timer);
+    for (size_t i = 0; i < 3; i++) values[i].armed = false;
+    assert(TestWheel_isEmpty(&wheel));
+    // Test arming and expiring all timers
+    for (size_t i = 0; i < nodeCount; ++i) {
+        arm(&wheel, &values[i], randomExpiry(&wheel));
+        TestWheel_check(&wheel);
+    }
+    while (!TestWheel_isEmpty(&wheel)) {
+        checkAdvance(&wheel, values, nodeCount, TestWheel_getTime(&wheel) + randomStep());
+    }
+    // Test cancellation of all timers
+    for (size_t i = 0; i < nodeCount; ++i) {
+        arm(&wheel, &values[i], randomExpiry(&wheel));
+    }
+    TestWheel_check(&wheel);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestWheel_cancel(&wheel, &values[i].timer);
+        values[i].armed = false;
+        TestWheel_check(&wheel);
+    }
+    assert(TestWheel_isEmpty(&wheel));
+    // Test interleaved arming, cancellation and expiration
+    for (size_t i = 0; i < 4 * nodeCount; ++i) {
+        Value *value = &values[lrand48() % nodeCount];
+        switch (lrand48() % 4) {
+            case 0:
+                if (value->armed) TestWheel_cancel(&wheel, &value->timer);
+                arm(&wheel, value, randomExpiry(&wheel));
+                break;
+            case 1:
+                if (value->armed) TestWheel_cancel(&wheel, &value->timer);
+                value->armed = false;
+                break;
+            case 2:
+                if (!value->armed) arm(&wheel, value, randomExpiry(&wheel));
+                break;
+            default:
+                checkAdvance(&wheel, values, nodeCount, TestWheel_getTime(&wheel) + randomStep());
+                break;
+        }
+        TestWheel_check(&wheel);
+    }
+    free(binaryHeapNodes);
+    free(values);
+}
+#endif
+
+/*
+ * The cancellation benchmark resets a random timer on each tick, like
+ * retransmission or idle timeouts that are mostly cancelled before they fire,
+ * then advances time by one tick rearming the expired timers.
+ * Timeouts range up to 16 ticks per timer, so that about 8 timers are
+ * cancelled for each one expiring. Random numbers are drawn in the same
+ * sequence for all containers.
+ */
+
+static uint64_t randomBenchmarkTimeout(size_t nodeCount) {
+    return 1 + random64() % (16 * nodeCount);
+}
+
+static double testTimerWheelPerformance(Value *values, size_t nodeCount, size_t roundCount, long seed) {
+    srand48(seed);
+    TestWheel wheel;
+    TestWheel_initialize(&wheel, 0);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        TestWheel_arm(&wheel, &values[i].timer, randomBenchmarkTimeout(nodeCount));
+    }
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t r = 0; r < roundCount; ++r) {
+        Value *value = &values[lrand48() % nodeCount];
+        TestWheel_cancel(&wheel, &value->timer);
+        TestWheel_arm(&wheel, &value->timer, r + randomBenchmarkTimeout(nodeCount));
+        TestWheel_Node expired;
+        TestWheel_initializeList(&expired);
+        TestWheel_advance(&wheel, r + 1, &expired);
+        TestWheel_Node *x = expired.next;
+        while (x != &expired) {
+            TestWheel_Node *next = x->next;
+            TestWheel_arm(&wheel, x, r + 1 + randomBenchmarkTimeout(nodeCount));
+            x = next;
+        }
+    }
+    uint64_t te = tscStopwatchEnd();
+    return (double) (te - tb) / roundCount;
+}
+
+static double testBinaryHeapPerformance(Value *values, size_t nodeCount, size_t roundCount, long seed) {
+    srand48(seed);
+    TestBinaryHeap heap;
+    TestBinaryHeap_initialize(&heap);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        values[i].key = randomBenchmarkTimeout(nodeCount);
+        TestBinaryHeap_insert(&heap, values[i].binaryHeapNode);
+    }
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t r = 0; r < roundCount; ++r) {
+        Value *value = &values[lrand48() % nodeCount];
+        TestBinaryHeap_Node *node = TestBinaryHeap_remove(&heap, value->binaryHeapNode);
+        value->key = r + randomBenchmarkTimeout(nodeCount);
+        TestBinaryHeap_insert(&heap, node);
+        while (Value_fromBinaryHeapNode(TestBinaryHeap_peek(&heap)->value)->key <= r + 1) {
+            node = TestBinaryHeap_poll(&heap);
+            Value_fromBinaryHeapNode(node->value)->key = r + 1 + randomBenchmarkTimeout(nodeCount);
+            TestBinaryHeap_insert(&heap, node);
+        }
+    }
+    uint64_t te = tscStopwatchEnd();
+    return (double) (te - tb) / roundCount;
+}
+
+static double testPairingHeapPerformance(Value *values, size_t nodeCount, size_t roundCount, long seed) {
+    srand48(seed);
+    TestPairingHeap heap;
+    TestPairingHeap_initialize(&heap);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        values[i].key = randomBenchmarkTimeout(nodeCount);
+        TestPairingHeap_insert(&heap, &values[i].pairingHeapNode);
+    }
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t r = 0; r < roundCount; ++r) {
+        Value *value = &values[lrand48() % nodeCount];
+        TestPairingHeap_remove(&heap, &value->pairingHeapNode);
+        value->key = r + randomBenchmarkTimeout(nodeCount);
+        TestPairingHeap_insert(&heap, &value->pairingHeapNode);
+        while (Value_fromPairingHeapNode(TestPairingHeap_peek(&heap))->key <= r + 1) {
+            value = Value_fromPairingHeapNode(TestPairingHeap_poll(&heap));
+            value->key = r + 1 + randomBenchmarkTimeout(nodeCount);
+            TestPairingHeap_insert(&heap, &value->pairingHeapNode);
+        }
+    }
+    uint64_t te = tscStopwatchEnd();
+    return (double) (te - tb) / roundCount;
+}
+
+static double testAvlTreePerformance(Value *values, size_t nodeCount, size_t roundCount, long seed) {
+    srand48(seed);
+    AvlTree tree;
+    AvlTree_initialize(&tree);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        values[i].key = randomBenchmarkTimeout(nodeCount);
+        TestAvlTree_insert(&tree, &values[i].avlTreeNode);
+    }
+    uint64_t tb = tscStopwatchBegin();
+    for (size_t r = 0; r < roundCount; ++r) {
+        Value *value = &values[lrand48() % nodeCount];
+        AvlTree_remove(&tree, &value->avlTreeNode);
+        value->key = r + randomBenchmarkTimeout(nodeCount);
+        TestAvlTree_insert(&tree, &value->avlTreeNode);
+        while (Value_fromAvlTreeNode(tree.leftmost)->key <= r + 1) {
+            value = Value_fromAvlTreeNode(tree.leftmost);
+            AvlTree_remove(&tree, &value->avlTreeNode);
+            value->key = r + 1 + randomBenchmarkTimeout(nodeCount);
+            TestAvlTree_insert(&tree, &value->avlTreeNode);
+        }
+    }
+    uint64_t te = tscStopwatchEnd();
+    return (double) (te - tb) / roundCount;
+}
+
+static void testCancellationPerformance(size_t nodeCount, size_t roundCount) {
+    TestBinaryHeap_Node *binaryHeapNodes;
+    Value *values = createValues(nodeCount, &binaryHeapNodes);
+    long seed = time(NULL);
+    double timerWheelTicks = testTimerWheelPerformance(values, nodeCount, roundCount, seed);
+    double binaryHeapTicks = testBinaryHeapPerformance(values, nodeCount, roundCount, seed);
+    double pairingHeapTicks = testPairingHeapPerformance(values, nodeCount, roundCount, seed);
+    double avlTreeTicks = testAvlTreePerformance(values, nodeCount, roundCount, seed);
+    printf("%zu,%g,%g,%g,%g\n", nodeCount, timerWheelTicks, binaryHeapTicks, pairingHeapTicks, avlTreeTicks);
+    free(binaryHeapNodes);
+    free(values);
+}
+
+static void burstCancellationPerformance(size_t roundCount) {
+    testCancellationPerformance(1, roundCount);
+    testCancellationPerformance(3, roundCount);
+    testCancellationPerformance(5, roundCount);
+    testCancellationPerformance(10, roundCount);
+    testCancellationPerformance(30, roundCount);
+    testCancellationPerformance(50, roundCount);
+    testCancellationPerformance(100, roundCount);
+    testCancellationPerformance(300, roundCount);
+    testCancellationPerformance(500, roundCount);
+    testCancellationPerformance(1000, roundCount);
+    testCancellationPerformance(3000, roundCount);
+    testCancellationPerformance(5000, roundCount);
+    testCancellationPerformance(10000, roundCount);
+    testCancellationPerformance(30000, roundCount);
+    testCancellationPerformance(50000, roundCount);
+    testCancellationPerformance(100000, roundCount);
+    testCancellationPerformance(300000, roundCount);
+    testCancellationPerformance(1000000, roundCount);
+    testCancellationPerformance(3000000, roundCount);
+    testCancellationPerformance(5000000, roundCount);
+    testCancellationPerformance(10000000, roundCount);
+}
+
+int main() {
+    printf("Value size: %zu\n", sizeof(Value));
+    printf("Level count: %d\n", TIMERWHEEL_LEVEL_COUNT);
+    #ifndef NDEBUG
+    for (size_t i = 0; i < 10; ++i) {
+        printf("Round %zu\n", i);
+        testConsistency(5000);
+    }
+    #else
+    printf("Cancellation benchmark (reset a random timer, then advance one tick)\n");
+    printf("Node count,TimerWheel,BinaryHeap,PairingHeap,AvlTree\n");
+    burstCancellationPerformance(1000000);
+    #endif
+}